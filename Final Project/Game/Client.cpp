@@ -2,10 +2,13 @@
 
 #include <sstream>
 #include <algorithm>
+#include <climits>
+#include <cfloat>
 
 #include "Engine/Rendering/ConsoleLog.hpp"
 #include "Engine/Rendering/BitmapFont.hpp"
 #include "Engine/Rendering/OpenGLRenderer.hpp"
+#include "Engine/Networking/HostNameResolver.hpp"
 #include "Engine/Utilities/ErrorWarningAssert.hpp"
 #include "Engine/Utilities/CommandRegistry.hpp"
 #include "Engine/Utilities/CommonUtilities.hpp"
@@ -26,6 +29,7 @@
 const char* STARTING_SERVER_IP_AS_STRING = "127.0.0.1";				//Self
 const u_short STARTING_PORT = 5000;
 
+//The fastest updates go out, the host send pacer holds them back on a congested link
 const float SEND_TO_HOST_FREQUENCY = 0.05f;
 const float SEND_TO_HOST_MAX_DELAY = 1.f;
 
@@ -33,18 +37,29 @@ const float SEND_TO_HOST_MAX_DELAY = 1.f;
 const float ARENA_WIDTH = 700.f;
 const float ARENA_HEIGHT = 700.f;
 
-const float RESEND_RELIABLE_PACKETS_DELAY = 0.5f;
+const double TIMER_WHEEL_TICK_SECONDS = 0.001;
+
+const Vector4f HOST_RESOLVE_ERROR_COLOR = Vector4f( 1.f, 0.f, 0.f, 1.f );
+
+//A replay at full speed hands packets over this many at a time, like a busy frame would
+const int REPLAY_BENCHMARK_PACKETS_PER_FRAME = 64;
+
+//A second full window queued behind the first, the host has stopped acking
+const int MAX_GUARANTEED_MESSAGES_WAITING_FOR_ROOM = RELIABLE_SEND_WINDOW_SIZE;
 
 //-----------------------------------------------------------------------------------------------
 //Public Methods
 //-----------------------------------------------------------------------------------------------
 Client::Client()
 	: m_currentState( CLIENT_UNCONNECTED )
-	, m_connectionToHostID( 0 )
+	, m_connectionToHostID( INVALID_CONNECTION_ID )
 	, m_currentHostIPAddressAsString( STARTING_SERVER_IP_AS_STRING )
 	, m_currentHostPort( STARTING_PORT )
-	, m_mostRecentlyProcessedUnreliablePacketNum( 0 )
-	, m_mostRecentlyProcessedReliablePacketNum( 0 )
+	, m_useNetworkThread( false )
+	, m_currentPacketArrivalTimeSeconds( 0.0 )
+	, m_hasNextReplayedDatagram( false )
+	, m_replaySpeed( 1.f )
+	, m_replayStartTimeSeconds( 0.0 )
 	, m_mostRecentUnreliablePacketSentNum( 0 )
 	, m_mostRecentReliablePacketSentNum( 0 )
 	, m_selectedRoomID( 0 )
@@ -54,8 +69,28 @@ Client::Client()
 	, m_shouldFire( false )
 	, m_localPlayer( nullptr )
 	, m_localPlayerStatsToSendToServer( nullptr )
+	, m_hasNewAcksToSend( false )
+	, m_timerWheel( TIMER_WHEEL_TICK_SECONDS )
 {
 	ZeroMemory( &m_mostRecentResetInfo, sizeof( m_mostRecentResetInfo ) );
+	ZeroMemory( &m_guaranteedPacketsReceived, sizeof( m_guaranteedPacketsReceived ) );
+	ZeroMemory( &m_updatesReceived, sizeof( m_updatesReceived ) );
+
+	//the channel definitions never change, so they are put in priority order once
+	for( int i = 0; i < NUM_CHANNELS; ++i )
+	{
+		int insertIndex = i;
+
+		while( insertIndex > 0 && CHANNEL_DEFINITIONS[ i ].priority < CHANNEL_DEFINITIONS[ m_channelsByPriority[ insertIndex - 1 ] ].priority )
+		{
+			m_channelsByPriority[ insertIndex ] = m_channelsByPriority[ insertIndex - 1 ];
+			--insertIndex;
+		}
+
+		m_channelsByPriority[ insertIndex ] = static_cast< ChannelID >( i );
+	}
+
+	ResetChannels();
 }
 
 
@@ -69,9 +104,13 @@ Client::~Client()
 //-----------------------------------------------------------------------------------------------
 void Client::StartUp()
 {
-	Network& theNetwork = Network::GetInstance();
+	double currentTime = Time::GetCurrentTimeInSeconds();
+
+	//due straight away, the first join lobby packet goes out on the first update
+	m_timerWheel.Reset( currentTime );
+	m_timerWheel.Schedule( currentTime, TIMER_HEARTBEAT, 0, 0 );
 
-	m_connectionToHostID = theNetwork.CreateUDPSocketFromIPAndPort( m_currentHostIPAddressAsString.c_str(), m_currentHostPort );
+	ConnectToCurrentHost();
 
 	m_localPlayer = new ClientPlayer();
 	m_localPlayerStatsToSendToServer = new ClientPlayer();
@@ -96,6 +135,7 @@ void Client::ShutDown()
 {
 	Network& theNetwork = Network::GetInstance();
 
+	m_networkThread.ShutDown();
 	theNetwork.ShutDown();
 }
 
@@ -103,31 +143,25 @@ void Client::ShutDown()
 //-----------------------------------------------------------------------------------------------
 void Client::Update()
 {
-	static float currentElapsedSendJoinLobbySeconds = SEND_TO_HOST_MAX_DELAY;
-	static float currentElapsedSendKeepAlivePacketSeconds = 0.f;
 	static float currentElapsedSendUpdatePacketSeconds = 0.f;
 	static float currentElapsedSendVictoryPacketSeconds = SEND_TO_HOST_FREQUENCY;
 
 	Clock& appClock = Clock::GetMasterClock();
 	float deltaSeconds = static_cast< float >( appClock.m_currentDeltaSeconds );
 
-	ReceiveMessagesFromHostIfAny();
-
-	if( m_currentState == CLIENT_UNCONNECTED )
+	//still waiting on the host name to resolve
+	if( m_connectionToHostID == INVALID_CONNECTION_ID && !IsReplayingCapture() )
 	{
-		PotentiallySendJoinLobbyPacketToServer( currentElapsedSendJoinLobbySeconds, SEND_TO_HOST_MAX_DELAY );
-		currentElapsedSendJoinLobbySeconds += deltaSeconds;
-	}
-	else if( m_currentState == CLIENT_IN_LOBBY )
-	{
-		PotentiallySendKeepAlivePacketToServer( currentElapsedSendKeepAlivePacketSeconds, SEND_TO_HOST_MAX_DELAY );
-		currentElapsedSendKeepAlivePacketSeconds += deltaSeconds;
+		return;
 	}
-	else if( m_currentState == CLIENT_AWAITING_RESET )
-	{
-		PotentiallySendKeepAlivePacketToServer( currentElapsedSendKeepAlivePacketSeconds, SEND_TO_HOST_MAX_DELAY );
-		currentElapsedSendKeepAlivePacketSeconds += deltaSeconds;
 
+	ReceiveMessagesFromHostIfAny();
+	ProcessExpiredTimers();
+
+	m_hostSendPacer.Update( m_hostConnectionStats, Time::GetCurrentTimeInSeconds() );
+
+	if( m_currentState == CLIENT_AWAITING_RESET )
+	{
 		if( m_mostRecentResetInfo.type == TYPE_GameReset )
 		{
 			OnReceiveGameResetPacket( m_mostRecentResetInfo );
@@ -149,6 +183,7 @@ void Client::Update()
 	}
 
 	PotentiallyResendReliablePacketsThatHaventBeenAckedBack();
+	FlushMessagesToHost();
 }
 
 
@@ -190,7 +225,24 @@ void Client::ChangeHost( const std::string& ipAddressAsString, const std::string
 	m_currentHostIPAddressAsString = ipAddressAsString;
 	m_currentHostPort = u_short( atoi( portAsString.c_str() ) );
 
-	m_connectionToHostID = theNetwork.CreateUDPSocketFromIPAndPort( m_currentHostIPAddressAsString.c_str(), m_currentHostPort );
+	//the network thread must let go of the old socket before it is closed
+	m_networkThread.ShutDown();
+
+	//frees the old connection's slot, otherwise every host change leaks a socket
+	theNetwork.CloseUDPSocket( m_connectionToHostID );
+	m_connectionToHostID = INVALID_CONNECTION_ID;
+	m_hostConnectionStats.Reset();
+	m_hostSendPacer.Reset();
+
+	//a new host has no baselines or acks in common with this one
+	m_sentSnapshots.Clear();
+	m_receivedSnapshots.Clear();
+	ZeroMemory( &m_guaranteedPacketsReceived, sizeof( m_guaranteedPacketsReceived ) );
+	ZeroMemory( &m_updatesReceived, sizeof( m_updatesReceived ) );
+	m_hasNewAcksToSend = false;
+	ResetChannels();
+
+	ConnectToCurrentHost();
 }
 
 
@@ -290,64 +342,315 @@ void Client::LoadCameraXMLDefinitions()
 
 
 void Client::ReceiveMessagesFromHostIfAny()
+{
+	bool isUsingNetworkThread = m_networkThread.IsRunning();
+	int numQueuedDatagrams = 0;
+
+	m_packetsReceivedThisFrame.clear();
+
+	//a replay stands in for the host entirely
+	if( IsReplayingCapture() && m_replaySpeed <= 0.f )
+	{
+		RunCaptureReplayBenchmark();
+		return;
+	}
+
+	if( IsReplayingCapture() )
+	{
+		//the replay may have been queued from the command line, before the clock started
+		if( m_replayStartTimeSeconds < 0.0 )
+		{
+			m_replayStartTimeSeconds = Time::GetCurrentTimeInSeconds();
+		}
+
+		double replayTimeSeconds = ( Time::GetCurrentTimeInSeconds() - m_replayStartTimeSeconds ) * m_replaySpeed;
+
+		GatherPacketsFromCaptureReplay( replayTimeSeconds, INT_MAX );
+		ProcessPacketsReceivedThisFrame();
+		return;
+	}
+
+	//packets are decoded out of the datagrams, which go back once the frame's packets are processed
+	if( isUsingNetworkThread )
+	{
+		numQueuedDatagrams = m_networkThread.GetNumReceivedDatagrams();
+		GatherPacketsFromNetworkThread( numQueuedDatagrams );
+	}
+	else
+	{
+		GatherPacketsFromNetwork();
+	}
+
+	ProcessPacketsReceivedThisFrame();
+
+	if( isUsingNetworkThread )
+	{
+		m_networkThread.ReleaseReceivedDatagrams( numQueuedDatagrams );
+	}
+	else
+	{
+		Network::GetInstance().ReleaseReceivedDatagrams( m_connectionToHostID );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Only the datagrams queued when the frame started are read, later ones wait for the next frame
+void Client::GatherPacketsFromNetworkThread( int numQueuedDatagrams )
+{
+	for( int i = 0; i < numQueuedDatagrams; ++i )
+	{
+		const QueuedDatagram* datagram = m_networkThread.GetReceivedDatagram( i );
+
+		DecodeReceivedPackets( datagram->data, datagram->numBytes, datagram->arrivalTimeSeconds );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Client::GatherPacketsFromNetwork()
 {
 	Network& theNetwork = Network::GetInstance();
-	std::set< FinalPacket > packetQueueForThisFrame;
 
-	int bytesReceived = 0;
+	ReceivedDatagram* receivedDatagrams = nullptr;
+	int numDatagramsReceived = 0;
 
-	do 
+	while( ( numDatagramsReceived = theNetwork.ReceiveUDPMessagesInPlace( m_connectionToHostID, receivedDatagrams ) ) > 0 )
 	{
-		FinalPacket receivedPacket;
-		bytesReceived = 0;
+		for( int i = 0; i < numDatagramsReceived; ++i )
+		{
+			DecodeReceivedPackets( receivedDatagrams[ i ].buffer, receivedDatagrams[ i ].bytesReceived, receivedDatagrams[ i ].arrivalTimeSeconds );
+		}
+	}
+}
 
-		ZeroMemory( &receivedPacket, sizeof( receivedPacket ) );
 
-		bytesReceived = theNetwork.ReceiveUDPMessage( ( char* )&receivedPacket, sizeof( receivedPacket ), m_connectionToHostID );
-			
-		if( bytesReceived == sizeof( FinalPacket ) )
+//-----------------------------------------------------------------------------------------------
+//Arrival times are spread out at the replay speed, so the stats see the recorded spacing
+void Client::GatherPacketsFromCaptureReplay( double replayTimeSeconds, int maxNumPackets )
+{
+	while( m_hasNextReplayedDatagram && m_nextReplayedDatagram.timestampSeconds <= replayTimeSeconds && static_cast< int >( m_packetsReceivedThisFrame.size() ) < maxNumPackets )
+	{
+		double arrivalTimeSeconds = m_replayStartTimeSeconds;
+
+		if( m_replaySpeed > 0.f )
 		{
-			packetQueueForThisFrame.insert( receivedPacket );
+			arrivalTimeSeconds += m_nextReplayedDatagram.timestampSeconds / m_replaySpeed;
 		}
 
-	} 
-	while ( bytesReceived > 0 );
+		if( !m_nextReplayedDatagram.data.empty() )
+		{
+			DecodeReceivedPackets( &m_nextReplayedDatagram.data[ 0 ], static_cast< int >( m_nextReplayedDatagram.data.size() ), arrivalTimeSeconds );
+		}
+
+		AdvanceCaptureReplay();
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//The host packs several packets into a datagram. Whatever is left once a packet fails to decode is
+//counted with the datagram and dropped, which is everything from a host on another protocol version.
+void Client::DecodeReceivedPackets( const char* data, int numBytes, double arrivalTimeSeconds )
+{
+	m_hostConnectionStats.RecordPacketReceived( numBytes );
+
+	int numBytesDecoded = 0;
 
+	while( numBytesDecoded < numBytes )
+	{
+		ReceivedPacket receivedPacket;
+
+		int numPacketBytes = m_packetSerializer.ReadPacket( data + numBytesDecoded, numBytes - numBytesDecoded, receivedPacket.packet, &m_receivedSnapshots );
+
+		if( numPacketBytes == 0 )
+		{
+			return;
+		}
+
+		numBytesDecoded += numPacketBytes;
+
+		//acks are good whatever order the packet arrived in, and even if its body is not
+		m_currentPacketArrivalTimeSeconds = arrivalTimeSeconds;
+		OnReceivePiggybackedAcks( receivedPacket.packet );
+
+		//a delta against an update this end no longer has, the host goes back to full updates in time
+		if( receivedPacket.packet.type == TYPE_None )
+		{
+			continue;
+		}
 
-	auto packetQueueIterator = packetQueueForThisFrame.begin();
+		if( receivedPacket.packet.type == TYPE_GameUpdate )
+		{
+			m_receivedSnapshots.RecordSnapshot( receivedPacket.packet );
+		}
+
+		receivedPacket.arrivalTimeSeconds = arrivalTimeSeconds;
+		m_packetsReceivedThisFrame.push_back( receivedPacket );
+	}
+}
 
 
-	for( ; packetQueueIterator != packetQueueForThisFrame.end(); ++packetQueueIterator )
+//-----------------------------------------------------------------------------------------------
+//Same order and duplicate rule as the std::set this replaced, lowest packet number first and the
+//first copy wins. Insertion sort keeps it stable and allocation free, and packets mostly arrive in order.
+void Client::SortPacketsReceivedThisFrame()
+{
+	int numPackets = static_cast< int >( m_packetsReceivedThisFrame.size() );
+	int numUniquePackets = 0;
+
+	for( int i = 0; i < numPackets; ++i )
 	{
-		ProcessPacket( *packetQueueIterator );
-	}	
+		ReceivedPacket packetToInsert = m_packetsReceivedThisFrame[ i ];
+		int insertIndex = numUniquePackets;
+
+		while( insertIndex > 0 && packetToInsert.packet < m_packetsReceivedThisFrame[ insertIndex - 1 ].packet )
+		{
+			--insertIndex;
+		}
+
+		if( insertIndex > 0 && !( m_packetsReceivedThisFrame[ insertIndex - 1 ].packet < packetToInsert.packet ) )
+		{
+			m_hostConnectionStats.RecordDuplicateReceived();
+			continue;
+		}
+
+		for( int j = numUniquePackets; j > insertIndex; --j )
+		{
+			m_packetsReceivedThisFrame[ j ] = m_packetsReceivedThisFrame[ j - 1 ];
+		}
+
+		m_packetsReceivedThisFrame[ insertIndex ] = packetToInsert;
+		++numUniquePackets;
+	}
+
+	m_packetsReceivedThisFrame.resize( numUniquePackets );
 }
 
 
 //-----------------------------------------------------------------------------------------------
-void Client::PotentiallySendJoinLobbyPacketToServer( float& elapsedSendTime, float sendToTime )
+void Client::ProcessPacketsReceivedThisFrame()
 {
-	if( elapsedSendTime < sendToTime )
+	SortPacketsReceivedThisFrame();
+
+	for( int i = 0; i < static_cast< int >( m_packetsReceivedThisFrame.size() ); ++i )
 	{
-		return;
+		m_currentPacketArrivalTimeSeconds = m_packetsReceivedThisFrame[ i ].arrivalTimeSeconds;
+
+		ProcessPacket( m_packetsReceivedThisFrame[ i ].packet );
 	}
+}
 
-	FinalPacket gameStartAckPacket = GetJoinRoomPacket( ROOM_Lobby );
 
-	SendMessageToHost( gameStartAckPacket );
+//-----------------------------------------------------------------------------------------------
+//Only what the client received is replayed, its own sends are in the capture for reference
+void Client::AdvanceCaptureReplay()
+{
+	m_hasNextReplayedDatagram = false;
 
-	elapsedSendTime = 0.f;
+	while( m_captureReplay.ReadNextRecord( m_nextReplayedDatagram ) )
+	{
+		if( m_nextReplayedDatagram.direction == CAPTURE_RECEIVED )
+		{
+			m_hasNextReplayedDatagram = true;
+			return;
+		}
+	}
+
+	m_captureReplay.Close();
+
+	if( ConsoleLog::s_currentLog != nullptr )
+	{
+		ConsoleLog::s_currentLog->ConsolePrint( "Capture replay finished" );
+	}
 }
 
 
 //-----------------------------------------------------------------------------------------------
-void Client::PotentiallySendKeepAlivePacketToServer( float& elapsedSendTime, float sendToTime )
+//Feeds the whole capture through the same gather, sort and process steps as a live frame, and
+//reports how long the processing took
+void Client::RunCaptureReplayBenchmark()
 {
-	if( elapsedSendTime < sendToTime )
+	int numPacketsReplayed = 0;
+	double processingSeconds = 0.0;
+
+	while( IsReplayingCapture() )
 	{
-		return;
+		m_packetsReceivedThisFrame.clear();
+
+		double startTimeSeconds = Time::GetCurrentTimeInSeconds();
+
+		m_replayStartTimeSeconds = startTimeSeconds;
+		GatherPacketsFromCaptureReplay( DBL_MAX, REPLAY_BENCHMARK_PACKETS_PER_FRAME );
+
+		numPacketsReplayed += static_cast< int >( m_packetsReceivedThisFrame.size() );
+
+		ProcessPacketsReceivedThisFrame();
+
+		processingSeconds += Time::GetCurrentTimeInSeconds() - startTimeSeconds;
+	}
+
+	std::ostringstream outputStringStream;
+
+	outputStringStream << "Replayed " << numPacketsReplayed << " packets in " << processingSeconds * 1000.0 << "ms";
+
+	if( processingSeconds > 0.0 )
+	{
+		outputStringStream << ", " << static_cast< int >( static_cast< double >( numPacketsReplayed ) / processingSeconds ) << " packets per second";
+	}
+
+	ConsoleLog::s_currentLog->ConsolePrint( outputStringStream.str() );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Client::ProcessExpiredTimers()
+{
+	double currentTime = Time::GetCurrentTimeInSeconds();
+
+	m_expiredTimers.clear();
+	m_timerWheel.CollectExpiredTimers( currentTime, m_expiredTimers );
+
+	for( int i = 0; i < static_cast< int >( m_expiredTimers.size() ); ++i )
+	{
+		if( m_expiredTimers[ i ].timerType == TIMER_HEARTBEAT )
+		{
+			OnHeartbeatTimerExpired( currentTime );
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Keeps running in every state so nothing has to be scheduled on state changes. In game the update
+//packets already keep the connection alive.
+void Client::OnHeartbeatTimerExpired( double currentTimeSeconds )
+{
+	if( m_currentState == CLIENT_UNCONNECTED )
+	{
+		SendJoinLobbyPacketToServer();
+	}
+	else if( m_currentState == CLIENT_IN_LOBBY || m_currentState == CLIENT_AWAITING_RESET )
+	{
+		SendKeepAlivePacketToServer();
 	}
 
+	m_timerWheel.Schedule( currentTimeSeconds + SEND_TO_HOST_MAX_DELAY, TIMER_HEARTBEAT, 0, 0 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Client::SendJoinLobbyPacketToServer()
+{
+	FinalPacket gameStartAckPacket = GetJoinRoomPacket( ROOM_Lobby );
+
+	SendMessageToHost( gameStartAckPacket );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Client::SendKeepAlivePacketToServer()
+{
 	FinalPacket keepAlivePacket;
 
 	ZeroMemory( &keepAlivePacket, sizeof( keepAlivePacket ) );
@@ -355,87 +658,331 @@ void Client::PotentiallySendKeepAlivePacketToServer( float& elapsedSendTime, flo
 	keepAlivePacket.type = TYPE_KeepAlive;
 
 	SendMessageToHost( keepAlivePacket );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//An update the link has no room for waits for a later frame and is built fresh then, so a saturated
+//link sends fewer updates rather than queueing old ones
+void Client::PotentiallySendUpdatePacketToServer( float& elapsedSendTime, float sendToTime )
+{
+	if( elapsedSendTime < sendToTime )
+	{
+		return;
+	}
+
+	if( !m_hostSendPacer.CanSend() )
+	{
+		m_hostSendPacer.RecordSendSkipped();
+		return;
+	}
+
+	FinalPacket updatePacket = GetUpdatePacket();
+
+	SendMessageToHost( updatePacket );
+
+	elapsedSendTime = 0.f;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Client::ResendReliablePacket( FinalPacket& packetToSend )
+{
+	packetToSend.timestamp = Time::GetCurrentTimeInSeconds();
+
+	m_hostConnectionStats.RecordReliablePacketResent( packetToSend.number );
+	SendPacketBytesToHost( packetToSend );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Each resend waits twice as long as the one before, starting from the host's measured round trip
+void Client::PotentiallyResendReliablePacketsThatHaventBeenAckedBack()
+{
+	double currentTime = Time::GetCurrentTimeInSeconds();
+	uint endNumber = m_reliablePacketsSentToServer.GetEndSequenceNumber();
+
+	for( uint number = m_reliablePacketsSentToServer.GetOldestSequenceNumber(); number != endNumber; ++number )
+	{
+		ReliableSendWindow< FinalPacket >::InFlightMessage* inFlightPacket = m_reliablePacketsSentToServer.Find( number );
+
+		if( inFlightPacket == nullptr || currentTime < inFlightPacket->resendTimeSeconds )
+		{
+			continue;
+		}
+
+		++inFlightPacket->numTimesResent;
+		inFlightPacket->resendTimeSeconds = currentTime + m_hostConnectionStats.GetRetransmitTimeoutSeconds( inFlightPacket->numTimesResent );
+
+		ResendReliablePacket( inFlightPacket->message );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Client::SendFirePacket()
+{
+	FinalPacket firePacket;
+	ZeroMemory( &firePacket, sizeof( firePacket ) );
+
+	firePacket.type = TYPE_Fire;
+	firePacket.data.gunfire.instigatorID = m_localPlayer->GetID();
+
+	SendMessageToHost( firePacket );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Queued on its channel, FlushMessagesToHost numbers and sends it
+void Client::SendMessageToHost( FinalPacket& packetToSend )
+{
+	m_messagesToHostByChannel[ packetToSend.GetChannel() ].push_back( packetToSend );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Channels go out highest priority first. Once the pacer has nothing left the top channel still goes,
+//the rest wait: reliable messages for a later frame, unreliable ones are dropped as a newer one follows.
+//Control is the top channel, so a packet carrying acks is never held back.
+//Reliable messages also wait while the send window has no room for another one.
+void Client::SendQueuedMessagesToHostByPriority()
+{
+	for( int i = 0; i < NUM_CHANNELS; ++i )
+	{
+		ChannelID channel = m_channelsByPriority[ i ];
+		std::vector< FinalPacket >& queuedMessages = m_messagesToHostByChannel[ channel ];
+		int numQueuedMessages = static_cast< int >( queuedMessages.size() );
+		int numSent = 0;
+		bool isGuaranteed = CHANNEL_DEFINITIONS[ channel ].delivery != DELIVERY_UnreliableSequenced;
+
+		while( numSent < numQueuedMessages && ( i == 0 || m_hostSendPacer.CanSend() )
+			&& ( !isGuaranteed || m_reliablePacketsSentToServer.HasRoomFor( m_mostRecentReliablePacketSentNum ) ) )
+		{
+			SendQueuedMessageToHost( queuedMessages[ numSent ] );
+			++numSent;
+		}
+
+		if( isGuaranteed )
+		{
+			queuedMessages.erase( queuedMessages.begin(), queuedMessages.begin() + numSent );
+			continue;
+		}
+
+		for( int j = numSent; j < numQueuedMessages; ++j )
+		{
+			m_hostSendPacer.RecordSendSkipped();
+		}
+
+		queuedMessages.clear();
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Numbered, stamped and put in flight only as it goes out. Messages held back by priority or the pacer,
+//or dropped as stale, never take a number, so the host sees numbers in the order they were sent and a
+//gap only where a packet was lost. Time spent queued never counts toward the round trip either.
+void Client::SendQueuedMessageToHost( FinalPacket& packetToSend )
+{
+	ChannelID channel = packetToSend.GetChannel();
+
+	packetToSend.timestamp = Time::GetCurrentTimeInSeconds();
+	packetToSend.channelSequence = m_nextChannelSequencesToSend[ channel ];
+	++m_nextChannelSequencesToSend[ channel ];
+
+	if( packetToSend.IsGuaranteed() )
+	{
+		double resendTime = packetToSend.timestamp + m_hostConnectionStats.GetRetransmitTimeoutSeconds( 0 );
+
+		packetToSend.number = m_mostRecentReliablePacketSentNum;
+		++m_mostRecentReliablePacketSentNum;
+
+		m_hostConnectionStats.RecordReliablePacketSent( packetToSend.number, packetToSend.timestamp );
+		m_reliablePacketsSentToServer.Add( packetToSend.number, packetToSend, resendTime );
+	}
+	else
+	{
+		packetToSend.number = m_mostRecentUnreliablePacketSentNum;
+		++m_mostRecentUnreliablePacketSentNum;
+	}
+
+	if( packetToSend.type == TYPE_GameUpdate )
+	{
+		m_sentSnapshots.RecordSnapshot( packetToSend );
+	}
+
+	SendPacketBytesToHost( packetToSend );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Packed in with everything else sent this frame, FlushMessagesToHost sends it
+void Client::SendPacketBytesToHost( const FinalPacket& packetToSend )
+{
+	//replies to replayed packets have nowhere to go
+	if( IsReplayingCapture() )
+	{
+		return;
+	}
+
+	const FinalPacket* baseline = nullptr;
+
+	if( packetToSend.type == TYPE_GameUpdate )
+	{
+		baseline = m_sentSnapshots.GetBaselineForSnapshot( packetToSend.clientID, packetToSend.number );
+	}
+
+	//the first packet in the frame carries the acks, the rest go out with none rather than whatever was queued
+	FinalPacket packetWithAcks = packetToSend;
+
+	if( m_messagesToHost.IsEmpty() )
+	{
+		packetWithAcks.guaranteedAcks = m_guaranteedPacketsReceived;
+		packetWithAcks.updateAcks = m_updatesReceived;
+		m_hasNewAcksToSend = false;
+	}
+	else
+	{
+		packetWithAcks.guaranteedAcks.hasAcks = false;
+		packetWithAcks.updateAcks.hasAcks = false;
+	}
+
+	char packetBytes[ MAX_SERIALIZED_FINAL_PACKET_BYTES ];
+	int numPacketBytes = m_packetSerializer.WritePacket( packetWithAcks, packetBytes, sizeof( packetBytes ), baseline );
+
+	//charged as it is packed, so lower priority channels see what higher ones used this frame
+	m_hostSendPacer.RecordBytesSent( numPacketBytes );
+	m_messagesToHost.AppendMessage( packetBytes, numPacketBytes );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//With the network thread running this only queues the datagrams, so a slow frame never holds them up
+void Client::FlushMessagesToHost()
+{
+	Network& theNetwork = Network::GetInstance();
+
+	SendQueuedMessagesToHostByPriority();
+
+	if( HasHostStoppedAcking() )
+	{
+		ReconnectToStalledHost();
+		return;
+	}
+
+	//nothing else went out this frame to carry the acks
+	if( m_hasNewAcksToSend && m_messagesToHost.IsEmpty() )
+	{
+		SendKeepAlivePacketToServer();
+		SendQueuedMessagesToHostByPriority();
+	}
+
+	for( int i = 0; i < m_messagesToHost.GetNumDatagrams(); ++i )
+	{
+		int datagramSize = 0;
+		const char* datagram = m_messagesToHost.GetDatagram( i, datagramSize );
+
+		m_hostConnectionStats.RecordPacketSent( datagramSize );
+
+		if( m_networkThread.IsRunning() )
+		{
+			m_networkThread.SendTo( m_hostAddress, datagram, datagramSize );
+		}
+		else
+		{
+			theNetwork.SendUDPMessage( ( char* )datagram, datagramSize, m_connectionToHostID );
+		}
+	}
+
+	m_messagesToHost.Clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//A full window unacked and another one's worth of guaranteed messages waiting behind it
+bool Client::HasHostStoppedAcking() const
+{
+	if( IsReplayingCapture() || m_reliablePacketsSentToServer.HasRoomFor( m_mostRecentReliablePacketSentNum ) )
+	{
+		return false;
+	}
+
+	int numGuaranteedMessagesWaiting = 0;
+
+	for( int i = 0; i < NUM_CHANNELS; ++i )
+	{
+		if( CHANNEL_DEFINITIONS[ i ].delivery != DELIVERY_UnreliableSequenced )
+		{
+			numGuaranteedMessagesWaiting += static_cast< int >( m_messagesToHostByChannel[ i ].size() );
+		}
+	}
 
-	elapsedSendTime = 0.f;
+	return numGuaranteedMessagesWaiting > MAX_GUARANTEED_MESSAGES_WAITING_FOR_ROOM;
 }
 
 
 //-----------------------------------------------------------------------------------------------
-void Client::PotentiallySendUpdatePacketToServer( float& elapsedSendTime, float sendToTime )
+//Everything sent is given up on and the client joins again from a new socket, which the host sees
+//as a new client
+void Client::ReconnectToStalledHost()
 {
-	if( elapsedSendTime < sendToTime )
+	if( ConsoleLog::s_currentLog != nullptr )
 	{
-		return;
+		ConsoleLog::s_currentLog->ConsolePrint( "Error: host stopped acking, reconnecting", HOST_RESOLVE_ERROR_COLOR, true );
 	}
 
-	FinalPacket updatePacket = GetUpdatePacket();
-
-	SendMessageToHost( updatePacket );
-
-	elapsedSendTime = 0.f;
-}
+	m_reliablePacketsSentToServer.Clear();
+	m_mostRecentReliablePacketSentNum = 0;
+	m_mostRecentUnreliablePacketSentNum = 0;
+	m_messagesToHost.Clear();
 
+	m_currentState = CLIENT_UNCONNECTED;
+	m_currentRoomID = ROOM_Lobby;
+	m_selectedRoomID = 0;
+	m_currentJoinRoomRequestNum = 0;
+	m_otherClientsPlayers.clear();
 
-//-----------------------------------------------------------------------------------------------
-void Client::ResendReliablePacket( FinalPacket& packetToSend )
-{
-	packetToSend.timestamp = Time::GetCurrentTimeInSeconds();
+	std::ostringstream portAsString;
+	portAsString << m_currentHostPort;
 
-	Network& theNetwork = Network::GetInstance();
-	theNetwork.SendUDPMessage( ( char* )&packetToSend, sizeof( packetToSend ), m_connectionToHostID );
+	ChangeHost( m_currentHostIPAddressAsString, portAsString.str() );
 }
 
 
 //-----------------------------------------------------------------------------------------------
-void Client::PotentiallyResendReliablePacketsThatHaventBeenAckedBack()
+void Client::StartNetworkThreadIfEnabled()
 {
-	for( auto iter = m_queueOfReliablePacketsSentToServer.begin(); iter != m_queueOfReliablePacketsSentToServer.end(); ++iter )
+	if( !m_useNetworkThread )
 	{
-		if( Time::GetCurrentTimeInSeconds() - iter->timestamp >= RESEND_RELIABLE_PACKETS_DELAY )
-		{
-			ResendReliablePacket( *iter );
-		}
+		return;
 	}
+
+	m_hostAddress = Network::GetInstance().GetPeerAddressFromConnection( m_connectionToHostID );
+	m_networkThread.StartUp( m_connectionToHostID );
 }
 
 
 //-----------------------------------------------------------------------------------------------
-void Client::SendFirePacket()
+//The host may be a name rather than an IP. Dotted IPs and cached names connect before this
+//returns, anything else connects from OnHostResolved once a worker has looked it up.
+void Client::ConnectToCurrentHost()
 {
-	FinalPacket firePacket;
-
-	firePacket.type = TYPE_Fire;
-	firePacket.data.gunfire.instigatorID = m_localPlayer->GetID();
-
-	SendMessageToHost( firePacket );
+	HostNameResolver::GetInstance().ResolveAsync( m_currentHostIPAddressAsString, "clientHostResolved" );
 }
 
 
 //-----------------------------------------------------------------------------------------------
-void Client::SendMessageToHost( FinalPacket& packetToSend )
+//Every channel's numbering starts over with a new host, and nothing queued for the old one goes out
+void Client::ResetChannels()
 {
-	packetToSend.timestamp = Time::GetCurrentTimeInSeconds();
-
-	if( packetToSend.IsGuaranteed() )
-	{
-		packetToSend.number = m_mostRecentReliablePacketSentNum;
-		++m_mostRecentReliablePacketSentNum;
-
-		m_queueOfReliablePacketsSentToServer.push_back( packetToSend );
-	}
-	else
+	for( int i = 0; i < NUM_CHANNELS; ++i )
 	{
-		packetToSend.number = m_mostRecentUnreliablePacketSentNum;
-		++m_mostRecentUnreliablePacketSentNum;
+		m_nextChannelSequencesToSend[ i ] = 0;
+		m_newestUnreliableChannelSequences[ i ] = 0;
+		m_hasReceivedOnUnreliableChannel[ i ] = false;
+		m_reliableChannelsFromHost[ i ].Reset( 0 );
+		m_messagesToHostByChannel[ i ].clear();
 	}
-
-	//if( packetToSend.type != TYPE_GameUpdate )
-	//{
-	//	
-	//}
-
-	Network& theNetwork = Network::GetInstance();
-	theNetwork.SendUDPMessage( ( char* )&packetToSend, sizeof( packetToSend ), m_connectionToHostID );
 }
 
 
@@ -458,6 +1005,56 @@ void Client::AckBackSuccessfulReliablePacketReceive( const FinalPacket& packet )
 }
 
 
+//-----------------------------------------------------------------------------------------------
+//Guaranteed packets sent to the host that a header acks are done with, the same as if an Ack
+//packet had come for each. Acked updates become delta baselines.
+void Client::OnReceivePiggybackedAcks( const FinalPacket& packet )
+{
+	const PacketAcks& updateAcks = packet.updateAcks;
+
+	//newest first, an older ack never replaces a newer baseline anyway
+	for( int i = 0; updateAcks.hasAcks && i <= NUM_ACK_HISTORY_BITS; ++i )
+	{
+		if( updateAcks.Contains( updateAcks.newestNumber - i ) )
+		{
+			m_sentSnapshots.OnSnapshotAcked( updateAcks.newestNumber - i );
+		}
+	}
+
+	if( !packet.guaranteedAcks.hasAcks )
+	{
+		return;
+	}
+
+	const PacketAcks& guaranteedAcks = packet.guaranteedAcks;
+
+	for( int i = 0; i <= NUM_ACK_HISTORY_BITS; ++i )
+	{
+		PacketNumber ackedNumber = guaranteedAcks.newestNumber - i;
+		ReliableSendWindow< FinalPacket >::InFlightMessage* inFlightPacket = m_reliablePacketsSentToServer.Find( ackedNumber );
+
+		if( inFlightPacket == nullptr || !guaranteedAcks.Contains( ackedNumber ) )
+		{
+			continue;
+		}
+
+		FinalPacket ackedPacket = inFlightPacket->message;
+
+		m_reliablePacketsSentToServer.Remove( ackedNumber );
+		m_hostConnectionStats.RecordReliablePacketAcked( ackedPacket.number, m_currentPacketArrivalTimeSeconds );
+
+		if( ackedPacket.type == TYPE_JoinRoom )
+		{
+			OnReceiveAckJoinRoomPacket( ackedPacket );
+		}
+		else if( ackedPacket.type == TYPE_CreateRoom )
+		{
+			OnReceiveAckCreateRoomPacket( ackedPacket );
+		}
+	}
+}
+
+
 //-----------------------------------------------------------------------------------------------
 void Client::RenderListedRooms() const
 {
@@ -632,93 +1229,135 @@ void Client::UpdateCameras()
 //-----------------------------------------------------------------------------------------------
 void Client::ProcessPacket( const FinalPacket& packet )
 {
-	//bool shouldProcessReliablePacketsInQueue = false;
-	bool ignorePacket = false;
-
 	OutputReceivedPacket( packet );
 
-	if( packet.type == TYPE_GameReset && m_currentState == CLIENT_IN_LOBBY || m_currentState == CLIENT_AWAITING_RESET )
+	if( packet.IsGuaranteed() )
 	{
-		m_mostRecentResetInfo = packet;
+		ProcessGuaranteedPacket( packet );
+		return;
 	}
 
-	if( packet.IsGuaranteed() )
+	m_hostConnectionStats.RecordSequencedPacketReceived( packet.number );
+
+	if( packet.type == TYPE_GameUpdate )
 	{
-		//FUTURE EDIT: Ack to Server that client received reliable packet!
+		m_updatesReceived.RecordReceived( packet.number );
+		m_hasNewAcksToSend = true;
+	}
 
-		AckBackSuccessfulReliablePacketReceive( packet );
+	//acks and nacks answer packets this end sent, they are never stale however late they arrive
+	if( packet.type == TYPE_Ack || packet.type == TYPE_Nack )
+	{
+		ProcessPacketContents( packet );
+		return;
+	}
 
-		if( packet.number <= m_mostRecentlyProcessedReliablePacketNum )
-		{
-			ignorePacket = true;
-		}
-		else
-		{
-			m_mostRecentlyProcessedReliablePacketNum = packet.number;
-		}
+	ChannelID channel = packet.GetChannel();
+	PacketNumber numbersAhead = packet.channelSequence - m_newestUnreliableChannelSequences[ channel ];
+
+	//unreliable packets are only worth anything while they are the newest on their channel
+	if( m_hasReceivedOnUnreliableChannel[ channel ] && ( numbersAhead == 0 || numbersAhead >= 0x80000000 ) )
+	{
+		return;
 	}
-	else
+
+	m_newestUnreliableChannelSequences[ channel ] = packet.channelSequence;
+	m_hasReceivedOnUnreliableChannel[ channel ] = true;
+
+	ProcessPacketContents( packet );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Each channel has its own receive window. On an ordered channel a packet that arrives ahead of a gap
+//waits until the gap is filled, so a lost Respawn is resent and still lands before whatever the host
+//sent after it on that channel, and holds up nothing on any other. Unordered channels hand packets
+//over as they arrive, the window only spots the resent copies.
+void Client::ProcessGuaranteedPacket( const FinalPacket& packet )
+{
+	ChannelID channel = packet.GetChannel();
+	ReliableReceiveWindow< FinalPacket >& channelWindow = m_reliableChannelsFromHost[ channel ];
+	bool isOrdered = CHANNEL_DEFINITIONS[ channel ].delivery == DELIVERY_ReliableOrdered;
+
+	ReliableReceiveResult receiveResult = isOrdered ? channelWindow.Receive( packet.channelSequence, packet ) : channelWindow.ReceiveUnordered( packet.channelSequence );
+
+	//not kept, so not acked either, the host sends it again later
+	if( receiveResult == RECEIVE_TooFarAhead )
 	{
-		if( packet.number <= m_mostRecentlyProcessedUnreliablePacketNum )
-		{
-			ignorePacket = true;
-		}
-		else
-		{
-			m_mostRecentlyProcessedUnreliablePacketNum = packet.number;
-		}	
+		return;
 	}
 
-	if( !ignorePacket )
+	//acked in the header of the next packet sent, unless it is too old to fit there
+	if( !m_guaranteedPacketsReceived.RecordReceived( packet.number ) )
 	{
-		PacketType typeOfPacket = packet.type;
+		AckBackSuccessfulReliablePacketReceive( packet );
+	}
 
-		if( typeOfPacket == TYPE_GameUpdate )
-		{
-			OnReceiveGameUpdatePacket( packet );
-		}
-		else if( typeOfPacket == TYPE_Ack )
-		{
-			OnReceiveAckPacket( packet );
-		}
-		else if( typeOfPacket == TYPE_LobbyUpdate )
-		{
-			OnReceiveLobbyUpdatePacket( packet );
-		}
-		else if( typeOfPacket == TYPE_Nack )
-		{
-			OnReceiveNackPacket( packet );
-		}
-		else if( typeOfPacket == TYPE_ReturnToLobby )
-		{
-			OnReceiveReturnToLobbyPacket( packet );
-		}
-		else if( typeOfPacket == TYPE_Fire )
-		{
-			OnReceiveFirePacket( packet );
-		}
-		else if( typeOfPacket == TYPE_Hit )
-		{
-			OnReceiveHitPacket( packet );
-		}
-		else if( typeOfPacket == TYPE_Respawn )
-		{
-			OnReceiveRespawnPacket( packet );
-		}
+	m_hasNewAcksToSend = true;
+
+	if( receiveResult == RECEIVE_Duplicate )
+	{
+		m_hostConnectionStats.RecordDuplicateReceived();
+		return;
+	}
+
+	if( !isOrdered )
+	{
+		ProcessPacketContents( packet );
+		return;
 	}
 
-	//ProcessAnyQueuedReliablePackets();
+	FinalPacket packetInOrder;
+
+	while( channelWindow.PopNextInOrder( packetInOrder ) )
+	{
+		ProcessPacketContents( packetInOrder );
+	}
 }
 
 
 //-----------------------------------------------------------------------------------------------
-void Client::ProcessAnyQueuedReliablePackets()
+void Client::ProcessPacketContents( const FinalPacket& packet )
 {
-	//if( !m_queueOfReliablePacketsToParse.empty() && m_queueOfReliablePacketsToParse.begin()->number <= m_nextExpectedReliablePacketNumToProcess )
-	//{
-	//	m_queueOfReliablePacketsToParse.erase( m_queueOfReliablePacketsToParse.begin() );
-	//	ProcessPacket( *m_queueOfReliablePacketsToParse.begin() );
-	//}
+	if( packet.type == TYPE_GameReset && m_currentState == CLIENT_IN_LOBBY || m_currentState == CLIENT_AWAITING_RESET )
+	{
+		m_mostRecentResetInfo = packet;
+	}
+
+	PacketType typeOfPacket = packet.type;
+
+	if( typeOfPacket == TYPE_GameUpdate )
+	{
+		OnReceiveGameUpdatePacket( packet );
+	}
+	else if( typeOfPacket == TYPE_Ack )
+	{
+		OnReceiveAckPacket( packet );
+	}
+	else if( typeOfPacket == TYPE_LobbyUpdate )
+	{
+		OnReceiveLobbyUpdatePacket( packet );
+	}
+	else if( typeOfPacket == TYPE_Nack )
+	{
+		OnReceiveNackPacket( packet );
+	}
+	else if( typeOfPacket == TYPE_ReturnToLobby )
+	{
+		OnReceiveReturnToLobbyPacket( packet );
+	}
+	else if( typeOfPacket == TYPE_Fire )
+	{
+		OnReceiveFirePacket( packet );
+	}
+	else if( typeOfPacket == TYPE_Hit )
+	{
+		OnReceiveHitPacket( packet );
+	}
+	else if( typeOfPacket == TYPE_Respawn )
+	{
+		OnReceiveRespawnPacket( packet );
+	}
 }
 
 
@@ -792,6 +1431,20 @@ void Client::OnReceiveAckPacket( const FinalPacket& ackPacket )
 {
 	PacketType ackType = ackPacket.data.acknowledged.type;
 
+	//update numbers come from the unreliable sequence, they would match the wrong reliable packets
+	if( ackType == TYPE_GameUpdate )
+	{
+		m_sentSnapshots.OnSnapshotAcked( ackPacket.data.acknowledged.number );
+		return;
+	}
+
+	//already acked by a header or an earlier copy of this ack
+	if( m_reliablePacketsSentToServer.Find( ackPacket.data.acknowledged.number ) == nullptr )
+	{
+		return;
+	}
+
+	m_hostConnectionStats.RecordReliablePacketAcked( ackPacket.data.acknowledged.number, m_currentPacketArrivalTimeSeconds );
 	RemoveReliablePacketFromQueue( ackPacket );
 
 	if( ackType == TYPE_JoinRoom )
@@ -808,6 +1461,7 @@ void Client::OnReceiveAckPacket( const FinalPacket& ackPacket )
 //-----------------------------------------------------------------------------------------------
 void Client::OnReceiveNackPacket( const FinalPacket& nackPacket )
 {
+	m_hostConnectionStats.RecordReliablePacketDropped( nackPacket.data.refused.number );
 	RemoveReliablePacketFromQueue( nackPacket );
 }
 
@@ -815,21 +1469,7 @@ void Client::OnReceiveNackPacket( const FinalPacket& nackPacket )
 //-----------------------------------------------------------------------------------------------
 void Client::RemoveReliablePacketFromQueue( const FinalPacket& packetToRemove )
 {
-	for( int i = 0; i < static_cast< int >( m_queueOfReliablePacketsSentToServer.size() ); ++ i )
-	{
-		if( packetToRemove.data.acknowledged.number == m_queueOfReliablePacketsSentToServer[ i ].number )
-		{
-			FinalPacket temp = m_queueOfReliablePacketsSentToServer.back();
-
-			if( i != static_cast< int >( m_queueOfReliablePacketsSentToServer.size() ) - 1 )
-			{
-				m_queueOfReliablePacketsSentToServer[ i ] = temp;
-				--i;
-			}
-
-			m_queueOfReliablePacketsSentToServer.pop_back();
-		}
-	}
+	m_reliablePacketsSentToServer.Remove( packetToRemove.data.acknowledged.number );
 }
 
 
@@ -1081,6 +1721,129 @@ void Client::SetServerPortFromParameters( NamedProperties& parameters )
 }
 
 
+//-----------------------------------------------------------------------------------------------
+void Client::EnableNetworkThread( NamedProperties& parameters )
+{
+	UNUSED( parameters );
+
+	m_useNetworkThread = true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Client::OnHostResolved( NamedProperties& parameters )
+{
+	std::string hostName;
+	std::string ipAddressAsString;
+	bool didResolve = false;
+
+	parameters.Get( "hostName", hostName );
+	parameters.Get( "ipAddress", ipAddressAsString );
+	parameters.Get( "didResolve", didResolve );
+
+	//the host was changed again while this one was resolving
+	if( hostName != m_currentHostIPAddressAsString || m_connectionToHostID != INVALID_CONNECTION_ID )
+	{
+		return;
+	}
+
+	if( !didResolve )
+	{
+		ConsoleLog::s_currentLog->ConsolePrint( "Error: could not resolve host " + hostName, HOST_RESOLVE_ERROR_COLOR, true );
+		return;
+	}
+
+	Network& theNetwork = Network::GetInstance();
+
+	m_connectionToHostID = theNetwork.CreateUDPSocketFromIPAndPort( ipAddressAsString.c_str(), m_currentHostPort );
+	StartNetworkThreadIfEnabled();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Client::ConsolePrintNetworkStats( NamedProperties& parameters )
+{
+	UNUSED( parameters );
+
+	std::ostringstream outputStringStream;
+
+	outputStringStream << "Host " << m_currentHostIPAddressAsString << ":" << m_currentHostPort;
+
+	Network::GetInstance().GetSocketStats( m_connectionToHostID ).ConsolePrintStats( "Socket" );
+	m_hostConnectionStats.ConsolePrintStats( outputStringStream.str() );
+	m_hostSendPacer.ConsolePrintStats();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//replayCapture <filePath> <speed>. Speed scales the recorded timing, 1 by default, and 0 replays
+//the whole capture on the next update as a processing benchmark. Nothing is sent while a replay runs.
+void Client::StartCaptureReplay( NamedProperties& parameters )
+{
+	std::string filePath;
+	std::string speedAsString;
+
+	parameters.Get( "param1", filePath );
+	parameters.Get( "param2", speedAsString );
+
+	if( !m_captureReplay.Open( filePath ) )
+	{
+		if( ConsoleLog::s_currentLog != nullptr )
+		{
+			ConsoleLog::s_currentLog->ConsolePrint( "Error: could not open capture " + filePath + ", or it was recorded by an older version", HOST_RESOLVE_ERROR_COLOR, true );
+		}
+
+		return;
+	}
+
+	m_replaySpeed = ( speedAsString != "" ) ? static_cast< float >( atof( speedAsString.c_str() ) ) : 1.f;
+	m_replayStartTimeSeconds = -1.0;
+	m_hostConnectionStats.Reset();
+	m_hostSendPacer.Reset();
+	ResetChannels();
+
+	AdvanceCaptureReplay();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//packetOrientationBits <bits>, 8 to 16. The host has to be told the same or facings come out wrong.
+void Client::SetPacketOrientationPrecision( NamedProperties& parameters )
+{
+	std::string numBitsAsString;
+
+	parameters.Get( "param1", numBitsAsString );
+
+	if( numBitsAsString == "" )
+	{
+		return;
+	}
+
+	m_packetSerializer.SetOrientationPrecisionBits( atoi( numBitsAsString.c_str() ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//maxDatagramSize <bytes>, how big a datagram of packed packets can get. Below the path MTU less 28
+//bytes of headers keeps them from fragmenting.
+void Client::SetMaxDatagramSize( NamedProperties& parameters )
+{
+	std::string maxDatagramSizeAsString;
+
+	parameters.Get( "param1", maxDatagramSizeAsString );
+
+	int maxDatagramSizeBytes = atoi( maxDatagramSizeAsString.c_str() );
+
+	//every packet has to fit in a datagram of its own
+	if( maxDatagramSizeBytes < MAX_SERIALIZED_FINAL_PACKET_BYTES )
+	{
+		maxDatagramSizeBytes = MAX_SERIALIZED_FINAL_PACKET_BYTES;
+	}
+
+	m_messagesToHost.SetMaxDatagramSize( maxDatagramSizeBytes );
+}
+
+
 //-----------------------------------------------------------------------------------------------
 FinalPacket	Client::GetJoinRoomPacket( RoomID roomToConnectTo ) const
 {
@@ -1256,5 +2019,4 @@ std::string Client::GetReceivedNackErrorCodeAsString( const ErrorCode& codeError
 	}
 
 	return result;
-}
-
+}
\ No newline at end of file
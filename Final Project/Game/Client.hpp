@@ -3,12 +3,21 @@
 
 #include <string>
 #include <vector>
-#include <set>
 
 #include "Engine/Networking/Network.hpp"
+#include "Engine/Networking/NetworkThread.hpp"
+#include "Engine/Networking/ConnectionStats.hpp"
+#include "Engine/Networking/PacketCapture.hpp"
+#include "Engine/Networking/MessageCoalescer.hpp"
+#include "Engine/Networking/ReliableSendWindow.hpp"
+#include "Engine/Networking/ReliableReceiveWindow.hpp"
+#include "Engine/Networking/SendPacer.hpp"
 #include "Engine/Utilities/EventSystem.hpp"
+#include "Engine/Utilities/TimerWheel.hpp"
 
 #include "FinalPacket.hpp"
+#include "FinalPacketSerializer.hpp"
+#include "SnapshotHistory.hpp"
 #include "ClientPlayer.hpp"
 #include "Camera3D.hpp"
 
@@ -48,6 +57,8 @@ public:
 
 	inline void	RegisterForEvents();
 	inline ClientState	GetClientState() const;
+	inline const ConnectionStats& GetHostConnectionStats() const;
+	inline bool IsReplayingCapture() const;
 
 	
 	ClientPlayer* GetLocalPlayer();
@@ -63,17 +74,37 @@ private:
 
 	void		LoadCameraXMLDefinitions();
 	void		ReceiveMessagesFromHostIfAny();
-
-	void		PotentiallySendJoinLobbyPacketToServer( float& elapsedSendTime, float sendToTime );
+	void		GatherPacketsFromNetworkThread( int numQueuedDatagrams );
+	void		GatherPacketsFromNetwork();
+	void		GatherPacketsFromCaptureReplay( double replayTimeSeconds, int maxNumPackets );
+	void		DecodeReceivedPackets( const char* data, int numBytes, double arrivalTimeSeconds );
+	void		SortPacketsReceivedThisFrame();
+	void		ProcessPacketsReceivedThisFrame();
+	void		AdvanceCaptureReplay();
+	void		RunCaptureReplayBenchmark();
+
+	void		ProcessExpiredTimers();
+	void		OnHeartbeatTimerExpired( double currentTimeSeconds );
+	void		SendJoinLobbyPacketToServer();
 	void		PotentiallySendJoinRoomPacketToServer( RoomID roomToJoin, float& elapsedSendTime, float sendToTime );
-	void		PotentiallySendKeepAlivePacketToServer( float& elapsedSendTime, float sendToTime );
+	void		SendKeepAlivePacketToServer();
 	void		PotentiallySendUpdatePacketToServer( float& elapsedSendTime, float sendToTime );
 	void		ResendReliablePacket( FinalPacket& packetToSend );
 	void		PotentiallyResendReliablePacketsThatHaventBeenAckedBack();
 	void		SendFirePacket();
 	void		SendMessageToHost( FinalPacket& packetToSend );
+	void		SendQueuedMessagesToHostByPriority();
+	void		SendQueuedMessageToHost( FinalPacket& packetToSend );
+	void		SendPacketBytesToHost( const FinalPacket& packetToSend );
+	void		FlushMessagesToHost();
+	bool		HasHostStoppedAcking() const;
+	void		ReconnectToStalledHost();
+	void		StartNetworkThreadIfEnabled();
+	void		ConnectToCurrentHost();
+	void		ResetChannels();
 
 	void		AckBackSuccessfulReliablePacketReceive( const FinalPacket& packet );
+	void		OnReceivePiggybackedAcks( const FinalPacket& packet );
 
 	void		UpdatePlayers();
 	void		UpdateCameras();
@@ -84,7 +115,8 @@ private:
 	void		RenderPlayer( const ClientPlayer& playerToRender ) const;
 
 	void		ProcessPacket( const FinalPacket& packet );
-	void		ProcessAnyQueuedReliablePackets();
+	void		ProcessGuaranteedPacket( const FinalPacket& packet );
+	void		ProcessPacketContents( const FinalPacket& packet );
 
 	void		OnReceiveReturnToLobbyPacket( const FinalPacket& returnToLobbyPacket );
 	void		OnReceiveLobbyUpdatePacket( const FinalPacket& lobbyUpdatePacket );
@@ -107,25 +139,71 @@ private:
 	void		SetPlayerParameters( NamedProperties& parameters );
 	void		SetServerIpFromParameters( NamedProperties& parameters );
 	void		SetServerPortFromParameters( NamedProperties& parameters );
+	void		EnableNetworkThread( NamedProperties& parameters );
+	void		OnHostResolved( NamedProperties& parameters );
+	void		ConsolePrintNetworkStats( NamedProperties& parameters );
+	void		StartCaptureReplay( NamedProperties& parameters );
+	void		SetPacketOrientationPrecision( NamedProperties& parameters );
+	void		SetMaxDatagramSize( NamedProperties& parameters );
 
 	void		OutputReceivedPacket( const FinalPacket& packetToOutput ) const;
 	std::string GetReceivedPacketTypeAsString( const PacketType& typeOfPacket ) const;
 	std::string GetReceivedNackErrorCodeAsString( const ErrorCode& codeError ) const;
 
+	enum ClientTimerType
+	{
+		TIMER_HEARTBEAT
+	};
+
 	int							m_connectionToHostID;
 	std::string					m_currentHostIPAddressAsString;
 	u_short						m_currentHostPort;
 
-	ClientState					m_currentState;
+	bool						m_useNetworkThread;
+	NetworkThread				m_networkThread;
+	PeerAddress					m_hostAddress;
 
-	uint						m_mostRecentlyProcessedUnreliablePacketNum;
-	uint						m_mostRecentlyProcessedReliablePacketNum;
+	ClientState					m_currentState;
 
 	uint						m_mostRecentUnreliablePacketSentNum;
 	uint						m_mostRecentReliablePacketSentNum;
 
-	std::set< FinalPacket >		m_queueOfReliablePacketsToParse;
-	std::vector< FinalPacket >	m_queueOfReliablePacketsSentToServer;
+	//every channel numbers its own packets, so each one is ordered or goes stale on its own
+	PacketNumber							m_nextChannelSequencesToSend[ NUM_CHANNELS ];
+	PacketNumber							m_newestUnreliableChannelSequences[ NUM_CHANNELS ];
+	bool									m_hasReceivedOnUnreliableChannel[ NUM_CHANNELS ];
+	ReliableReceiveWindow< FinalPacket >	m_reliableChannelsFromHost[ NUM_CHANNELS ];
+	std::vector< FinalPacket >				m_messagesToHostByChannel[ NUM_CHANNELS ];
+	ChannelID								m_channelsByPriority[ NUM_CHANNELS ];
+
+	//decoded out of the datagram, the wire form cannot be read in place
+	struct ReceivedPacket
+	{
+		FinalPacket	packet;
+		double		arrivalTimeSeconds;
+	};
+
+	std::vector< ReceivedPacket >	m_packetsReceivedThisFrame;
+	double							m_currentPacketArrivalTimeSeconds;
+	ConnectionStats					m_hostConnectionStats;
+	SendPacer						m_hostSendPacer;
+
+	PacketCaptureReader				m_captureReplay;
+	CapturedDatagram				m_nextReplayedDatagram;
+	bool							m_hasNextReplayedDatagram;
+	float							m_replaySpeed;
+	double							m_replayStartTimeSeconds;
+
+	FinalPacketSerializer			m_packetSerializer;
+	MessageCoalescer				m_messagesToHost;
+	SnapshotHistory					m_sentSnapshots;
+	SnapshotHistory					m_receivedSnapshots;
+
+	PacketAcks						m_guaranteedPacketsReceived;
+	PacketAcks						m_updatesReceived;
+	bool							m_hasNewAcksToSend;
+
+	ReliableSendWindow< FinalPacket >	m_reliablePacketsSentToServer;
 	
 	char				m_numPlayersInRoom[ NUM_ROOMS ];
 	char				m_selectedRoomID;
@@ -141,6 +219,9 @@ private:
 
 	bool						m_shouldFire;
 
+	TimerWheel					m_timerWheel;
+	std::vector< ScheduledTimer >	m_expiredTimers;
+
 	std::vector< Camera3D* > m_cameras;
 	Camera3D*				 m_cameraToRenderFrom;
 };
@@ -153,6 +234,12 @@ inline void Client::RegisterForEvents()
 	eventSystem.RegisterEventWithCallbackAndObject( "playerColor", &Client::SetPlayerParameters, this );
 	eventSystem.RegisterEventWithCallbackAndObject( "ip", &Client::SetServerIpFromParameters, this );
 	eventSystem.RegisterEventWithCallbackAndObject( "port", &Client::SetServerPortFromParameters, this );
+	eventSystem.RegisterEventWithCallbackAndObject( "networkThread", &Client::EnableNetworkThread, this );
+	eventSystem.RegisterEventWithCallbackAndObject( "clientHostResolved", &Client::OnHostResolved, this );
+	eventSystem.RegisterEventWithCallbackAndObject( "dumpNetStats", &Client::ConsolePrintNetworkStats, this );
+	eventSystem.RegisterEventWithCallbackAndObject( "replayCapture", &Client::StartCaptureReplay, this );
+	eventSystem.RegisterEventWithCallbackAndObject( "packetOrientationBits", &Client::SetPacketOrientationPrecision, this );
+	eventSystem.RegisterEventWithCallbackAndObject( "maxDatagramSize", &Client::SetMaxDatagramSize, this );
 }
 
 
@@ -163,6 +250,20 @@ inline ClientState Client::GetClientState() const
 }
 
 
+//-----------------------------------------------------------------------------------------------
+inline const ConnectionStats& Client::GetHostConnectionStats() const
+{
+	return m_hostConnectionStats;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline bool Client::IsReplayingCapture() const
+{
+	return m_captureReplay.IsOpen();
+}
+
+
 
 
 #endif
\ No newline at end of file
@@ -12,6 +12,19 @@
 	v1.3: (VK) - Made ErrorCode 0 indicate success, and 255 be unknown.
 				 This way, functions can use ErrorCode to indicate success or failure.
 				 Prettied up the change log...because reasons.
+	v1.4: (TS) - Packets go over the wire bit-packed by FinalPacketSerializer instead of as this struct.
+				 Timestamps on received packets are relative, in seconds within a 4.6 hour wrap.
+	v1.5: (TS) - GameUpdates can be deltas against an earlier update the receiver acked.
+				 Receivers Ack( GameUpdate ) with the update's unreliable number, not matched against guaranteed packets.
+	v1.6: (TS) - Acks ride in the header: the newest guaranteed packet and update received, each with a 32 bit history.
+				 Ack packets are only needed for packets too old for the history. A KeepAlive carries acks when nothing else is sent.
+	v1.7: (TS) - Packet types belong to channels, each with its own delivery, priority and sequence numbers starting at 0.
+				 The header carries the channel sequence after the packet number. Packet numbers are still what acks refer to.
+				 IsGuaranteed() follows from the channel.
+	v1.8: (TS) - Every packet header starts with FINAL_PROTOCOL_VERSION. Packets from any other version are dropped,
+				 so the host has to be updated along with the client.
+	v1.9: (TS) - Control is the top priority channel, so acks and keep alives go out however little the pacer allows.
+				 Acks and nacks are handled even when they arrive behind a newer Control packet.
 */
 #pragma endregion //Change Log
 
@@ -74,6 +87,7 @@
 //GAME LOOP
 //	Client->Server: Update, Hit, Fire
 //	Server->Client: Update, Respawn
+//	Both ways: updates received are acked in the header of the next packets sent, which marks them as delta baselines
 
 //	When end score is reached OR host exits the game:
 //		Server->ALL Clients: ReturnToLobby
@@ -83,6 +97,9 @@
 
 #pragma region Packet Type Definitions
 //-----------------------------------------------------------------------------------------------
+//Bumped whenever the wire format changes, the first byte of every packet
+static const unsigned char FINAL_PROTOCOL_VERSION = 8;
+
 typedef unsigned char ClientID;
 static const ClientID ID_None = 0;
 
@@ -115,11 +132,58 @@ static const ErrorCode ERROR_RoomEmpty = 1;
 static const ErrorCode ERROR_RoomFull = 2;
 static const ErrorCode ERROR_BadRoomID = 3;
 static const ErrorCode ERROR_Unknown = 255;
+
+//-----------------------------------------------------------------------------------------------
+typedef unsigned char ChannelDelivery;
+static const ChannelDelivery DELIVERY_UnreliableSequenced = 0;	//may be lost, older than the newest is dropped
+static const ChannelDelivery DELIVERY_ReliableUnordered = 1;	//resent until acked, handled as soon as it arrives
+static const ChannelDelivery DELIVERY_ReliableOrdered = 2;		//resent until acked, handled in the order sent
+
+typedef unsigned char ChannelID;
+static const ChannelID CHANNEL_Combat = 0;		//Hit, Fire
+static const ChannelID CHANNEL_GameFlow = 1;	//GameReset, Respawn, ReturnToLobby
+static const ChannelID CHANNEL_GameUpdates = 2;	//GameUpdate
+static const ChannelID CHANNEL_Control = 3;		//Ack, Nack, KeepAlive, LobbyUpdate
+static const ChannelID CHANNEL_Lobby = 4;		//CreateRoom, JoinRoom
+static const int NUM_CHANNELS = 5;
+
+//-----------------------------------------------------------------------------------------------
+//Lower priorities are sent first when a sender cannot send everything at once
+struct ChannelDefinition
+{
+	const char* name;
+	ChannelDelivery delivery;
+	unsigned char priority;
+};
+
+static const ChannelDefinition CHANNEL_DEFINITIONS[ NUM_CHANNELS ] =
+{
+	{ "Combat",			DELIVERY_ReliableUnordered,		1 },
+	{ "GameFlow",		DELIVERY_ReliableOrdered,		2 },
+	{ "GameUpdates",	DELIVERY_UnreliableSequenced,	3 },
+	{ "Control",		DELIVERY_UnreliableSequenced,	0 },
+	{ "Lobby",			DELIVERY_ReliableOrdered,		4 }
+};
 #pragma endregion //Packet Type Definitions
 
 
 
 #pragma region Packet Structure Definitions
+//-----------------------------------------------------------------------------------------------
+//The newest number received in one sequence, and bit i set if number - 1 - i was received too.
+//Sent in every header until newer packets push it out, so one lost header costs nothing.
+static const int NUM_ACK_HISTORY_BITS = 32;
+
+struct PacketAcks
+{
+	bool hasAcks;
+	PacketNumber newestNumber;
+	unsigned int previousBits;
+
+	bool RecordReceived( PacketNumber number );
+	bool Contains( PacketNumber number ) const;
+};
+
 //-----------------------------------------------------------------------------------------------
 struct AckPacket
 {
@@ -225,7 +289,10 @@ struct FinalPacket
 	PacketType type;
 	ClientID clientID;
 	PacketNumber number;
+	PacketNumber channelSequence;
 	double timestamp;
+	PacketAcks guaranteedAcks;
+	PacketAcks updateAcks;
 
 	union PacketData
 	{
@@ -247,10 +314,80 @@ struct FinalPacket
 	//Functions
 	bool operator<( const FinalPacket& other ) const;
 
+	ChannelID GetChannel() const;
 	bool IsGuaranteed() const;
 };
 
 
+//-----------------------------------------------------------------------------------------------
+//False when the number is too far behind the newest to fit in the history, it needs an Ack packet
+inline bool PacketAcks::RecordReceived( PacketNumber number )
+{
+	if( !hasAcks )
+	{
+		hasAcks = true;
+		newestNumber = number;
+		previousBits = 0;
+		return true;
+	}
+
+	PacketNumber numbersAhead = number - newestNumber;
+
+	if( numbersAhead == 0 )
+	{
+		return true;
+	}
+
+	if( numbersAhead < 0x80000000 )
+	{
+		//the old newest becomes one of the history bits
+		if( numbersAhead > NUM_ACK_HISTORY_BITS )
+		{
+			previousBits = 0;
+		}
+		else
+		{
+			previousBits = static_cast< unsigned int >( ( ( static_cast< unsigned long long >( previousBits ) << 1 ) | 1 ) << ( numbersAhead - 1 ) );
+		}
+
+		newestNumber = number;
+		return true;
+	}
+
+	PacketNumber numbersBehind = newestNumber - number;
+
+	if( numbersBehind > NUM_ACK_HISTORY_BITS )
+	{
+		return false;
+	}
+
+	previousBits |= 1u << ( numbersBehind - 1 );
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline bool PacketAcks::Contains( PacketNumber number ) const
+{
+	if( !hasAcks )
+	{
+		return false;
+	}
+
+	PacketNumber numbersBehind = newestNumber - number;
+
+	if( numbersBehind == 0 )
+	{
+		return true;
+	}
+
+	if( numbersBehind > NUM_ACK_HISTORY_BITS )
+	{
+		return false;
+	}
+
+	return ( previousBits & ( 1u << ( numbersBehind - 1 ) ) ) != 0;
+}
+
 //-----------------------------------------------------------------------------------------------
 inline bool FinalPacket::operator<( const FinalPacket& other ) const
 {
@@ -258,29 +395,41 @@ inline bool FinalPacket::operator<( const FinalPacket& other ) const
 }
 
 //-----------------------------------------------------------------------------------------------
-inline bool FinalPacket::IsGuaranteed() const
+inline ChannelID FinalPacket::GetChannel() const
 {
 	switch( type )
 	{
-	case TYPE_CreateRoom:
-	case TYPE_JoinRoom:
-	case TYPE_GameReset:
-	case TYPE_Respawn:
 	case TYPE_Hit:
 	case TYPE_Fire:
+		return CHANNEL_Combat;
+
+	case TYPE_GameReset:
+	case TYPE_Respawn:
 	case TYPE_ReturnToLobby:
-		return true;
+		return CHANNEL_GameFlow;
+
+	case TYPE_GameUpdate:
+		return CHANNEL_GameUpdates;
+
+	case TYPE_CreateRoom:
+	case TYPE_JoinRoom:
+		return CHANNEL_Lobby;
 
 	case TYPE_Ack:
 	case TYPE_Nack:
 	case TYPE_KeepAlive:
 	case TYPE_LobbyUpdate:
-	case TYPE_GameUpdate:
 	case TYPE_None:
 	default:
 		break;
 	}
-	return false;
+	return CHANNEL_Control;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline bool FinalPacket::IsGuaranteed() const
+{
+	return CHANNEL_DEFINITIONS[ GetChannel() ].delivery != DELIVERY_UnreliableSequenced;
 }
 
 
@@ -0,0 +1,536 @@
+#include "FinalPacketSerializer.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#include "Engine/Networking/BitStream.hpp"
+
+#include "SnapshotHistory.hpp"
+
+//-----------------------------------------------------------------------------------------------
+const int PROTOCOL_VERSION_BITS = 8;
+const int PACKET_TYPE_BITS = 4;
+const int CLIENT_ID_BITS = 8;
+const int ROOM_ID_BITS = 8;
+const int ERROR_CODE_BITS = 8;
+const int SMALL_VALUE_BITS = 8;
+
+const int TIMESTAMP_BITS = 24;
+const double TIMESTAMP_UNITS_PER_SECOND = 1000.0;
+
+//From the game rules, 500x500 at 16 bits is under a hundredth of a unit
+const float ARENA_MIN_POSITION = 0.f;
+const float ARENA_MAX_POSITION = 500.f;
+const int POSITION_BITS = 16;
+
+//Tanks move at 30 units/second, with room to spare for whatever a client smooths in
+const float MAX_ABSOLUTE_VELOCITY = 64.f;
+const int VELOCITY_BITS = 16;
+
+const int MIN_ORIENTATION_PRECISION_BITS = 8;
+const int MAX_ORIENTATION_PRECISION_BITS = 16;
+const int DEFAULT_ORIENTATION_PRECISION_BITS = 12;
+
+//-----------------------------------------------------------------------------------------------
+//The parts of a game update a delta can leave out, in wire order. A full update is all of them.
+enum GameUpdateField
+{
+	FIELD_XPosition,
+	FIELD_YPosition,
+	FIELD_XVelocity,
+	FIELD_YVelocity,
+	FIELD_Acceleration,
+	FIELD_Orientation,
+	FIELD_Health,
+	FIELD_Score,
+	NUM_GAME_UPDATE_FIELDS
+};
+
+//-----------------------------------------------------------------------------------------------
+//Wraps instead of clamping, 360 degrees and 0 are the same facing
+static void WriteOrientation( BitWriter& writer, float orientationDegrees, int numBits )
+{
+	float wrappedDegrees = fmod( orientationDegrees, 360.f );
+
+	if( wrappedDegrees < 0.f )
+	{
+		wrappedDegrees += 360.f;
+	}
+
+	float numSteps = static_cast< float >( 1 << numBits );
+
+	writer.WriteBits( static_cast< uint >( ( wrappedDegrees / 360.f ) * numSteps + 0.5f ), numBits );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static float ReadOrientation( BitReader& reader, int numBits )
+{
+	float numSteps = static_cast< float >( 1 << numBits );
+
+	return ( static_cast< float >( reader.ReadBits( numBits ) ) / numSteps ) * 360.f;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Two bits when there is nothing to ack
+static void WritePacketAcks( BitWriter& writer, const PacketAcks& acks )
+{
+	writer.WriteBool( acks.hasAcks );
+
+	if( acks.hasAcks )
+	{
+		writer.WriteVariableUint( acks.newestNumber );
+		writer.WriteBits( acks.previousBits, NUM_ACK_HISTORY_BITS );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void ReadPacketAcks( BitReader& reader, PacketAcks& out_acks )
+{
+	out_acks.hasAcks = reader.ReadBool();
+
+	if( out_acks.hasAcks )
+	{
+		out_acks.newestNumber = reader.ReadVariableUint();
+		out_acks.previousBits = reader.ReadBits( NUM_ACK_HISTORY_BITS );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void WriteGameUpdateField( BitWriter& writer, const GameUpdatePacket& update, int field, int orientationBits )
+{
+	switch( field )
+	{
+	case FIELD_XPosition:
+		writer.WriteQuantizedFloat( update.xPosition, ARENA_MIN_POSITION, ARENA_MAX_POSITION, POSITION_BITS );
+		break;
+
+	case FIELD_YPosition:
+		writer.WriteQuantizedFloat( update.yPosition, ARENA_MIN_POSITION, ARENA_MAX_POSITION, POSITION_BITS );
+		break;
+
+	case FIELD_XVelocity:
+		writer.WriteQuantizedFloat( update.xVelocity, -MAX_ABSOLUTE_VELOCITY, MAX_ABSOLUTE_VELOCITY, VELOCITY_BITS );
+		break;
+
+	case FIELD_YVelocity:
+		writer.WriteQuantizedFloat( update.yVelocity, -MAX_ABSOLUTE_VELOCITY, MAX_ABSOLUTE_VELOCITY, VELOCITY_BITS );
+		break;
+
+	case FIELD_Acceleration:
+		//tanks change velocity instantly, so acceleration is nearly always zero and costs a bit when it is
+		writer.WriteBool( update.xAcceleration != 0.f || update.yAcceleration != 0.f );
+
+		if( update.xAcceleration != 0.f || update.yAcceleration != 0.f )
+		{
+			writer.WriteQuantizedFloat( update.xAcceleration, -MAX_ABSOLUTE_VELOCITY, MAX_ABSOLUTE_VELOCITY, VELOCITY_BITS );
+			writer.WriteQuantizedFloat( update.yAcceleration, -MAX_ABSOLUTE_VELOCITY, MAX_ABSOLUTE_VELOCITY, VELOCITY_BITS );
+		}
+		break;
+
+	case FIELD_Orientation:
+		WriteOrientation( writer, update.orientationDegrees, orientationBits );
+		break;
+
+	case FIELD_Health:
+		writer.WriteBits( update.health, SMALL_VALUE_BITS );
+		break;
+
+	case FIELD_Score:
+		writer.WriteBits( update.score, SMALL_VALUE_BITS );
+		break;
+
+	default:
+		break;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void ReadGameUpdateField( BitReader& reader, GameUpdatePacket& out_update, int field, int orientationBits )
+{
+	switch( field )
+	{
+	case FIELD_XPosition:
+		out_update.xPosition = reader.ReadQuantizedFloat( ARENA_MIN_POSITION, ARENA_MAX_POSITION, POSITION_BITS );
+		break;
+
+	case FIELD_YPosition:
+		out_update.yPosition = reader.ReadQuantizedFloat( ARENA_MIN_POSITION, ARENA_MAX_POSITION, POSITION_BITS );
+		break;
+
+	case FIELD_XVelocity:
+		out_update.xVelocity = reader.ReadQuantizedFloat( -MAX_ABSOLUTE_VELOCITY, MAX_ABSOLUTE_VELOCITY, VELOCITY_BITS );
+		break;
+
+	case FIELD_YVelocity:
+		out_update.yVelocity = reader.ReadQuantizedFloat( -MAX_ABSOLUTE_VELOCITY, MAX_ABSOLUTE_VELOCITY, VELOCITY_BITS );
+		break;
+
+	case FIELD_Acceleration:
+		out_update.xAcceleration = 0.f;
+		out_update.yAcceleration = 0.f;
+
+		if( reader.ReadBool() )
+		{
+			out_update.xAcceleration = reader.ReadQuantizedFloat( -MAX_ABSOLUTE_VELOCITY, MAX_ABSOLUTE_VELOCITY, VELOCITY_BITS );
+			out_update.yAcceleration = reader.ReadQuantizedFloat( -MAX_ABSOLUTE_VELOCITY, MAX_ABSOLUTE_VELOCITY, VELOCITY_BITS );
+		}
+		break;
+
+	case FIELD_Orientation:
+		out_update.orientationDegrees = ReadOrientation( reader, orientationBits );
+		break;
+
+	case FIELD_Health:
+		out_update.health = static_cast< uchar >( reader.ReadBits( SMALL_VALUE_BITS ) );
+		break;
+
+	case FIELD_Score:
+		out_update.score = static_cast< uchar >( reader.ReadBits( SMALL_VALUE_BITS ) );
+		break;
+
+	default:
+		break;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//A field has changed when its wire form has, so a change too small to survive quantizing costs nothing
+static bool HasGameUpdateFieldChanged( const GameUpdatePacket& update, const GameUpdatePacket& baseline, int field, int orientationBits )
+{
+	uint64 updateBits = 0;
+	uint64 baselineBits = 0;
+
+	BitWriter updateWriter( ( char* )&updateBits, sizeof( updateBits ) );
+	BitWriter baselineWriter( ( char* )&baselineBits, sizeof( baselineBits ) );
+
+	WriteGameUpdateField( updateWriter, update, field, orientationBits );
+	WriteGameUpdateField( baselineWriter, baseline, field, orientationBits );
+
+	updateWriter.Flush();
+	baselineWriter.Flush();
+
+	return updateBits != baselineBits;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+FinalPacketSerializer::FinalPacketSerializer()
+	: m_orientationPrecisionBits( DEFAULT_ORIENTATION_PRECISION_BITS )
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Returns the number of bytes written, or 0 if the buffer was too small. A game update with a
+//baseline, one the receiver acked, goes out as a mask of the fields that differ from it followed
+//by just those fields.
+int FinalPacketSerializer::WritePacket( const FinalPacket& packet, char* buffer, int bufferSizeBytes, const FinalPacket* baseline ) const
+{
+	BitWriter writer( buffer, bufferSizeBytes );
+
+	//header, the client ID is only there when it is set
+	writer.WriteBits( FINAL_PROTOCOL_VERSION, PROTOCOL_VERSION_BITS );
+	writer.WriteBits( packet.type, PACKET_TYPE_BITS );
+	writer.WriteBool( packet.clientID != ID_None );
+
+	if( packet.clientID != ID_None )
+	{
+		writer.WriteBits( packet.clientID, CLIENT_ID_BITS );
+	}
+
+	writer.WriteVariableUint( packet.number );
+	writer.WriteVariableUint( packet.channelSequence );
+	writer.WriteBits( static_cast< uint >( static_cast< uint64 >( packet.timestamp * TIMESTAMP_UNITS_PER_SECOND ) ), TIMESTAMP_BITS );
+	WritePacketAcks( writer, packet.guaranteedAcks );
+	WritePacketAcks( writer, packet.updateAcks );
+
+	const FinalPacket::PacketData& data = packet.data;
+
+	switch( packet.type )
+	{
+	case TYPE_Ack:
+		writer.WriteBits( data.acknowledged.type, PACKET_TYPE_BITS );
+		writer.WriteVariableUint( data.acknowledged.number );
+		break;
+
+	case TYPE_Nack:
+		writer.WriteBits( data.refused.type, PACKET_TYPE_BITS );
+		writer.WriteVariableUint( data.refused.number );
+		writer.WriteBits( data.refused.errorCode, ERROR_CODE_BITS );
+		break;
+
+	case TYPE_CreateRoom:
+		writer.WriteBits( data.creating.room, ROOM_ID_BITS );
+		break;
+
+	case TYPE_JoinRoom:
+		writer.WriteBits( data.joining.room, ROOM_ID_BITS );
+		break;
+
+	case TYPE_LobbyUpdate:
+		for( int i = 0; i < static_cast< int >( sizeof( data.updatedLobby.playersInRoomNumber ) ); ++i )
+		{
+			writer.WriteBits( static_cast< uchar >( data.updatedLobby.playersInRoomNumber[ i ] ), SMALL_VALUE_BITS );
+		}
+		break;
+
+	case TYPE_GameUpdate:
+		WriteGameUpdate( writer, packet, baseline );
+		break;
+
+	case TYPE_GameReset:
+		writer.WriteQuantizedFloat( data.reset.xPosition, ARENA_MIN_POSITION, ARENA_MAX_POSITION, POSITION_BITS );
+		writer.WriteQuantizedFloat( data.reset.yPosition, ARENA_MIN_POSITION, ARENA_MAX_POSITION, POSITION_BITS );
+		WriteOrientation( writer, data.reset.orientationDegrees, m_orientationPrecisionBits );
+		writer.WriteBits( data.reset.id, CLIENT_ID_BITS );
+		break;
+
+	case TYPE_Respawn:
+		writer.WriteQuantizedFloat( data.respawn.xPosition, ARENA_MIN_POSITION, ARENA_MAX_POSITION, POSITION_BITS );
+		writer.WriteQuantizedFloat( data.respawn.yPosition, ARENA_MIN_POSITION, ARENA_MAX_POSITION, POSITION_BITS );
+		WriteOrientation( writer, data.respawn.orientationDegrees, m_orientationPrecisionBits );
+		break;
+
+	case TYPE_Hit:
+		writer.WriteBits( data.hit.instigatorID, CLIENT_ID_BITS );
+		writer.WriteBits( data.hit.targetID, CLIENT_ID_BITS );
+		writer.WriteBits( data.hit.damageDealt, SMALL_VALUE_BITS );
+		break;
+
+	case TYPE_Fire:
+		writer.WriteBits( data.gunfire.instigatorID, CLIENT_ID_BITS );
+		break;
+
+	case TYPE_KeepAlive:
+	case TYPE_ReturnToLobby:
+	case TYPE_None:
+	default:
+		break;
+	}
+
+	int numBytesWritten = writer.Flush();
+
+	if( writer.HasOverflowed() )
+	{
+		return 0;
+	}
+
+	return numBytesWritten;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Returns the number of bytes the packet took, or 0 when there are too few bytes for a whole packet
+//or it is from another protocol version.
+//Anything the wire form does not carry comes back zeroed. A delta game update whose baseline is
+//not in the received history still takes its bytes, but comes back as TYPE_None with only its header.
+int FinalPacketSerializer::ReadPacket( const char* buffer, int numBytes, FinalPacket& out_packet, const SnapshotHistory* receivedSnapshots ) const
+{
+	BitReader reader( buffer, numBytes );
+
+	memset( &out_packet, 0, sizeof( out_packet ) );
+
+	//nothing after the version can be trusted to mean the same thing
+	if( reader.ReadBits( PROTOCOL_VERSION_BITS ) != FINAL_PROTOCOL_VERSION )
+	{
+		return 0;
+	}
+
+	out_packet.type = static_cast< PacketType >( reader.ReadBits( PACKET_TYPE_BITS ) );
+
+	if( reader.ReadBool() )
+	{
+		out_packet.clientID = static_cast< ClientID >( reader.ReadBits( CLIENT_ID_BITS ) );
+	}
+
+	out_packet.number = reader.ReadVariableUint();
+	out_packet.channelSequence = reader.ReadVariableUint();
+	out_packet.timestamp = static_cast< double >( reader.ReadBits( TIMESTAMP_BITS ) ) / TIMESTAMP_UNITS_PER_SECOND;
+	ReadPacketAcks( reader, out_packet.guaranteedAcks );
+	ReadPacketAcks( reader, out_packet.updateAcks );
+
+	FinalPacket::PacketData& data = out_packet.data;
+
+	switch( out_packet.type )
+	{
+	case TYPE_Ack:
+		data.acknowledged.type = static_cast< PacketType >( reader.ReadBits( PACKET_TYPE_BITS ) );
+		data.acknowledged.number = reader.ReadVariableUint();
+		break;
+
+	case TYPE_Nack:
+		data.refused.type = static_cast< PacketType >( reader.ReadBits( PACKET_TYPE_BITS ) );
+		data.refused.number = reader.ReadVariableUint();
+		data.refused.errorCode = static_cast< ErrorCode >( reader.ReadBits( ERROR_CODE_BITS ) );
+		break;
+
+	case TYPE_CreateRoom:
+		data.creating.room = static_cast< RoomID >( reader.ReadBits( ROOM_ID_BITS ) );
+		break;
+
+	case TYPE_JoinRoom:
+		data.joining.room = static_cast< RoomID >( reader.ReadBits( ROOM_ID_BITS ) );
+		break;
+
+	case TYPE_LobbyUpdate:
+		for( int i = 0; i < static_cast< int >( sizeof( data.updatedLobby.playersInRoomNumber ) ); ++i )
+		{
+			data.updatedLobby.playersInRoomNumber[ i ] = static_cast< char >( reader.ReadBits( SMALL_VALUE_BITS ) );
+		}
+		break;
+
+	case TYPE_GameUpdate:
+		ReadGameUpdate( reader, out_packet, receivedSnapshots );
+		break;
+
+	case TYPE_GameReset:
+		data.reset.xPosition = reader.ReadQuantizedFloat( ARENA_MIN_POSITION, ARENA_MAX_POSITION, POSITION_BITS );
+		data.reset.yPosition = reader.ReadQuantizedFloat( ARENA_MIN_POSITION, ARENA_MAX_POSITION, POSITION_BITS );
+		data.reset.orientationDegrees = ReadOrientation( reader, m_orientationPrecisionBits );
+		data.reset.id = static_cast< ClientID >( reader.ReadBits( CLIENT_ID_BITS ) );
+		break;
+
+	case TYPE_Respawn:
+		data.respawn.xPosition = reader.ReadQuantizedFloat( ARENA_MIN_POSITION, ARENA_MAX_POSITION, POSITION_BITS );
+		data.respawn.yPosition = reader.ReadQuantizedFloat( ARENA_MIN_POSITION, ARENA_MAX_POSITION, POSITION_BITS );
+		data.respawn.orientationDegrees = ReadOrientation( reader, m_orientationPrecisionBits );
+		break;
+
+	case TYPE_Hit:
+		data.hit.instigatorID = static_cast< ClientID >( reader.ReadBits( CLIENT_ID_BITS ) );
+		data.hit.targetID = static_cast< ClientID >( reader.ReadBits( CLIENT_ID_BITS ) );
+		data.hit.damageDealt = static_cast< uchar >( reader.ReadBits( SMALL_VALUE_BITS ) );
+		break;
+
+	case TYPE_Fire:
+		data.gunfire.instigatorID = static_cast< ClientID >( reader.ReadBits( CLIENT_ID_BITS ) );
+		break;
+
+	case TYPE_KeepAlive:
+	case TYPE_ReturnToLobby:
+	case TYPE_None:
+	default:
+		break;
+	}
+
+	if( reader.HasOverrun() )
+	{
+		return 0;
+	}
+
+	return reader.GetNumBytesRead();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//12 bits, the default, is under a tenth of a degree
+void FinalPacketSerializer::SetOrientationPrecisionBits( int numBits )
+{
+	if( numBits < MIN_ORIENTATION_PRECISION_BITS )
+	{
+		numBits = MIN_ORIENTATION_PRECISION_BITS;
+	}
+	else if( numBits > MAX_ORIENTATION_PRECISION_BITS )
+	{
+		numBits = MAX_ORIENTATION_PRECISION_BITS;
+	}
+
+	m_orientationPrecisionBits = numBits;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Private Methods
+//-----------------------------------------------------------------------------------------------
+//The baseline goes by how many packet numbers back it is, which is nearly always under a byte
+void FinalPacketSerializer::WriteGameUpdate( BitWriter& writer, const FinalPacket& packet, const FinalPacket* baseline ) const
+{
+	writer.WriteBool( baseline != nullptr );
+
+	if( baseline == nullptr )
+	{
+		for( int field = 0; field < NUM_GAME_UPDATE_FIELDS; ++field )
+		{
+			WriteGameUpdateField( writer, packet.data.updatedGame, field, m_orientationPrecisionBits );
+		}
+
+		return;
+	}
+
+	uint changedFieldMask = 0;
+
+	for( int field = 0; field < NUM_GAME_UPDATE_FIELDS; ++field )
+	{
+		if( HasGameUpdateFieldChanged( packet.data.updatedGame, baseline->data.updatedGame, field, m_orientationPrecisionBits ) )
+		{
+			changedFieldMask |= 1 << field;
+		}
+	}
+
+	writer.WriteVariableUint( packet.number - baseline->number );
+	writer.WriteBits( changedFieldMask, NUM_GAME_UPDATE_FIELDS );
+
+	for( int field = 0; field < NUM_GAME_UPDATE_FIELDS; ++field )
+	{
+		if( ( changedFieldMask & ( 1 << field ) ) != 0 )
+		{
+			WriteGameUpdateField( writer, packet.data.updatedGame, field, m_orientationPrecisionBits );
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Unchanged fields come from the baseline as this end decoded it, the same quantized values the
+//sender compared against
+void FinalPacketSerializer::ReadGameUpdate( BitReader& reader, FinalPacket& out_packet, const SnapshotHistory* receivedSnapshots ) const
+{
+	if( !reader.ReadBool() )
+	{
+		for( int field = 0; field < NUM_GAME_UPDATE_FIELDS; ++field )
+		{
+			ReadGameUpdateField( reader, out_packet.data.updatedGame, field, m_orientationPrecisionBits );
+		}
+
+		return;
+	}
+
+	PacketNumber baselineNumber = out_packet.number - reader.ReadVariableUint();
+	uint changedFieldMask = reader.ReadBits( NUM_GAME_UPDATE_FIELDS );
+
+	const FinalPacket* baseline = nullptr;
+
+	if( receivedSnapshots != nullptr )
+	{
+		baseline = receivedSnapshots->FindSnapshot( baselineNumber );
+	}
+
+	bool hasBaseline = baseline != nullptr && baseline->type == TYPE_GameUpdate && baseline->clientID == out_packet.clientID;
+
+	if( hasBaseline )
+	{
+		out_packet.data.updatedGame = baseline->data.updatedGame;
+	}
+
+	for( int field = 0; field < NUM_GAME_UPDATE_FIELDS; ++field )
+	{
+		if( ( changedFieldMask & ( 1 << field ) ) != 0 )
+		{
+			ReadGameUpdateField( reader, out_packet.data.updatedGame, field, m_orientationPrecisionBits );
+		}
+	}
+
+	//the header, acks included, is still good
+	if( !hasBaseline )
+	{
+		memset( &out_packet.data, 0, sizeof( out_packet.data ) );
+		out_packet.type = TYPE_None;
+	}
+}
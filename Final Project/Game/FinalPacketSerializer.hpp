@@ -0,0 +1,52 @@
+#ifndef FINAL_PACKET_SERIALIZER_HPP
+#define FINAL_PACKET_SERIALIZER_HPP
+
+#pragma once
+
+#include "FinalPacket.hpp"
+
+class BitWriter;
+class BitReader;
+class SnapshotHistory;
+
+//Nothing serializes bigger than the raw struct
+const int MAX_SERIALIZED_FINAL_PACKET_BYTES = sizeof( FinalPacket );
+
+//-----------------------------------------------------------------------------------------------
+//Turns a FinalPacket into its bit-packed wire form and back. Only the active union member is
+//written, the packet number takes as many bytes as it needs, positions are quantized to the arena,
+//angles to the orientation precision and the timestamp to milliseconds that wrap every 4.6 hours.
+//Both ends have to agree on the orientation precision, and packets from another protocol version are
+//refused. A packet takes whole bytes and its header says how long it is, so several can be read back
+//to back out of one datagram. Game updates can be sent as deltas against an earlier one the receiver
+//still has in its SnapshotHistory.
+class FinalPacketSerializer
+{
+public:
+
+	FinalPacketSerializer();
+
+	int  WritePacket( const FinalPacket& packet, char* buffer, int bufferSizeBytes, const FinalPacket* baseline = nullptr ) const;
+	int  ReadPacket( const char* buffer, int numBytes, FinalPacket& out_packet, const SnapshotHistory* receivedSnapshots = nullptr ) const;
+
+	void SetOrientationPrecisionBits( int numBits );
+
+	inline int GetOrientationPrecisionBits() const;
+
+private:
+
+	void WriteGameUpdate( BitWriter& writer, const FinalPacket& packet, const FinalPacket* baseline ) const;
+	void ReadGameUpdate( BitReader& reader, FinalPacket& out_packet, const SnapshotHistory* receivedSnapshots ) const;
+
+	int		m_orientationPrecisionBits;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline int FinalPacketSerializer::GetOrientationPrecisionBits() const
+{
+	return m_orientationPrecisionBits;
+}
+
+
+#endif
@@ -16,6 +16,7 @@
 #include "Engine/Networking/Network.hpp"
 #include "Engine/Utilities/Time.hpp"
 #include "Engine/Utilities/Clock.hpp"
+#include "Engine/Utilities/JobManager.hpp"
 #include "Engine/Utilities/XMLUtilities.hpp"
 #include "Engine/Utilities/ProfileSection.hpp"
 #include "Engine/Utilities/ErrorWarningAssert.hpp"
@@ -69,6 +70,66 @@ void Command_Clear(const ConsoleCommandArgs& args)
 	}
 }
 
+//-----------------------------------------------------------------------------------------------
+//Whoever owns a connection listens for this and prints its ConnectionStats
+void Command_NetStats( const ConsoleCommandArgs& args )
+{
+	UNUSED( args );
+
+	NamedProperties noProperties;
+
+	EventSystem::GetInstance().FireEvent( "dumpNetStats", noProperties );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Hands a console command to the command line event of the same parameters, as param1, param2...
+void FireEventWithConsoleArgs( const std::string& eventName, const ConsoleCommandArgs& args )
+{
+	NamedProperties eventProperties;
+
+	for( int i = 1; i < static_cast< int >( args.m_argsList.size() ); ++i )
+	{
+		char buffer[ 32 ];
+
+		std::string paramName = "param";
+		paramName += std::string( _itoa( i, buffer, 10 ) );
+
+		eventProperties.Set( paramName, args.m_argsList[ i ] );
+	}
+
+	EventSystem::GetInstance().FireEvent( eventName, eventProperties );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Command_NetSim( const ConsoleCommandArgs& args )
+{
+	FireEventWithConsoleArgs( "simulateNetwork", args );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Command_NetCapture( const ConsoleCommandArgs& args )
+{
+	FireEventWithConsoleArgs( "capturePackets", args );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Command_NetReplay( const ConsoleCommandArgs& args )
+{
+	FireEventWithConsoleArgs( "replayCapture", args );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Command_NetOrientationBits( const ConsoleCommandArgs& args )
+{
+	FireEventWithConsoleArgs( "packetOrientationBits", args );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Command_NetMtu( const ConsoleCommandArgs& args )
+{
+	FireEventWithConsoleArgs( "maxDatagramSize", args );
+}
+
 //-----------------------------------------------------------------------------------------------
 //void Command_ChangeHost( const ConsoleCommandArgs& args )
 //{
@@ -129,6 +190,12 @@ void Game::Initialize(HINSTANCE applicationInstanceHandle)
 
 	commandRegistry.RegisterEvent( "quit", Command_Quit );
 	commandRegistry.RegisterEvent( "clear",Command_Clear );
+	commandRegistry.RegisterEvent( "netStats", Command_NetStats );
+	commandRegistry.RegisterEvent( "netSim", Command_NetSim );
+	commandRegistry.RegisterEvent( "netCapture", Command_NetCapture );
+	commandRegistry.RegisterEvent( "netReplay", Command_NetReplay );
+	commandRegistry.RegisterEvent( "netOrientationBits", Command_NetOrientationBits );
+	commandRegistry.RegisterEvent( "netMtu", Command_NetMtu );
 	//commandRegistry.RegisterEvent( "changeHost", Command_ChangeHost );
 
 	Clock& masterClock = Clock::GetMasterClock();
@@ -208,6 +275,9 @@ void Game::Update()
 	Clock& masterClock = Clock::GetMasterClock();
 	masterClock.AdvanceTime( timeNow - timeAtLastUpdate );
 
+	//fires finished job callbacks, such as host name lookups, on this thread
+	JobManager::GetInstance().Update();
+
 	if( m_isClient )
 	{
 		m_client.Update();
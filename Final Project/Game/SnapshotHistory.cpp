@@ -0,0 +1,92 @@
+#include "SnapshotHistory.hpp"
+
+#include <cstring>
+
+//-----------------------------------------------------------------------------------------------
+SnapshotHistory::SnapshotHistory()
+{
+	Clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Takes the slot of whatever was sent SNAPSHOT_HISTORY_SIZE numbers ago
+void SnapshotHistory::RecordSnapshot( const FinalPacket& updatePacket )
+{
+	Snapshot& slot = m_snapshots[ updatePacket.number % SNAPSHOT_HISTORY_SIZE ];
+
+	slot.packet = updatePacket;
+	slot.isValid = true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Acks can arrive out of order, an older one never replaces a newer baseline
+void SnapshotHistory::OnSnapshotAcked( PacketNumber number )
+{
+	const FinalPacket* ackedSnapshot = FindSnapshot( number );
+
+	if( ackedSnapshot == nullptr )
+	{
+		return;
+	}
+
+	ClientID playerID = ackedSnapshot->clientID;
+
+	if( !m_hasAckedBaseline[ playerID ] || number - m_ackedBaselineNumbers[ playerID ] < 0x80000000 )
+	{
+		m_ackedBaselineNumbers[ playerID ] = number;
+		m_hasAckedBaseline[ playerID ] = true;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SnapshotHistory::Clear()
+{
+	memset( m_snapshots, 0, sizeof( m_snapshots ) );
+	memset( m_ackedBaselineNumbers, 0, sizeof( m_ackedBaselineNumbers ) );
+	memset( m_hasAckedBaseline, 0, sizeof( m_hasAckedBaseline ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+const FinalPacket* SnapshotHistory::FindSnapshot( PacketNumber number ) const
+{
+	const Snapshot& slot = m_snapshots[ number % SNAPSHOT_HISTORY_SIZE ];
+
+	if( !slot.isValid || slot.packet.number != number )
+	{
+		return nullptr;
+	}
+
+	return &slot.packet;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Null means send the full update. That is the case until the other end acks one, and again once
+//the acked one is too old for the other end to still have, which also recovers from a lost history.
+const FinalPacket* SnapshotHistory::GetBaselineForSnapshot( ClientID playerID, PacketNumber numberToSend ) const
+{
+	if( !m_hasAckedBaseline[ playerID ] )
+	{
+		return nullptr;
+	}
+
+	PacketNumber baselineNumber = m_ackedBaselineNumbers[ playerID ];
+
+	if( numberToSend - baselineNumber >= static_cast< PacketNumber >( SNAPSHOT_HISTORY_SIZE ) )
+	{
+		return nullptr;
+	}
+
+	const FinalPacket* baseline = FindSnapshot( baselineNumber );
+
+	if( baseline == nullptr || baseline->clientID != playerID )
+	{
+		return nullptr;
+	}
+
+	return baseline;
+}
@@ -0,0 +1,43 @@
+#ifndef SNAPSHOT_HISTORY_HPP
+#define SNAPSHOT_HISTORY_HPP
+
+#pragma once
+
+#include "FinalPacket.hpp"
+
+//A baseline older than this many packet numbers is gone from the other end's history too
+const int SNAPSHOT_HISTORY_SIZE = 256;
+const int NUM_CLIENT_IDS = 256;
+
+//-----------------------------------------------------------------------------------------------
+//The last few hundred game updates sent or received on one connection, by packet number, so an
+//update can go out as a delta against one the other end is known to have. On the sending side it
+//also tracks the newest update of each player that the other end acked, the only safe baselines.
+class SnapshotHistory
+{
+public:
+
+	SnapshotHistory();
+
+	void RecordSnapshot( const FinalPacket& updatePacket );
+	void OnSnapshotAcked( PacketNumber number );
+	void Clear();
+
+	const FinalPacket* FindSnapshot( PacketNumber number ) const;
+	const FinalPacket* GetBaselineForSnapshot( ClientID playerID, PacketNumber numberToSend ) const;
+
+private:
+
+	struct Snapshot
+	{
+		FinalPacket	packet;
+		bool		isValid;
+	};
+
+	Snapshot		m_snapshots[ SNAPSHOT_HISTORY_SIZE ];
+	PacketNumber	m_ackedBaselineNumbers[ NUM_CLIENT_IDS ];
+	bool			m_hasAckedBaseline[ NUM_CLIENT_IDS ];
+};
+
+
+#endif
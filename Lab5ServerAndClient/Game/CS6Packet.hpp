@@ -31,6 +31,19 @@ static const PacketType TYPE_Reset = 14;
 static const PacketType TYPE_LobbyStart = 15;
 static const PacketType TYPE_JoinGame = 16;
 static const PacketType TYPE_HostGame = 17;
+static const PacketType TYPE_Fragment = 18;
+
+//-----------------------------------------------------------------------------------------------
+//What a message sent in fragments holds, its first byte
+typedef unsigned char MessageType;
+static const MessageType MESSAGE_GameList = 1;
+
+//A fragment takes what is left of the union, so the union stays the size it was
+static const int FRAGMENT_PAYLOAD_BYTES = 19;
+static const int MAX_FRAGMENTED_MESSAGE_BYTES = FRAGMENT_PAYLOAD_BYTES * 255;
+
+//How many reliable packets before the newest one a header can ack
+static const int NUM_ACKED_RELIABLE_BITS = 32;
 
 //-----------------------------------------------------------------------------------------------
 struct AckPacket
@@ -96,12 +109,28 @@ struct JoinGamePacket
 
 
 //-----------------------------------------------------------------------------------------------
+//One piece of a message too big for a packet. Each piece is sent reliably on its own.
+struct FragmentPacket
+{
+	unsigned short messageID;
+	unsigned char fragmentIndex;
+	unsigned char numFragments;
+	unsigned char numBytes;
+	unsigned char bytes[ FRAGMENT_PAYLOAD_BYTES ];
+};
+
+
+//-----------------------------------------------------------------------------------------------
+//Every packet acks the newest reliable packet its sender has received, 0 for none, and with one bit
+//each the NUM_ACKED_RELIABLE_BITS before it, lowest bit first.
 struct CS6Packet
 {
 	PacketType packetType;
 	unsigned char playerColorAndID[ 3 ];
 	unsigned int packetNumber;
 	double timestamp;
+	unsigned int ackedReliableNumber;
+	unsigned int ackedReliableBits;
 	union PacketData
 	{
 		AckPacket acknowledged;
@@ -111,6 +140,7 @@ struct CS6Packet
 		ResetPacket reset;
 		UpdatePacket updated;
 		VictoryPacket victorious;
+		FragmentPacket fragment;
 	} data;
 
 	inline bool IsReliablePacket() const;
@@ -125,6 +155,7 @@ inline bool CS6Packet::IsReliablePacket() const
 		|| packetType == TYPE_LobbyStart 
 		|| packetType == TYPE_HostGame
 		|| packetType == TYPE_JoinGame
+		|| packetType == TYPE_Fragment
 		|| ( packetType == TYPE_Acknowledge && data.acknowledged.packetType == TYPE_LobbyStart );
 
 	return result;
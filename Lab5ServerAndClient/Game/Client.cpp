@@ -10,6 +10,7 @@
 #include "Engine/Utilities/CommandRegistry.hpp"
 #include "Engine/Utilities/CommonUtilities.hpp"
 #include "Engine/Utilities/Clock.hpp"
+#include "Engine/Utilities/Time.hpp"
 #include "Engine/Primitives/Vector4.hpp"
 
 #define UNUSED( x ) ( void )( x )
@@ -35,13 +36,16 @@ Client::Client()
 	: m_currentState( CLIENT_UNCONNECTED )
 	//, m_currentItPlayerID( BAD_IT_PLAYER )
 	, m_flagPosition( 0.f, 0.f )
-	, m_connectionToHostID( 0 )
+	, m_connectionToHostID( INVALID_CONNECTION_ID )
 	, m_currentHostIPAddressAsString( STARTING_SERVER_IP_AS_STRING )
 	, m_currentHostPort( STARTING_PORT )
 	, m_sendPacketsToHostFrequency( SEND_TO_HOST_FREQUENCY )
 	, m_localPlayerMovementMagnitude( 0.f )
 	, m_mostRecentlyProcessedUnreliablePacketNum( 0 )
 	, m_nextExpectedReliablePacketNumToProcess( 1 )
+	, m_newestReliablePacketNumReceived( 0 )
+	, m_olderReliablePacketsReceivedBits( 0 )
+	, m_fragmentedMessagesFromHost( FRAGMENT_PAYLOAD_BYTES, MAX_FRAGMENTED_MESSAGE_BYTES )
 {
 	m_localPlayer.id = LOCAL_PLAYER_ID;
 }
@@ -91,6 +95,8 @@ void Client::Update()
 
 	ReceiveMessagesFromHostIfAny();
 
+	m_fragmentedMessagesFromHost.DropExpiredMessages( Time::GetCurrentTimeInSeconds() );
+
 	if( m_currentState == CLIENT_UNCONNECTED )
 	{
 		PotentiallySendAckAckPacketToServer( currentElapsedSendConnectAckAckPacketSeconds, SEND_TO_HOST_MAX_DELAY );
@@ -141,10 +147,17 @@ void Client::ChangeHost( const std::string& ipAddressAsString, const std::string
 	m_currentHostIPAddressAsString = ipAddressAsString;
 	m_currentHostPort = u_short( atoi( portAsString.c_str() ) );
 
+	//frees the old connection's slot, otherwise every host change leaks a socket
+	theNetwork.CloseUDPSocket( m_connectionToHostID );
+
 	m_connectionToHostID = theNetwork.CreateUDPSocketFromIPAndPort( m_currentHostIPAddressAsString.c_str(), m_currentHostPort );
 
 
 	m_otherClientsPlayers.clear();
+	m_fragmentedMessagesFromHost.Clear();
+
+	m_newestReliablePacketNumReceived = 0;
+	m_olderReliablePacketsReceivedBits = 0;
 
 	m_localPlayer.Reset();
 }
@@ -193,8 +206,7 @@ void Client::CreateGame()
 	CS6Packet createGamePacket;
 	createGamePacket = GetHostGamePacket();
 
-	Network& theNetwork = Network::GetInstance();
-	theNetwork.SendUDPMessage( ( char* )&createGamePacket, sizeof( createGamePacket ), m_connectionToHostID );
+	SendPacketToHost( createGamePacket );
 }
 
 
@@ -210,8 +222,7 @@ void Client::JoinTargetedGame()
 	CS6Packet joinGamePacket;
 	joinGamePacket = GetJoinGamePacket();
 
-	Network& theNetwork = Network::GetInstance();
-	theNetwork.SendUDPMessage( ( char* )&joinGamePacket, sizeof( joinGamePacket ), m_connectionToHostID );
+	SendPacketToHost( joinGamePacket );
 }
 
 
@@ -221,42 +232,76 @@ void Client::JoinTargetedGame()
 void Client::ReceiveMessagesFromHostIfAny()
 {
 	Network& theNetwork = Network::GetInstance();
-	std::set< CS6Packet, PacketComparator > packetQueueForThisFrame;
-
-	int bytesReceived = 0;
 
-	do 
-	{
-		CS6Packet receivedPacket;
-		bytesReceived = 0;
+	ReceivedDatagram* receivedDatagrams = nullptr;
+	int numDatagramsReceived = 0;
 
-		ZeroMemory( &receivedPacket, sizeof( receivedPacket ) );
+	m_packetsReceivedThisFrame.clear();
 
-		bytesReceived = theNetwork.ReceiveUDPMessage( ( char* )&receivedPacket, sizeof( receivedPacket ), m_connectionToHostID );
-			
-		if( bytesReceived == sizeof( CS6Packet ) )
+	//packets stay in the network's receive ring until everything this frame has been processed
+	while( ( numDatagramsReceived = theNetwork.ReceiveUDPMessagesInPlace( m_connectionToHostID, receivedDatagrams ) ) > 0 )
+	{
+		for( int i = 0; i < numDatagramsReceived; ++i )
 		{
-			//ProcessPacket( receivedPacket );
-			packetQueueForThisFrame.insert( receivedPacket );
+			//the server packs a frame's packets to one client back to back
+			int numBytesReceived = receivedDatagrams[ i ].bytesReceived;
+
+			if( numBytesReceived == 0 || numBytesReceived % sizeof( CS6Packet ) != 0 )
+			{
+				continue;
+			}
+
+			for( int packetOffset = 0; packetOffset < numBytesReceived; packetOffset += sizeof( CS6Packet ) )
+			{
+				m_packetsReceivedThisFrame.push_back( ( const CS6Packet* )( receivedDatagrams[ i ].buffer + packetOffset ) );
+			}
 		}
-	} 
-	while ( bytesReceived > 0 );
+	}
+
+	SortPacketsReceivedThisFrame();
 
+	for( int i = 0; i < static_cast< int >( m_packetsReceivedThisFrame.size() ); ++i )
+	{
+		ProcessPacket( *m_packetsReceivedThisFrame[ i ] );
+	}
 
-	auto packetQueueIterator = packetQueueForThisFrame.begin();
+	theNetwork.ReleaseReceivedDatagrams( m_connectionToHostID );
+}
 
 
-	for( ; packetQueueIterator != packetQueueForThisFrame.end(); ++packetQueueIterator )
+//-----------------------------------------------------------------------------------------------
+//Same order and duplicate rule as the std::set this replaced, lowest packet number first and the
+//first copy wins. Insertion sort keeps it stable and allocation free, and packets mostly arrive in order.
+void Client::SortPacketsReceivedThisFrame()
+{
+	int numPackets = static_cast< int >( m_packetsReceivedThisFrame.size() );
+	int numUniquePackets = 0;
+
+	for( int i = 0; i < numPackets; ++i )
 	{
-		ProcessPacket( *packetQueueIterator );
+		const CS6Packet* packetToInsert = m_packetsReceivedThisFrame[ i ];
+		int insertIndex = numUniquePackets;
+
+		while( insertIndex > 0 && m_packetsReceivedThisFrame[ insertIndex - 1 ]->packetNumber > packetToInsert->packetNumber )
+		{
+			--insertIndex;
+		}
+
+		if( insertIndex > 0 && m_packetsReceivedThisFrame[ insertIndex - 1 ]->packetNumber == packetToInsert->packetNumber )
+		{
+			continue;
+		}
+
+		for( int j = numUniquePackets; j > insertIndex; --j )
+		{
+			m_packetsReceivedThisFrame[ j ] = m_packetsReceivedThisFrame[ j - 1 ];
+		}
+
+		m_packetsReceivedThisFrame[ insertIndex ] = packetToInsert;
+		++numUniquePackets;
 	}
 
-	//while( packetQueueForThisFrame.size() > 0 )
-	//{
-	//	ProcessPacket( *packetQueueForThisFrame.begin() );
-	//	packetQueueForThisFrame.erase( packetQueueForThisFrame.begin() );
-	//}
-	
+	m_packetsReceivedThisFrame.resize( numUniquePackets );
 }
 
 
@@ -307,8 +352,7 @@ void Client::PotentiallySendAckAckPacketToServer( float& elapsedSendTime, float
 
 	CS6Packet gameStartAckPacket = GetAckAckPacket();
 
-	Network& theNetwork = Network::GetInstance();
-	theNetwork.SendUDPMessage( ( char* )&gameStartAckPacket, sizeof( gameStartAckPacket ), m_connectionToHostID );
+	SendPacketToHost( gameStartAckPacket );
 
 	elapsedSendTime = 0.f;
 }
@@ -323,8 +367,7 @@ void Client::PotentiallySendUpdatePacketToServer( float& elapsedSendTime, float
 
 	CS6Packet updatePacketToSend = GetUpdatePacketFromPlayer( m_localPlayer );
 
-	Network& theNetwork = Network::GetInstance();
-	theNetwork.SendUDPMessage( ( char* )&updatePacketToSend, sizeof( updatePacketToSend ), m_connectionToHostID );
+	SendPacketToHost( updatePacketToSend );
 
 	elapsedSendTime = 0.f;
 }
@@ -340,8 +383,7 @@ void Client::PotentiallySendVictoryPacketToServer( float& elapsedSendTime, float
 
 	CS6Packet updatePacketToSend = GetVictoryPacketFromPlayer( m_localPlayer );
 
-	Network& theNetwork = Network::GetInstance();
-	theNetwork.SendUDPMessage( ( char* )&updatePacketToSend, sizeof( updatePacketToSend ), m_connectionToHostID );
+	SendPacketToHost( updatePacketToSend );
 
 	elapsedSendTime = 0.f;
 }
@@ -361,8 +403,47 @@ void Client::AckBackSuccessfulReliablePacketReceive( const CS6Packet& packet )
 	}
 	ackBackPacket.data.acknowledged.packetNumber = packet.packetNumber;
 
+	SendPacketToHost( ackBackPacket );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Anything newer than the newest shifts the history up, anything too far behind it is already
+//out of the history and was acked on its own
+void Client::RecordReliablePacketReceived( uint packetNumber )
+{
+	if( packetNumber > m_newestReliablePacketNumReceived )
+	{
+		uint numNewer = packetNumber - m_newestReliablePacketNumReceived;
+
+		if( m_newestReliablePacketNumReceived == 0 || numNewer > static_cast< uint >( NUM_ACKED_RELIABLE_BITS ) )
+		{
+			m_olderReliablePacketsReceivedBits = 0;
+		}
+		else
+		{
+			m_olderReliablePacketsReceivedBits = ( numNewer < static_cast< uint >( NUM_ACKED_RELIABLE_BITS ) ) ? m_olderReliablePacketsReceivedBits << numNewer : 0;
+			m_olderReliablePacketsReceivedBits |= 1u << ( numNewer - 1 );
+		}
+
+		m_newestReliablePacketNumReceived = packetNumber;
+	}
+	else if( packetNumber < m_newestReliablePacketNumReceived && m_newestReliablePacketNumReceived - packetNumber <= static_cast< uint >( NUM_ACKED_RELIABLE_BITS ) )
+	{
+		m_olderReliablePacketsReceivedBits |= 1u << ( m_newestReliablePacketNumReceived - packetNumber - 1 );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Every packet to the host carries the acks, so one that is lost is made up for by the next
+void Client::SendPacketToHost( CS6Packet& packet )
+{
+	packet.ackedReliableNumber = m_newestReliablePacketNumReceived;
+	packet.ackedReliableBits = m_olderReliablePacketsReceivedBits;
+
 	Network& theNetwork = Network::GetInstance();
-	theNetwork.SendUDPMessage( ( char* )&ackBackPacket, sizeof( ackBackPacket ), m_connectionToHostID );
+	theNetwork.SendUDPMessage( ( char* )&packet, sizeof( packet ), m_connectionToHostID );
 }
 
 
@@ -529,6 +610,13 @@ void Client::ProcessPacket( const CS6Packet& packet )
 	{
 		//FUTURE EDIT: Ack to Server that client received reliable packet!
 
+		//a fragment with nowhere to go is left unacked, the server resends it once there is room
+		if( packet.packetType == TYPE_Fragment && !StoreFragmentPacket( packet ) )
+		{
+			return;
+		}
+
+		RecordReliablePacketReceived( packet.packetNumber );
 		AckBackSuccessfulReliablePacketReceive( packet );
 
 		if( packet.packetNumber > m_nextExpectedReliablePacketNumToProcess )
@@ -578,6 +666,10 @@ void Client::ProcessPacket( const CS6Packet& packet )
 	{
 		OnReceiveLobbyStartPacket( packet );
 	}
+	else if( typeOfPacket == TYPE_Fragment )
+	{
+		OnReceiveFragmentPacket( packet );
+	}
 
 	//actually may not need this since we return from if statement
 	if( shouldProcessReliablePacketsInQueue )
@@ -765,6 +857,69 @@ void Client::OnReceiveAckLobbyStartPacket( const CS6Packet& ackPacket )
 }
 
 
+//-----------------------------------------------------------------------------------------------
+//Stored as soon as it arrives, in whatever order, so the message is whole by the time its last
+//fragment comes up in order. Garbage is dropped without an ack, the server will give up on it.
+bool Client::StoreFragmentPacket( const CS6Packet& fragmentPacket )
+{
+	const FragmentPacket& fragment = fragmentPacket.data.fragment;
+
+	FragmentResult result = m_fragmentedMessagesFromHost.AddFragment( fragment.messageID, fragment.fragmentIndex, fragment.numFragments, fragment.bytes, fragment.numBytes, Time::GetCurrentTimeInSeconds() );
+
+	return result == FRAGMENT_Stored || result == FRAGMENT_Duplicate;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Handed over in order with the other reliable packets, the whole message goes with whichever of its
+//fragments is handled last
+void Client::OnReceiveFragmentPacket( const CS6Packet& fragmentPacket )
+{
+	if( !m_fragmentedMessagesFromHost.PopCompletedMessage( fragmentPacket.data.fragment.messageID, m_completedMessage ) || m_completedMessage.empty() )
+	{
+		return;
+	}
+
+	MessageType typeOfMessage = m_completedMessage[ 0 ];
+
+	if( typeOfMessage == MESSAGE_GameList )
+	{
+		OnReceiveGameListMessage( m_completedMessage );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Replaces the listed games all at once
+void Client::OnReceiveGameListMessage( const std::vector< unsigned char >& message )
+{
+	unsigned int numGamesInList = 0;
+	int headerBytes = sizeof( MessageType ) + sizeof( numGamesInList );
+
+	if( m_currentState != CLIENT_IN_LOBBY || static_cast< int >( message.size() ) < headerBytes )
+	{
+		return;
+	}
+
+	memcpy( &numGamesInList, &message[ sizeof( MessageType ) ], sizeof( numGamesInList ) );
+
+	if( ( message.size() - headerBytes ) / sizeof( unsigned int ) < numGamesInList )
+	{
+		return;
+	}
+
+	m_gameIDsFromLobby.clear();
+
+	for( unsigned int i = 0; i < numGamesInList; ++i )
+	{
+		unsigned int gameID = 0;
+
+		memcpy( &gameID, &message[ headerBytes + i * sizeof( gameID ) ], sizeof( gameID ) );
+		m_gameIDsFromLobby.insert( gameID );
+	}
+}
+
+
 //-----------------------------------------------------------------------------------------------
 CS6Packet Client::GetGameStartAckPacket()
 {
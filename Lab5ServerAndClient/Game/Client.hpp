@@ -6,6 +6,7 @@
 #include <set>
 
 #include "Engine/Networking/Network.hpp"
+#include "Engine/Networking/FragmentReassembler.hpp"
 #include "Engine/Utilities/EventSystem.hpp"
 
 #include "CS6Packet.hpp"
@@ -61,12 +62,15 @@ public:
 private:
 
 	void		ReceiveMessagesFromHostIfAny();
+	void		SortPacketsReceivedThisFrame();
 	void		UpdatePlayers();
 	bool		CheckForCollision( float& elapsedSendTime, float sendToTime );
 	void		PotentiallySendAckAckPacketToServer( float& elapsedSendTime, float sendToTime );
 	void		PotentiallySendUpdatePacketToServer( float& elapsedSendTime, float sendToTime );
 	void		PotentiallySendVictoryPacketToServer( float& elapsedSendTime, float sendToTime );
 	void		AckBackSuccessfulReliablePacketReceive( const CS6Packet& packet );
+	void		RecordReliablePacketReceived( uint packetNumber );
+	void		SendPacketToHost( CS6Packet& packet );
 
 	void		RenderPlayers() const;
 	void		RenderPlayer( const ClientPlayer& playerToRender ) const;
@@ -84,6 +88,9 @@ private:
 	void		OnReceiveVictoryPacket( const CS6Packet& victoryPacket );
 	void		OnReceiveAckPacket( const CS6Packet& ackPacket );
 	void		OnReceiveAckLobbyStartPacket( const CS6Packet& ackPacket );
+	bool		StoreFragmentPacket( const CS6Packet& fragmentPacket );
+	void		OnReceiveFragmentPacket( const CS6Packet& fragmentPacket );
+	void		OnReceiveGameListMessage( const std::vector< unsigned char >& message );
 
 	CS6Packet	GetGameStartAckPacket();
 	CS6Packet	GetAckAckPacket();
@@ -113,8 +120,14 @@ private:
 
 	uint						m_mostRecentlyProcessedUnreliablePacketNum;
 	uint						m_nextExpectedReliablePacketNumToProcess;
+	uint						m_newestReliablePacketNumReceived;
+	uint						m_olderReliablePacketsReceivedBits;
+
+	FragmentReassembler				m_fragmentedMessagesFromHost;
+	std::vector< unsigned char >	m_completedMessage;
 
 	std::set< CS6Packet, PacketComparator > m_queueOfReliablePacketsToParse;
+	std::vector< const CS6Packet* >			m_packetsReceivedThisFrame;
 	
 	std::set< unsigned int >	m_gameIDsFromLobby;
 	int							m_selectedGameID;
@@ -1,16 +1,15 @@
 #include "ConnectedClient.hpp"
 
-ConnectionID ConnectedClient::s_currentConnectedID = 0;
-
 //-----------------------------------------------------------------------------------------------
 ConnectedClient::ConnectedClient()
 	: clientID( "" )
 	, ipAddressAsString( "" )
 	, portAsString( "" )
 	, mostRecentUpdateInfo()
-	, timeSinceLastReceivedMessage( 0.f )
+	, lastReceivedMessageTimeSeconds( 0.0 )
 	, numUnreliableMessagesSent( 0 )
 	, numReliableMessagesSent( 0 )
+	, numFragmentedMessagesSent( 0 )
 	, connectionID( 0 )
 {
 	memset( &mostRecentUpdateInfo, 0, sizeof( mostRecentUpdateInfo ) );
@@ -23,10 +22,12 @@ ConnectedClient::ConnectedClient( const std::string& ipAddress, const std::strin
 	: clientID( port + ipAddress )
 	, ipAddressAsString( ipAddress )
 	, portAsString( port )
+	, peerAddress( ipAddress, port )
 	, mostRecentUpdateInfo()
-	, timeSinceLastReceivedMessage( 0.f )
+	, lastReceivedMessageTimeSeconds( 0.0 )
 	, numUnreliableMessagesSent( 0 )
 	, numReliableMessagesSent( 0 )
+	, numFragmentedMessagesSent( 0 )
 	, connectionID( 0 )
 {
 	memset( &mostRecentUpdateInfo, 0, sizeof( mostRecentUpdateInfo ) );
@@ -39,11 +40,32 @@ ConnectedClient::ConnectedClient( const std::string& ipAddress, const std::strin
 	: clientID( port + ipAddress )
 	, ipAddressAsString( ipAddress )
 	, portAsString( port )
+	, peerAddress( ipAddress, port )
 	, mostRecentUpdateInfo( incomingPacket )
-	, timeSinceLastReceivedMessage( 0.f )
+	, lastReceivedMessageTimeSeconds( 0.0 )
+	, numUnreliableMessagesSent( 0 )
+	, numReliableMessagesSent( 0 )
+	, numFragmentedMessagesSent( 0 )
+	, connectionID( 0 )
+{
+	memset( &playerIDAsRGB, 0, sizeof( playerIDAsRGB ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Address strings are only built here, once at join time, for display
+ConnectedClient::ConnectedClient( const PeerAddress& address )
+	: clientID( address.GetPortAsString() + address.GetIPAddressAsString() )
+	, ipAddressAsString( address.GetIPAddressAsString() )
+	, portAsString( address.GetPortAsString() )
+	, peerAddress( address )
+	, mostRecentUpdateInfo()
+	, lastReceivedMessageTimeSeconds( 0.0 )
 	, numUnreliableMessagesSent( 0 )
 	, numReliableMessagesSent( 0 )
+	, numFragmentedMessagesSent( 0 )
 	, connectionID( 0 )
 {
+	memset( &mostRecentUpdateInfo, 0, sizeof( mostRecentUpdateInfo ) );
 	memset( &playerIDAsRGB, 0, sizeof( playerIDAsRGB ) );
 }
\ No newline at end of file
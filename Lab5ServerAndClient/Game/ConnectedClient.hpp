@@ -2,9 +2,14 @@
 #define CONNECTED_CLIENT_HPP
 
 #include <map>
+#include <deque>
 
 #include "CS6Packet.hpp"
 #include "Engine/Primitives/Color.hpp"
+#include "Engine/Networking/PeerAddress.hpp"
+#include "Engine/Networking/ConnectionStats.hpp"
+#include "Engine/Networking/ReliableSendWindow.hpp"
+#include "Engine/Networking/SendPacer.hpp"
 
 typedef unsigned int GameID;
 typedef unsigned int ConnectionID;
@@ -18,23 +23,28 @@ public:
 	ConnectedClient();
 	ConnectedClient( const std::string& ipAddress, const std::string& port );
 	ConnectedClient( const std::string& ipAddress, const std::string& port, const UpdatePacket& incomingPacket );
+	explicit ConnectedClient( const PeerAddress& address );
 
 	std::string  clientID;
 	std::string  ipAddressAsString;
 	std::string  portAsString;
+	PeerAddress	 peerAddress;
 
 	UpdatePacket mostRecentUpdateInfo;
 	PlayerID	 playerIDAsRGB;
 
-	float		 timeSinceLastReceivedMessage;
+	double		 lastReceivedMessageTimeSeconds;
 	int			 numUnreliableMessagesSent;
 	int			 numReliableMessagesSent;
+	int			 numFragmentedMessagesSent;
 	ConnectionID connectionID;
 	GameID		 gameID;
 
-	std::map< uint, CS6Packet > m_reliablePacketsAwaitingAckBack;
+	ReliableSendWindow< CS6Packet > m_reliablePacketsAwaitingAckBack;
+	std::deque< CS6Packet >			m_reliablePacketsWaitingForRoom;
 
-	static ConnectionID s_currentConnectedID;
+	ConnectionStats connectionStats;
+	SendPacer		sendPacer;
 };
 
 #endif
\ No newline at end of file
@@ -37,6 +37,12 @@ int g_screenHeight = 800;
 
 const double MAX_APP_FRAME_TIME = 0.1;
 
+//Keeps the server window's message pump responsive while it sleeps on the socket
+const double MAX_SERVER_IDLE_SECONDS = 0.1;
+
+//An idle server still redraws this often, for the console cursor and lines logged from timers
+const double MAX_SERVER_SECONDS_BETWEEN_RENDERS = 0.5;
+
 FMOD::System* Game::m_soundSystem = nullptr;
 FMOD::Sound *test = nullptr;
 FMOD::Channel *channel = nullptr;
@@ -64,6 +70,60 @@ void Command_Clear(const ConsoleCommandArgs& args)
 	}
 }
 
+//-----------------------------------------------------------------------------------------------
+//Whoever owns a connection listens for this and prints its ConnectionStats
+void Command_NetStats( const ConsoleCommandArgs& args )
+{
+	UNUSED( args );
+
+	NamedProperties noProperties;
+
+	EventSystem::GetInstance().FireEvent( "dumpNetStats", noProperties );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Hands a console command to the command line event of the same parameters, as param1, param2...
+void FireEventWithConsoleArgs( const std::string& eventName, const ConsoleCommandArgs& args )
+{
+	NamedProperties eventProperties;
+
+	for( int i = 1; i < static_cast< int >( args.m_argsList.size() ); ++i )
+	{
+		char buffer[ 32 ];
+
+		std::string paramName = "param";
+		paramName += std::string( _itoa( i, buffer, 10 ) );
+
+		eventProperties.Set( paramName, args.m_argsList[ i ] );
+	}
+
+	EventSystem::GetInstance().FireEvent( eventName, eventProperties );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Command_NetSim( const ConsoleCommandArgs& args )
+{
+	FireEventWithConsoleArgs( "simulateNetwork", args );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Command_NetCapture( const ConsoleCommandArgs& args )
+{
+	FireEventWithConsoleArgs( "capturePackets", args );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Command_NetBenchmark( const ConsoleCommandArgs& args )
+{
+	FireEventWithConsoleArgs( "benchmarkNetwork", args );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Command_NetMtu( const ConsoleCommandArgs& args )
+{
+	FireEventWithConsoleArgs( "maxDatagramSize", args );
+}
+
 //-----------------------------------------------------------------------------------------------
 //void Command_ChangeHost( const ConsoleCommandArgs& args )
 //{
@@ -96,6 +156,8 @@ void Command_Clear(const ConsoleCommandArgs& args)
 //-----------------------------------------------------------------------------------------------
 Game::Game()
 	: m_isClient( true )
+	, m_numServerShards( 1 )
+	, m_timeAtLastRenderSeconds( 0.0 )
 {
 	srand( ( unsigned int )time ( NULL ) );
 }
@@ -124,6 +186,11 @@ void Game::Initialize(HINSTANCE applicationInstanceHandle)
 
 	commandRegistry.RegisterEvent( "quit", Command_Quit );
 	commandRegistry.RegisterEvent( "clear",Command_Clear );
+	commandRegistry.RegisterEvent( "netStats", Command_NetStats );
+	commandRegistry.RegisterEvent( "netSim", Command_NetSim );
+	commandRegistry.RegisterEvent( "netCapture", Command_NetCapture );
+	commandRegistry.RegisterEvent( "netBenchmark", Command_NetBenchmark );
+	commandRegistry.RegisterEvent( "netMtu", Command_NetMtu );
 	//commandRegistry.RegisterEvent( "changeHost", Command_ChangeHost );
 
 	Clock& masterClock = Clock::GetMasterClock();
@@ -133,8 +200,17 @@ void Game::Initialize(HINSTANCE applicationInstanceHandle)
 	{
 		m_client.StartUp();
 	}
+	else if( m_numServerShards > 1 && Network::GetInstance().SupportsPortSharing() )
+	{
+		m_shardedServer.StartUp( m_numServerShards, m_server.GetServerPort() );
+	}
 	else
 	{
+		if( m_numServerShards > 1 )
+		{
+			ConsoleLog::s_currentLog->ConsolePrint( "serverShards: this platform cannot share a port between sockets, running one server.", Vector4f( 1.f, 0.f, 0.f, 1.f ), true );
+		}
+
 		m_server.StartUp();
 	}
 }
@@ -153,12 +229,26 @@ void Game::Run()
 {
 	while(!m_inputHandler.ShouldQuit())
 	{
-		m_inputHandler.RunMessagePump();
+		bool wasAnyWindowMessageHandled = m_inputHandler.RunMessagePump();
 		m_inputHandler.RunXboxMessagePump();
 		m_soundSystem->update();
 		ProcessInput();
 		Update();
-		Render();
+
+		if( ShouldRender( wasAnyWindowMessageHandled ) )
+		{
+			Render();
+		}
+
+		if( !m_isClient && m_shardedServer.IsRunning() )
+		{
+			//shards do the networking on their own threads, this only wakes for what they change
+			m_shardedServer.WaitForShardChanges( MAX_SERVER_IDLE_SECONDS );
+		}
+		else if( !m_isClient )
+		{
+			m_server.WaitForClientMessagesOrNextScheduledEvent( MAX_SERVER_IDLE_SECONDS );
+		}
 	}
 }
 
@@ -179,7 +269,7 @@ void Game::Update()
 	{
 		m_client.Update();
 	}
-	else
+	else if( !m_shardedServer.IsRunning() )
 	{
 		m_server.Update();
 	}
@@ -190,6 +280,8 @@ void Game::Update()
 //-----------------------------------------------------------------------------------------------
 void Game::Render()
 {
+	m_timeAtLastRenderSeconds = Time::GetCurrentTimeInSeconds();
+
 	const Vector4f clearColor = Color( Black ).ToVector4fNormalized();
 
 	OpenGLRenderer::ClearColor( clearColor.x, clearColor.y, clearColor.z, clearColor.w );
@@ -199,6 +291,10 @@ void Game::Render()
 	{
 		m_client.Render();
 	}
+	else if( m_shardedServer.IsRunning() )
+	{
+		m_shardedServer.Render();
+	}
 	else
 	{
 		m_server.Render();
@@ -208,6 +304,29 @@ void Game::Render()
 	SwapBuffers( OpenGLRenderer::displayDeviceContext );
 }
 
+//-----------------------------------------------------------------------------------------------
+//The client draws every frame. A server only draws when input came in or what it shows changed,
+//so an idle one is left asleep on its sockets.
+bool Game::ShouldRender( bool wasAnyWindowMessageHandled ) const
+{
+	if( m_isClient || wasAnyWindowMessageHandled )
+	{
+		return true;
+	}
+
+	if( Time::GetCurrentTimeInSeconds() - m_timeAtLastRenderSeconds >= MAX_SERVER_SECONDS_BETWEEN_RENDERS )
+	{
+		return true;
+	}
+
+	if( m_shardedServer.IsRunning() )
+	{
+		return m_shardedServer.HasChangedSinceLastRender();
+	}
+
+	return m_server.HasChangedSinceLastRender();
+}
+
 //-----------------------------------------------------------------------------------------------
 void Game::ProcessInput()
 {
@@ -392,6 +511,29 @@ void Game::SetToServerEvent( NamedProperties& parameters )
 }
 
 
+//-----------------------------------------------------------------------------------------------
+void Game::SetNumServerShardsEvent( NamedProperties& parameters )
+{
+	std::string numShardsAsString;
+
+	parameters.Get( "param1", numShardsAsString );
+
+	std::set< ErrorType > errors = ValidateIsInt( numShardsAsString );
+
+	RECOVERABLE_ASSERTION( errors.empty(), "Command: serverShards did not receive the correct parameters.\nserverShards expects one parameter of type int, the number of server threads." );
+
+	if( !errors.empty() )
+		return;
+
+	m_numServerShards = static_cast< int >( strtol( numShardsAsString.c_str(), 0, 10 ) );
+
+	if( m_numServerShards < 1 )
+	{
+		m_numServerShards = 1;
+	}
+}
+
+
 //-----------------------------------------------------------------------------------------------
 //void Game::PotentiallyRequestGameStartFromServer()
 //{
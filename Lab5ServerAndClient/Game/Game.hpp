@@ -11,6 +11,7 @@
 
 #include "Client.hpp"
 #include "Server.hpp"
+#include "ShardedServer.hpp"
 
 
 //-----------------------------------------------------------------------------------------------
@@ -29,11 +30,13 @@ public:
 	void Run();
 	void Update();
 	void Render();
+	bool ShouldRender( bool wasAnyWindowMessageHandled ) const;
 	void ProcessInput();
 	void UpdateConsoleLogOnInput();
 
 	void		SetScreenResolutionEvent( NamedProperties& parameters );
 	void		SetToServerEvent( NamedProperties& parameters ); 
+	void		SetNumServerShardsEvent( NamedProperties& parameters );
 	inline void RegisterForEvents();
 
 	static void CreateSound( const char* songPath, FMOD::Sound* &sound );
@@ -46,6 +49,9 @@ public:
 
 	Client			m_client;
 	Server			m_server;
+	ShardedServer	m_shardedServer;
+	int				m_numServerShards;
+	double			m_timeAtLastRenderSeconds;
 
 	static FMOD::System *m_soundSystem;
 	static Clock* s_appClock;
@@ -59,6 +65,7 @@ inline void Game::RegisterForEvents()
 
 	eventSystem.RegisterEventWithCallbackAndObject( "setRes", &Game::SetScreenResolutionEvent, this );
 	eventSystem.RegisterEventWithCallbackAndObject( "server", &Game::SetToServerEvent, this );
+	eventSystem.RegisterEventWithCallbackAndObject( "serverShards", &Game::SetNumServerShardsEvent, this );
 
 	m_client.RegisterForEvents();
 	m_server.RegisterForEvents(); 
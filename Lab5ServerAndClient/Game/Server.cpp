@@ -1,3 +1,5 @@
+#define UNUSED(x) (void)(x);
+
 #include "Server.hpp"
 
 #include <sstream>
@@ -9,32 +11,51 @@
 #include "Engine/Utilities/Clock.hpp"
 #include "Engine/Utilities/Time.hpp"
 #include "Engine/Utilities/ErrorWarningAssert.hpp"
+#include "Engine/Networking/FragmentReassembler.hpp"
 
 const float MAX_SECONDS_OF_INACTIVITY = 5.f;
-const float RESEND_RELIABLE_PACKET_TIME = 2.f;
+
+//A second full window queued behind the first, the client has stopped acking
+const int MAX_RELIABLE_PACKETS_WAITING_FOR_ROOM = RELIABLE_SEND_WINDOW_SIZE;
+
+//The fastest updates go out, each client's pacer decides how many of them its link can take
 const float SEND_DELAY = 0.005f;
 
+//Finer than any deadline the server keeps, coarse enough that a frame passes only a handful of ticks
+const double TIMER_WHEEL_TICK_SECONDS = 0.001;
+
 const char* IP_AS_STRING = "127.0.0.1";
 const u_short STARTING_PORT = 5000;
 
+//Room for a long hitch's worth of bursts from every client, the platform default is far smaller
+const int LISTEN_SOCKET_RECEIVE_BUFFER_BYTES = 1024 * 1024;
+
 const int ARENA_WIDTH = 500;
 const int ARENA_HEIGHT = 500;
 const unsigned int LOBBY_ID = 0;
 
-float g_currentSendElapsedTime = 0.f;
-
-GameID Server::s_currentMaxGameID = 0;
-
 //const PlayerID BAD_IT_PLAYER = Color( Black );
 
 //-----------------------------------------------------------------------------------------------
 //Public Methods
 //-----------------------------------------------------------------------------------------------
 Server::Server()
-	: m_listenConnectionID( 0 )
+	: m_listenConnectionID( INVALID_CONNECTION_ID )
+	, m_useNetworkThread( false )
+	, m_numQueuedDatagramsThisFrame( 0 )
+	, m_currentPacketArrivalTimeSeconds( 0.0 )
 	, m_currentServerIPAddressAsString( IP_AS_STRING )
 	, m_currentServerPort( STARTING_PORT )
 	//, m_currentItPlayerID( BAD_IT_PLAYER )
+	, m_numClientListChanges( 0 )
+	, m_numClientListChangesRendered( 0 )
+	, m_currentSendElapsedTime( 0.f )
+	, m_currentMaxConnectionID( 0 )
+	, m_currentMaxGameID( 0 )
+	, m_sharedLobby( nullptr )
+	, m_shardIndex( 0 )
+	, m_lastSeenLobbyVersion( 0 )
+	, m_timerWheel( TIMER_WHEEL_TICK_SECONDS )
 {
 }
 
@@ -51,8 +72,30 @@ void Server::StartUp()
 {
 	Network& theNetwork = Network::GetInstance();
 
+	m_timerWheel.Reset( Time::GetCurrentTimeInSeconds() );
+
 	m_listenConnectionID = theNetwork.CreateUDPSocketFromIPAndPort( "0.0.0.0", m_currentServerPort );
+
+	//a size given on the command line wins
+	if( theNetwork.GetDefaultReceiveBufferBytes() == 0 )
+	{
+		theNetwork.SetSocketBufferSizes( m_listenConnectionID, LISTEN_SOCKET_RECEIVE_BUFFER_BYTES, 0 );
+	}
+
+	if( m_sharedLobby != nullptr )
+	{
+		bool isPortShared = theNetwork.EnablePortSharing( m_listenConnectionID );
+
+		FATAL_ASSERTION( isPortShared, "Server shard could not share its listen port.\nSharded servers need SO_REUSEPORT." );
+	}
+
 	theNetwork.BindSocket( m_listenConnectionID );
+
+	//shards already run off the main thread, so only a standalone server hands its socket over
+	if( m_useNetworkThread && m_sharedLobby == nullptr )
+	{
+		m_networkThread.StartUp( m_listenConnectionID );
+	}
 }
 
 
@@ -61,6 +104,7 @@ void Server::ShutDown()
 {
 	Network& theNetwork = Network::GetInstance();
 
+	m_networkThread.ShutDown();
 	theNetwork.ShutDown();
 }
 
@@ -70,45 +114,193 @@ void Server::Update()
 {
 	Clock& appClock = Clock::GetMasterClock();
 
+	Update( static_cast< float >( appClock.m_currentDeltaSeconds ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Shards run on their own threads and cannot read the master clock, so they pass in their own delta
+void Server::Update( float deltaSeconds )
+{
+	AdoptClientsHandedOffFromOtherShards();
 	ReceiveMessagesFromClientsIfAny();
-	RemoveInactiveClients();
-	ResendAnyGuaranteedPacketsThatHaveTimedOut();
-	SendUpdatePacketsToAllClients();
+	ProcessPacketsForwardedFromOtherShards();
+	ProcessExpiredTimers();
+	RefreshLobbyIfSharedGamesChanged();
 
-	g_currentSendElapsedTime += static_cast< float >( appClock.m_currentDeltaSeconds );
+	m_currentSendElapsedTime += deltaSeconds;
+
+	if( m_currentSendElapsedTime >= SEND_DELAY )
+	{
+		SendUpdatePacketsToAllClients();
+		m_currentSendElapsedTime = 0.f;
+	}
+
+	SendQueuedPacketsToClients();
+
+	Network::GetInstance().ReleaseReceivedDatagrams( m_listenConnectionID );
+	m_networkThread.ReleaseReceivedDatagrams( m_numQueuedDatagramsThisFrame );
+	m_numQueuedDatagramsThisFrame = 0;
 }
 
 
 //-----------------------------------------------------------------------------------------------
 void Server::Render() const
 {
+	m_numClientListChangesRendered = m_numClientListChanges;
+
 	RenderConnectedClients();
 }
 
 
+//-----------------------------------------------------------------------------------------------
+//The client list is all there is to draw
+bool Server::HasChangedSinceLastRender() const
+{
+	return m_numClientListChanges != m_numClientListChangesRendered;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Server::WaitForClientMessagesOrNextScheduledEvent( double maxSecondsToWait )
+{
+	Network& theNetwork = Network::GetInstance();
+
+	double secondsToWait = GetSecondsUntilNextScheduledEvent();
+
+	if( secondsToWait > maxSecondsToWait )
+	{
+		secondsToWait = maxSecondsToWait;
+	}
+
+	if( m_networkThread.IsRunning() )
+	{
+		m_networkThread.WaitForReceivedDatagrams( secondsToWait );
+		return;
+	}
+
+	theNetwork.WaitForIncomingData( m_listenConnectionID, secondsToWait );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Call before StartUp. The shard then shares its listen port and lists every shard's games.
+void Server::AttachToSharedLobby( SharedLobby* sharedLobby, int shardIndex )
+{
+	m_sharedLobby = sharedLobby;
+	m_shardIndex = shardIndex;
+}
+
+
 //-----------------------------------------------------------------------------------------------
 //Private Methods
 //-----------------------------------------------------------------------------------------------
 void Server::ReceiveMessagesFromClientsIfAny()
 {
+	if( m_networkThread.IsRunning() )
+	{
+		ReceiveMessagesFromNetworkThread();
+		return;
+	}
+
 	Network& theNetwork = Network::GetInstance();
 
-	int bytesReceived = 0;
-	CS6Packet receivedPacket;
+	ReceivedDatagram* receivedDatagrams = nullptr;
+	int numDatagramsReceived = 0;
 
-	do 
+	//packets are read straight out of the network's receive ring, which is released at the end of Update
+	while( ( numDatagramsReceived = theNetwork.ReceiveUDPMessagesInPlace( m_listenConnectionID, receivedDatagrams ) ) > 0 )
 	{
-		bytesReceived = 0;
-		ZeroMemory( &receivedPacket, sizeof( receivedPacket ) );
+		for( int i = 0; i < numDatagramsReceived; ++i )
+		{
+			OnReceiveDatagram( receivedDatagrams[ i ].buffer, receivedDatagrams[ i ].bytesReceived, receivedDatagrams[ i ].sourceAddress, receivedDatagrams[ i ].arrivalTimeSeconds );
+		}
+	}
+}
 
-		bytesReceived = theNetwork.ReceiveUDPMessage( ( char* )&receivedPacket, sizeof( receivedPacket ), m_listenConnectionID );
 
-		if( bytesReceived == sizeof( CS6Packet ) )
+//-----------------------------------------------------------------------------------------------
+//Reads what the network thread had queued when the frame started, the slots are released at the end of Update
+void Server::ReceiveMessagesFromNetworkThread()
+{
+	m_numQueuedDatagramsThisFrame = m_networkThread.GetNumReceivedDatagrams();
+
+	for( int i = 0; i < m_numQueuedDatagramsThisFrame; ++i )
+	{
+		const QueuedDatagram* datagram = m_networkThread.GetReceivedDatagram( i );
+
+		OnReceiveDatagram( datagram->data, datagram->numBytes, datagram->address, datagram->arrivalTimeSeconds );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Clients may pack several packets into one datagram, back to back. Anything that is not a whole
+//number of packets is counted and dropped.
+void Server::OnReceiveDatagram( const char* buffer, int numBytes, const PeerAddress& sourceAddress, double arrivalTimeSeconds )
+{
+	m_currentPacketSourceAddress = sourceAddress;
+	m_currentPacketArrivalTimeSeconds = arrivalTimeSeconds;
+
+	if( numBytes == 0 || numBytes % sizeof( CS6Packet ) != 0 )
+	{
+		RecordPacketReceivedFromCurrentSource( numBytes );
+		return;
+	}
+
+	bool wasDatagramRecorded = false;
+
+	for( int packetOffset = 0; packetOffset < numBytes; packetOffset += sizeof( CS6Packet ) )
+	{
+		const CS6Packet& receivedPacket = *( const CS6Packet* )( buffer + packetOffset );
+
+		if( ForwardPacketIfOwnedByAnotherShard( receivedPacket ) )
 		{
-			ProcessPacket( receivedPacket );
+			continue;
 		}
-	} 
-	while ( bytesReceived > 0 );
+
+		//once per datagram, by the first packet this shard keeps
+		if( !wasDatagramRecorded )
+		{
+			RecordPacketReceivedFromCurrentSource( numBytes );
+			wasDatagramRecorded = true;
+		}
+
+		ProcessPacket( receivedPacket );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Packets from addresses that are not clients yet go uncounted, there is nowhere to count them
+void Server::RecordPacketReceivedFromCurrentSource( int numBytes )
+{
+	ConnectedClient* sourceClient = FindConnectedClient( m_currentPacketSourceAddress );
+
+	if( sourceClient != nullptr )
+	{
+		sourceClient->connectionStats.RecordPacketReceived( numBytes );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ConnectedClient* Server::FindConnectedClient( const PeerAddress& clientAddress )
+{
+	if( !clientAddress.IsValid() )
+	{
+		return nullptr;
+	}
+
+	for( auto iter = m_connectedAndActiveClients.begin(); iter != m_connectedAndActiveClients.end(); ++iter )
+	{
+		if( iter->second != nullptr && iter->second->peerAddress == clientAddress )
+		{
+			return iter->second;
+		}
+	}
+
+	return nullptr;
 }
 
 
@@ -117,6 +309,9 @@ void Server::ProcessPacket( const CS6Packet& packet )
 {
 	PacketType typeOfPacket = packet.packetType;
 
+	//whatever the packet is, its header acks go first
+	OnReceivePiggybackedAcks( packet );
+
 	if( typeOfPacket == TYPE_Update )
 	{
 		OnReceiveUpdatePacket( packet );
@@ -151,6 +346,175 @@ void Server::ProcessPacket( const CS6Packet& packet )
 }
 
 
+//-----------------------------------------------------------------------------------------------
+//The kernel picks a shard by hashing the client's address, so once a client joins a game on
+//another shard its packets still land here and have to be passed along
+bool Server::ForwardPacketIfOwnedByAnotherShard( const CS6Packet& packet )
+{
+	if( m_sharedLobby == nullptr )
+	{
+		return false;
+	}
+
+	for( auto iter = m_connectedAndActiveClients.begin(); iter != m_connectedAndActiveClients.end(); ++iter )
+	{
+		if( iter->second != nullptr && iter->second->peerAddress == m_currentPacketSourceAddress )
+		{
+			return false;
+		}
+	}
+
+	int owningShardIndex = m_sharedLobby->GetShardIndexOwningClient( m_currentPacketSourceAddress );
+
+	if( owningShardIndex == SharedLobby::NO_SHARD || owningShardIndex == m_shardIndex )
+	{
+		return false;
+	}
+
+	m_sharedLobby->ForwardPacketToShard( owningShardIndex, m_currentPacketSourceAddress, packet );
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Server::ProcessPacketsForwardedFromOtherShards()
+{
+	if( m_sharedLobby == nullptr )
+	{
+		return;
+	}
+
+	m_sharedLobby->TakeForwardedPackets( m_shardIndex, m_forwardedPackets );
+
+	for( int i = 0; i < static_cast< int >( m_forwardedPackets.size() ); ++i )
+	{
+		m_currentPacketSourceAddress = m_forwardedPackets[ i ].sourceAddress;
+		m_currentPacketArrivalTimeSeconds = Time::GetCurrentTimeInSeconds();
+
+		RecordPacketReceivedFromCurrentSource( sizeof( CS6Packet ) );
+		ProcessPacket( m_forwardedPackets[ i ].packet );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Server::AdoptClientsHandedOffFromOtherShards()
+{
+	if( m_sharedLobby == nullptr )
+	{
+		return;
+	}
+
+	m_sharedLobby->TakeClientHandoffs( m_shardIndex, m_clientHandoffs );
+
+	for( int i = 0; i < static_cast< int >( m_clientHandoffs.size() ); ++i )
+	{
+		const ClientHandoff& handoff = m_clientHandoffs[ i ];
+
+		ConnectedClient* adoptedClient = new ConnectedClient( handoff.client );
+
+		AddConnectedClient( adoptedClient );
+
+		//the client's reliable packets came along unacked, their resends are this shard's now
+		ReliableSendWindow< CS6Packet >& adoptedPackets = adoptedClient->m_reliablePacketsAwaitingAckBack;
+		uint endNumber = adoptedPackets.GetEndSequenceNumber();
+
+		for( uint number = adoptedPackets.GetOldestSequenceNumber(); number != endNumber; ++number )
+		{
+			ReliableSendWindow< CS6Packet >::InFlightMessage* inFlightPacket = adoptedPackets.Find( number );
+
+			if( inFlightPacket != nullptr )
+			{
+				m_timerWheel.Schedule( inFlightPacket->resendTimeSeconds, TIMER_RESEND_RELIABLE_PACKET, adoptedClient->connectionID, number );
+			}
+		}
+
+		auto foundIter = m_gamesAndTheirClients.find( handoff.gameIDToJoin );
+
+		//game closed while the client was on its way over
+		if( foundIter == m_gamesAndTheirClients.end() )
+		{
+			PutNewClientInLobbyAndSendListOfCurrentGames( *adoptedClient );
+			continue;
+		}
+
+		foundIter->second.push_back( adoptedClient->connectionID );
+		adoptedClient->gameID = handoff.gameIDToJoin;
+
+		SendAGameStartPacketToNewClient( *adoptedClient );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Client must already be out of the lobby. It is deleted here, the other shard takes it from the handoff.
+void Server::HandOffClientToShard( ConnectionID clientID, GameID gameIDToJoin, int shardIndex )
+{
+	auto foundIter = m_connectedAndActiveClients.find( clientID );
+
+	if( foundIter == m_connectedAndActiveClients.end() || foundIter->second == nullptr )
+	{
+		return;
+	}
+
+	ClientHandoff handoff;
+
+	handoff.client = *foundIter->second;
+	handoff.gameIDToJoin = gameIDToJoin;
+
+	m_sharedLobby->HandOffClientToShard( shardIndex, handoff );
+
+	delete foundIter->second;
+	m_connectedAndActiveClients.erase( foundIter );
+	++m_numClientListChanges;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Games come and go on every shard, so each shard re-sends the list to its own lobby when it changes
+void Server::RefreshLobbyIfSharedGamesChanged()
+{
+	if( m_sharedLobby == nullptr )
+	{
+		return;
+	}
+
+	uint lobbyVersion = m_sharedLobby->GetVersion();
+
+	if( lobbyVersion == m_lastSeenLobbyVersion )
+	{
+		return;
+	}
+
+	m_lastSeenLobbyVersion = lobbyVersion;
+
+	SendListOfCurrentGamesToLobby();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Server::SendListOfCurrentGamesToLobby()
+{
+	auto lobbyIter = m_gamesAndTheirClients.find( LOBBY_ID );
+
+	if( lobbyIter == m_gamesAndTheirClients.end() )
+	{
+		return;
+	}
+
+	for( auto iter = lobbyIter->second.begin(); iter != lobbyIter->second.end(); ++iter )
+	{
+		auto clientIter = m_connectedAndActiveClients.find( *iter );
+
+		if( clientIter != m_connectedAndActiveClients.end() && clientIter->second != nullptr )
+		{
+			SendListOfCurrentGamesToClient( *clientIter->second );
+		}
+	}
+}
+
+
 //-----------------------------------------------------------------------------------------------
 void Server::OnReceiveUpdatePacket( const CS6Packet& packet )
 {
@@ -165,21 +529,11 @@ void Server::OnReceiveVictoryPacket( const CS6Packet& packet )
 	//reset flag position
 	//send resets to all clients
 
-	std::string ipAddressOfClient = "";
-	std::string portAsString = "";
-
-	Network& theNetwork = Network::GetInstance();
-
-	ipAddressOfClient = theNetwork.GetIPAddressAsStringFromConnection( m_listenConnectionID );
-	portAsString = theNetwork.GetPortAsStringFromConnection( m_listenConnectionID );
-
-	if( ipAddressOfClient == "" || portAsString == "" )
+	if( !m_currentPacketSourceAddress.IsValid() )
 	{
 		return;
 	}
 
-	std::string idOfClient = portAsString + ipAddressOfClient;
-
 	auto foundIter = m_connectedAndActiveClients.begin();
 
 	for( ; foundIter != m_connectedAndActiveClients.end(); ++foundIter )
@@ -189,7 +543,7 @@ void Server::OnReceiveVictoryPacket( const CS6Packet& packet )
 			continue;
 		}
 
-		if( foundIter->second->clientID == idOfClient )
+		if( foundIter->second->peerAddress == m_currentPacketSourceAddress )
 		{
 			break;
 		}
@@ -224,21 +578,11 @@ void Server::OnReceiveVictoryPacket( const CS6Packet& packet )
 //-----------------------------------------------------------------------------------------------
 void Server::OnReceiveHostGamePacket( const CS6Packet& packet )
 {
-	std::string ipAddressOfClient = "";
-	std::string portAsString = "";
-
-	Network& theNetwork = Network::GetInstance();
-
-	ipAddressOfClient = theNetwork.GetIPAddressAsStringFromConnection( m_listenConnectionID );
-	portAsString = theNetwork.GetPortAsStringFromConnection( m_listenConnectionID );
-
-	if( ipAddressOfClient == "" || portAsString == "" )
+	if( !m_currentPacketSourceAddress.IsValid() )
 	{
 		return;
 	}
 
-	std::string idOfClient = portAsString + ipAddressOfClient;
-
 	auto foundIter = m_connectedAndActiveClients.begin();
 
 	for( ; foundIter != m_connectedAndActiveClients.end(); ++foundIter )
@@ -248,7 +592,7 @@ void Server::OnReceiveHostGamePacket( const CS6Packet& packet )
 			continue;
 		}
 
-		if( foundIter->second->clientID == idOfClient )
+		if( foundIter->second->peerAddress == m_currentPacketSourceAddress )
 		{
 			break;
 		}
@@ -261,11 +605,11 @@ void Server::OnReceiveHostGamePacket( const CS6Packet& packet )
 
 	if( foundIter->second != nullptr )
 	{
-		++Server::s_currentMaxGameID;
+		GameID newGameID = CreateNewGameID();
 
-		foundIter->second->gameID = Server::s_currentMaxGameID;
+		foundIter->second->gameID = newGameID;
 		RemoveClientFromRoom( LOBBY_ID, *foundIter->second );
-		m_gamesAndTheirClients[ Server::s_currentMaxGameID ].push_back( foundIter->second->connectionID );
+		m_gamesAndTheirClients[ newGameID ].push_back( foundIter->second->connectionID );
 
 		SendAGameStartPacketToNewClient( *foundIter->second );
 	}
@@ -276,21 +620,11 @@ void Server::OnReceiveHostGamePacket( const CS6Packet& packet )
 void Server::OnReceiveJoinGamePacket( const CS6Packet& packet )
 {
 
-	std::string ipAddressOfClient = "";
-	std::string portAsString = "";
-
-	Network& theNetwork = Network::GetInstance();
-
-	ipAddressOfClient = theNetwork.GetIPAddressAsStringFromConnection( m_listenConnectionID );
-	portAsString = theNetwork.GetPortAsStringFromConnection( m_listenConnectionID );
-
-	if( ipAddressOfClient == "" || portAsString == "" )
+	if( !m_currentPacketSourceAddress.IsValid() )
 	{
 		return;
 	}
 
-	std::string idOfClient = portAsString + ipAddressOfClient;
-
 	auto foundIter = m_connectedAndActiveClients.begin();
 
 	for( ; foundIter != m_connectedAndActiveClients.end(); ++foundIter )
@@ -300,7 +634,7 @@ void Server::OnReceiveJoinGamePacket( const CS6Packet& packet )
 			continue;
 		}
 
-		if( foundIter->second->clientID == idOfClient )
+		if( foundIter->second->peerAddress == m_currentPacketSourceAddress )
 		{
 			break;
 		}
@@ -313,17 +647,37 @@ void Server::OnReceiveJoinGamePacket( const CS6Packet& packet )
 
 	if( foundIter->second != nullptr )
 	{
+		ConnectedClient& joiningClient = *foundIter->second;
 		GameID gameIDToJoin = packet.data.joinGame.gameID;
 
-		RemoveClientFromRoom( LOBBY_ID, *foundIter->second );
-
-		if( m_gamesAndTheirClients.size() > gameIDToJoin )
+		if( m_sharedLobby != nullptr )
 		{
-			m_gamesAndTheirClients[ gameIDToJoin ].push_back( foundIter->second->connectionID );
-			foundIter->second->gameID = gameIDToJoin;
+			int owningShardIndex = m_sharedLobby->GetShardIndexOwningGame( gameIDToJoin );
+
+			if( owningShardIndex != SharedLobby::NO_SHARD && owningShardIndex != m_shardIndex )
+			{
+				RemoveClientFromRoom( LOBBY_ID, joiningClient );
+				HandOffClientToShard( foundIter->first, gameIDToJoin, owningShardIndex );
+				return;
+			}
+		}
 
-			SendAGameStartPacketToNewClient( *foundIter->second );
+		//game IDs are handed out by the shared lobby when sharded, so they are looked up rather than indexed
+		auto gameIter = m_gamesAndTheirClients.find( gameIDToJoin );
+
+		//a game that closed before the join got here, the client stays in the lobby with a fresh list
+		if( gameIDToJoin == LOBBY_ID || gameIter == m_gamesAndTheirClients.end() )
+		{
+			SendListOfCurrentGamesToClient( joiningClient );
+			return;
 		}
+
+		RemoveClientFromRoom( LOBBY_ID, joiningClient );
+
+		gameIter->second.push_back( joiningClient.connectionID );
+		joiningClient.gameID = gameIDToJoin;
+
+		SendAGameStartPacketToNewClient( joiningClient );
 	}
 }
 
@@ -336,7 +690,7 @@ void Server::OnReceiveAckPacket( const CS6Packet& packet )
 	{
 		OnAckAcknowledge( packet );
 	}
-	else if( typeOfAck == TYPE_GameStart  || typeOfAck == TYPE_Reset || typeOfAck == TYPE_LobbyStart || typeOfAck == TYPE_HostGame || typeOfAck == TYPE_JoinGame )
+	else if( typeOfAck == TYPE_GameStart  || typeOfAck == TYPE_Reset || typeOfAck == TYPE_LobbyStart || typeOfAck == TYPE_HostGame || typeOfAck == TYPE_JoinGame || typeOfAck == TYPE_Fragment )
 	{
 		OnAckReliablePacket( packet );
 	}
@@ -353,120 +707,277 @@ void Server::OnAckAcknowledge( const CS6Packet& packet )
 //-----------------------------------------------------------------------------------------------
 void Server::OnAckReliablePacket( const CS6Packet& packet )
 {
-	std::string ipAddressOfClient = "";
-	std::string portAsString = "";
+	ConnectedClient* ackingClient = FindConnectedClient( m_currentPacketSourceAddress );
 
-	Network& theNetwork = Network::GetInstance();
+	if( ackingClient != nullptr )
+	{
+		AckReliablePacket( *ackingClient, packet.data.acknowledged.packetNumber );
+	}
+}
 
-	ipAddressOfClient = theNetwork.GetIPAddressAsStringFromConnection( m_listenConnectionID );
-	portAsString = theNetwork.GetPortAsStringFromConnection( m_listenConnectionID );
 
-	if( ipAddressOfClient == "" || portAsString == "" )
+//-----------------------------------------------------------------------------------------------
+//Clients ack the newest reliable packet they have and a history of the ones before it on every
+//packet, so a lost ack packet is made up for by whatever the client sends next
+void Server::OnReceivePiggybackedAcks( const CS6Packet& packet )
+{
+	if( packet.ackedReliableNumber == 0 )
 	{
 		return;
 	}
 
-	std::string idOfClient = portAsString + ipAddressOfClient;
+	ConnectedClient* ackingClient = FindConnectedClient( m_currentPacketSourceAddress );
 
-	auto foundIter = m_connectedAndActiveClients.begin();
+	if( ackingClient == nullptr || ackingClient->m_reliablePacketsAwaitingAckBack.GetNumInFlight() == 0 )
+	{
+		return;
+	}
 
-	for( ; foundIter != m_connectedAndActiveClients.end(); ++foundIter )
+	AckReliablePacket( *ackingClient, packet.ackedReliableNumber );
+
+	for( int i = 0; i < NUM_ACKED_RELIABLE_BITS && static_cast< uint >( i + 1 ) < packet.ackedReliableNumber; ++i )
 	{
-		if( foundIter->second == nullptr )
+		if( ( packet.ackedReliableBits & ( 1u << i ) ) != 0 )
 		{
-			continue;
+			AckReliablePacket( *ackingClient, packet.ackedReliableNumber - 1 - i );
 		}
+	}
+}
 
-		if( foundIter->second->clientID == idOfClient )
+
+//-----------------------------------------------------------------------------------------------
+//The same packet is acked over and over by the histories, only the first one counts
+void Server::AckReliablePacket( ConnectedClient& ackingClient, uint ackedPacketNumber )
+{
+	if( ackingClient.m_reliablePacketsAwaitingAckBack.Find( ackedPacketNumber ) == nullptr )
+	{
+		return;
+	}
+
+	ackingClient.connectionStats.RecordReliablePacketAcked( ackedPacketNumber, m_currentPacketArrivalTimeSeconds );
+	ackingClient.m_reliablePacketsAwaitingAckBack.Remove( ackedPacketNumber );
+
+	SendReliablePacketsWaitingForRoom( ackingClient );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Resends and inactivity all sit on the timer wheel, so only the update send needs looking at here
+double Server::GetSecondsUntilNextScheduledEvent() const
+{
+	double currentTime = Time::GetCurrentTimeInSeconds();
+	double secondsUntilNextEvent = MAX_SECONDS_OF_INACTIVITY;
+	double nextTimerFireTime = 0.0;
+
+	if( m_timerWheel.GetEarliestFireTime( nextTimerFireTime ) && nextTimerFireTime - currentTime < secondsUntilNextEvent )
+	{
+		secondsUntilNextEvent = nextTimerFireTime - currentTime;
+	}
+
+	//updates only go out to clients in a game
+	for( auto iter = m_gamesAndTheirClients.begin(); iter != m_gamesAndTheirClients.end(); ++iter )
+	{
+		if( iter->first != LOBBY_ID && !iter->second.empty() )
 		{
+			double secondsUntilNextUpdateSend = SEND_DELAY - m_currentSendElapsedTime;
+
+			if( secondsUntilNextUpdateSend < secondsUntilNextEvent )
+			{
+				secondsUntilNextEvent = secondsUntilNextUpdateSend;
+			}
+
 			break;
 		}
 	}
 
-	if( foundIter != m_connectedAndActiveClients.end() )
+	if( secondsUntilNextEvent < 0.0 )
+	{
+		secondsUntilNextEvent = 0.0;
+	}
+
+	return secondsUntilNextEvent;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Timers are never cancelled. Acks, refreshes and removals just leave them to find nothing to do.
+void Server::ProcessExpiredTimers()
+{
+	double currentTime = Time::GetCurrentTimeInSeconds();
+
+	m_expiredTimers.clear();
+	m_timerWheel.CollectExpiredTimers( currentTime, m_expiredTimers );
+
+	for( int i = 0; i < static_cast< int >( m_expiredTimers.size() ); ++i )
+	{
+		const ScheduledTimer& timer = m_expiredTimers[ i ];
+
+		if( timer.timerType == TIMER_RESEND_RELIABLE_PACKET )
+		{
+			OnReliablePacketResendTimerExpired( timer, currentTime );
+		}
+		else if( timer.timerType == TIMER_CLIENT_INACTIVITY )
+		{
+			OnClientInactivityTimerExpired( timer, currentTime );
+		}
+		else if( timer.timerType == TIMER_STALLED_CLIENT )
+		{
+			OnStalledClientTimerExpired( timer );
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Each resend waits twice as long as the one before, starting from the client's measured round trip
+void Server::OnReliablePacketResendTimerExpired( const ScheduledTimer& timer, double currentTimeSeconds )
+{
+	auto clientIter = m_connectedAndActiveClients.find( timer.ownerID );
+
+	if( clientIter == m_connectedAndActiveClients.end() || clientIter->second == nullptr )
+	{
+		return;
+	}
+
+	ConnectedClient& client = *clientIter->second;
+	ReliableSendWindow< CS6Packet >::InFlightMessage* inFlightPacket = client.m_reliablePacketsAwaitingAckBack.Find( timer.key );
+
+	//acked since it was scheduled
+	if( inFlightPacket == nullptr )
 	{
-		foundIter->second->m_reliablePacketsAwaitingAckBack.erase( packet.data.acknowledged.packetNumber );
+		return;
 	}
+
+	if( currentTimeSeconds >= inFlightPacket->resendTimeSeconds )
+	{
+		CS6Packet& packetToSend = inFlightPacket->message;
+
+		++inFlightPacket->numTimesResent;
+		inFlightPacket->resendTimeSeconds = currentTimeSeconds + client.connectionStats.GetRetransmitTimeoutSeconds( inFlightPacket->numTimesResent );
+		packetToSend.timestamp = currentTimeSeconds;
+
+		client.connectionStats.RecordReliablePacketResent( packetToSend.packetNumber );
+		QueuePacketForClient( packetToSend, client );
+	}
+
+	m_timerWheel.Schedule( inFlightPacket->resendTimeSeconds, TIMER_RESEND_RELIABLE_PACKET, timer.ownerID, timer.key );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Hearing from a client only moves its last received time, the timer finds out here and goes again
+void Server::OnClientInactivityTimerExpired( const ScheduledTimer& timer, double currentTimeSeconds )
+{
+	auto clientIter = m_connectedAndActiveClients.find( timer.ownerID );
+
+	//handed off or already gone
+	if( clientIter == m_connectedAndActiveClients.end() || clientIter->second == nullptr )
+	{
+		return;
+	}
+
+	double inactiveTime = clientIter->second->lastReceivedMessageTimeSeconds + MAX_SECONDS_OF_INACTIVITY;
+
+	if( currentTimeSeconds >= inactiveTime )
+	{
+		RemoveClient( timer.ownerID );
+		return;
+	}
+
+	m_timerWheel.Schedule( inactiveTime, TIMER_CLIENT_INACTIVITY, timer.ownerID, 0 );
 }
 
+
 //-----------------------------------------------------------------------------------------------
-void Server::RemoveInactiveClients()
+//Acks that came in since it was scheduled may have drained enough to keep the client
+void Server::OnStalledClientTimerExpired( const ScheduledTimer& timer )
 {
-	Clock& appClock = Clock::GetMasterClock();
-	float deltaSeconds = static_cast< float >( appClock.m_currentDeltaSeconds );
+	auto clientIter = m_connectedAndActiveClients.find( timer.ownerID );
 
-	for( int i = 0; i < static_cast< int >( m_connectedAndActiveClients.size() ); ++ i )
+	if( clientIter == m_connectedAndActiveClients.end() || clientIter->second == nullptr )
 	{
-		if( m_connectedAndActiveClients[ i ] == nullptr )
-		{
-			continue;
-		}
-
-		m_connectedAndActiveClients[ i ]->timeSinceLastReceivedMessage += deltaSeconds;
-
-		if( m_connectedAndActiveClients[ i ]->timeSinceLastReceivedMessage >= MAX_SECONDS_OF_INACTIVITY )
-		{
-			RemoveClientFromRoom( m_connectedAndActiveClients[ i ]->gameID, *m_connectedAndActiveClients[ i ] );
+		return;
+	}
 
-			delete m_connectedAndActiveClients[ i ];
-			m_connectedAndActiveClients[ i ] = nullptr;
-		}
+	if( static_cast< int >( clientIter->second->m_reliablePacketsWaitingForRoom.size() ) > MAX_RELIABLE_PACKETS_WAITING_FOR_ROOM )
+	{
+		RemoveClient( timer.ownerID );
 	}
 }
 
 
 //-----------------------------------------------------------------------------------------------
-void Server::ResendAnyGuaranteedPacketsThatHaveTimedOut()
+void Server::RemoveClient( ConnectionID clientID )
 {
-	Network& theNetwork = Network::GetInstance();
-
-	float currentTime = Time::GetCurrentTimeInSeconds();
+	auto clientIter = m_connectedAndActiveClients.find( clientID );
 
-	for( auto iter = m_connectedAndActiveClients.begin(); iter != m_connectedAndActiveClients.end(); ++iter )
+	if( clientIter == m_connectedAndActiveClients.end() || clientIter->second == nullptr )
 	{
-		if( iter->second == nullptr )
-		{
-			continue;
-		}
-
-		for( auto guaranteedPacketIter = iter->second->m_reliablePacketsAwaitingAckBack.begin(); guaranteedPacketIter != iter->second->m_reliablePacketsAwaitingAckBack.end(); ++ guaranteedPacketIter )
-		{
-			if( currentTime - guaranteedPacketIter->second.timestamp > RESEND_RELIABLE_PACKET_TIME )
-			{
-				CS6Packet& packetToSend = guaranteedPacketIter->second;
+		return;
+	}
 
-				packetToSend.timestamp = Time::GetCurrentTimeInSeconds();
+	ConnectedClient* clientToRemove = clientIter->second;
 
-				theNetwork.SetIPAddressAsStringForConnection( m_listenConnectionID, iter->second->ipAddressAsString );
-				theNetwork.SetPortAsStringForConnection( m_listenConnectionID,iter->second->portAsString );
+	RemoveClientFromRoom( clientToRemove->gameID, *clientToRemove );
 
-				theNetwork.SendUDPMessage( ( char* )&packetToSend, sizeof( packetToSend ), m_listenConnectionID );
-			}
-		}
+	if( m_sharedLobby != nullptr )
+	{
+		m_sharedLobby->RemoveClient( clientToRemove->peerAddress, m_shardIndex );
 	}
+
+	delete clientToRemove;
+	m_connectedAndActiveClients.erase( clientIter );
+	++m_numClientListChanges;
 }
 
 
 //-----------------------------------------------------------------------------------------------
+//Each client in a game gets the whole room's updates, or none this time if its link is already
+//carrying all its pacer allows. A skipped round is not made up, the next one supersedes it, so a
+//slow link gets fewer updates instead of older ones.
 void Server::SendUpdatePacketsToAllClients()
 {
+	double currentTime = Time::GetCurrentTimeInSeconds();
 	CS6Packet updatePacket;
 
 	updatePacket.packetType = TYPE_Update;
 
 	for( auto iter = m_connectedAndActiveClients.begin(); iter != m_connectedAndActiveClients.end(); ++iter )
 	{
-		if( iter->second == nullptr )
+		if( iter->second == nullptr || iter->second->gameID == LOBBY_ID )
 		{
 			continue;
 		}
-		updatePacket.data.updated = iter->second->mostRecentUpdateInfo;
-		memcpy( &updatePacket.playerColorAndID, &iter->second->playerIDAsRGB, sizeof( updatePacket.playerColorAndID ) );
 
-		if( iter->second->gameID != LOBBY_ID )
+		ConnectedClient& clientToSendTo = *iter->second;
+		auto roomIter = m_gamesAndTheirClients.find( clientToSendTo.gameID );
+
+		if( roomIter == m_gamesAndTheirClients.end() )
 		{
-			BroadCastMessageToAllClientsInRoom( iter->second->gameID, updatePacket, sizeof( updatePacket ) );
-		}	
+			continue;
+		}
+
+		clientToSendTo.sendPacer.Update( clientToSendTo.connectionStats, currentTime );
+
+		if( !clientToSendTo.sendPacer.CanSend() )
+		{
+			clientToSendTo.sendPacer.RecordSendSkipped();
+			continue;
+		}
+
+		for( auto playerIter = roomIter->second.begin(); playerIter != roomIter->second.end(); ++playerIter )
+		{
+			auto playerInMap = m_connectedAndActiveClients.find( *playerIter );
+
+			if( playerInMap == m_connectedAndActiveClients.end() || playerInMap->second == nullptr )
+			{
+				continue;
+			}
+
+			updatePacket.data.updated = playerInMap->second->mostRecentUpdateInfo;
+			memcpy( &updatePacket.playerColorAndID, &playerInMap->second->playerIDAsRGB, sizeof( updatePacket.playerColorAndID ) );
+
+			SendMessageToClient( updatePacket, clientToSendTo );
+		}
 	}
 }
 
@@ -537,81 +1048,290 @@ void Server::SendAGameStartPacketToNewClient( ConnectedClient& clientToSendTo )
 //-----------------------------------------------------------------------------------------------
 void Server::PutNewClientInLobbyAndSendListOfCurrentGames( ConnectedClient& clientToSendTo )
 {
-	CS6Packet lobbyPacket;
-
 	m_gamesAndTheirClients[ LOBBY_ID ].push_back( clientToSendTo.connectionID );
 	clientToSendTo.gameID = LOBBY_ID;
 
+	SendListOfCurrentGamesToClient( clientToSendTo );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//The whole list goes as one message, a game count and then the IDs, so the client gets all of it or
+//none of it. Lists too long for one message are cut short.
+void Server::SendListOfCurrentGamesToClient( ConnectedClient& clientToSendTo )
+{
+	CS6Packet lobbyPacket;
+
+	ZeroMemory( &lobbyPacket, sizeof( lobbyPacket ) );
+
 	lobbyPacket.packetType = TYPE_Acknowledge;
 	lobbyPacket.data.acknowledged.packetType = TYPE_LobbyStart;
 
 	SendMessageToClient( lobbyPacket, clientToSendTo );
 
-	auto iter = m_gamesAndTheirClients.begin();
+	GetCurrentGameIDs( m_currentGameIDs );
+
+	const int maxGamesInList = static_cast< int >( ( MAX_FRAGMENTED_MESSAGE_BYTES - sizeof( MessageType ) - sizeof( unsigned int ) ) / sizeof( GameID ) );
+	unsigned int numGamesInList = static_cast< unsigned int >( m_currentGameIDs.size() );
 
-	for( ; iter != m_gamesAndTheirClients.end(); ++iter )
+	if( numGamesInList > static_cast< unsigned int >( maxGamesInList ) )
 	{
-		if( iter->first == LOBBY_ID )
-		{
-			continue;
-		}
+		numGamesInList = maxGamesInList;
+	}
 
-		ZeroMemory( &lobbyPacket, sizeof( lobbyPacket ) );
+	m_gameListMessage.resize( sizeof( MessageType ) + sizeof( numGamesInList ) + numGamesInList * sizeof( GameID ) );
+	m_gameListMessage[ 0 ] = MESSAGE_GameList;
 
-		lobbyPacket.packetType = TYPE_LobbyStart;
-		lobbyPacket.data.lobbyStart.m_gameID = iter->first;
+	memcpy( &m_gameListMessage[ sizeof( MessageType ) ], &numGamesInList, sizeof( numGamesInList ) );
 
-		SendMessageToClient( lobbyPacket, clientToSendTo );
+	if( numGamesInList > 0 )
+	{
+		memcpy( &m_gameListMessage[ sizeof( MessageType ) + sizeof( numGamesInList ) ], &m_currentGameIDs[ 0 ], numGamesInList * sizeof( GameID ) );
 	}
+
+	SendFragmentedMessageToClient( m_gameListMessage, clientToSendTo );
 }
 
 
 //-----------------------------------------------------------------------------------------------
 void Server::SendMessageToClient( const CS6Packet& messageAsPacket, ConnectedClient& clientToSendTo )
 {
-	Network& theNetwork = Network::GetInstance();
-
 	CS6Packet packetToSend = messageAsPacket;
 
+	//clients keep nothing to resend, so there is nothing to ack back to them
+	packetToSend.ackedReliableNumber = 0;
+	packetToSend.ackedReliableBits = 0;
+
 	if( messageAsPacket.IsReliablePacket() )
 	{
-		++clientToSendTo.numReliableMessagesSent;
-		packetToSend.packetNumber = clientToSendTo.numReliableMessagesSent;
+		SendReliablePacketWhenThereIsRoom( packetToSend, clientToSendTo );
+		return;
+	}
+
+	packetToSend.timestamp = Time::GetCurrentTimeInSeconds();
+
+	++clientToSendTo.numUnreliableMessagesSent;
+	packetToSend.packetNumber = clientToSendTo.numUnreliableMessagesSent;
 
-		clientToSendTo.m_reliablePacketsAwaitingAckBack[ packetToSend.packetNumber ] = packetToSend; 
+	QueuePacketForClient( packetToSend, clientToSendTo );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//A reliable packet is only numbered once the window has a slot for it. One numbered and never kept
+//would leave a gap the client waits on forever. A client that lets a second window's worth back up
+//is dropped from the timer wheel, as the caller may be walking the client list.
+void Server::SendReliablePacketWhenThereIsRoom( const CS6Packet& packetToSend, ConnectedClient& clientToSendTo )
+{
+	std::deque< CS6Packet >& waitingPackets = clientToSendTo.m_reliablePacketsWaitingForRoom;
+
+	if( waitingPackets.empty() && clientToSendTo.m_reliablePacketsAwaitingAckBack.HasRoomFor( clientToSendTo.numReliableMessagesSent + 1 ) )
+	{
+		SendReliablePacketNow( packetToSend, clientToSendTo );
+		return;
 	}
-	else
+
+	waitingPackets.push_back( packetToSend );
+
+	if( static_cast< int >( waitingPackets.size() ) == MAX_RELIABLE_PACKETS_WAITING_FOR_ROOM + 1 )
 	{
-		++clientToSendTo.numUnreliableMessagesSent;
-		packetToSend.packetNumber = clientToSendTo.numUnreliableMessagesSent;
+		m_timerWheel.Schedule( Time::GetCurrentTimeInSeconds(), TIMER_STALLED_CLIENT, clientToSendTo.connectionID, 0 );
 	}
+}
 
-	packetToSend.timestamp = Time::GetCurrentTimeInSeconds();
 
-	theNetwork.SetIPAddressAsStringForConnection( m_listenConnectionID, clientToSendTo.ipAddressAsString );
-	theNetwork.SetPortAsStringForConnection( m_listenConnectionID, clientToSendTo.portAsString );
+//-----------------------------------------------------------------------------------------------
+//Oldest first, as acks free up the window
+void Server::SendReliablePacketsWaitingForRoom( ConnectedClient& clientToSendTo )
+{
+	std::deque< CS6Packet >& waitingPackets = clientToSendTo.m_reliablePacketsWaitingForRoom;
 
-	theNetwork.SendUDPMessage( ( char* )&packetToSend, sizeof( packetToSend ), m_listenConnectionID );
+	while( !waitingPackets.empty() && clientToSendTo.m_reliablePacketsAwaitingAckBack.HasRoomFor( clientToSendTo.numReliableMessagesSent + 1 ) )
+	{
+		SendReliablePacketNow( waitingPackets.front(), clientToSendTo );
+		waitingPackets.pop_front();
+	}
 }
 
 
 //-----------------------------------------------------------------------------------------------
-void Server::AddOrUpdateConnectedClient( const CS6Packet& packet )
+void Server::SendReliablePacketNow( const CS6Packet& messageAsPacket, ConnectedClient& clientToSendTo )
 {
-	std::string ipAddressOfClient = "";
-	std::string portAsString = "";
+	CS6Packet packetToSend = messageAsPacket;
+	double currentTime = Time::GetCurrentTimeInSeconds();
 
-	Network& theNetwork = Network::GetInstance();
+	//stamped before the reliable copy is kept, its resend time counts from here
+	packetToSend.timestamp = currentTime;
+
+	++clientToSendTo.numReliableMessagesSent;
+	packetToSend.packetNumber = clientToSendTo.numReliableMessagesSent;
+
+	double resendTime = currentTime + clientToSendTo.connectionStats.GetRetransmitTimeoutSeconds( 0 );
+
+	clientToSendTo.connectionStats.RecordReliablePacketSent( packetToSend.packetNumber, currentTime );
+	clientToSendTo.m_reliablePacketsAwaitingAckBack.Add( packetToSend.packetNumber, packetToSend, resendTime );
+	m_timerWheel.Schedule( resendTime, TIMER_RESEND_RELIABLE_PACKET, clientToSendTo.connectionID, packetToSend.packetNumber );
+
+	QueuePacketForClient( packetToSend, clientToSendTo );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Every fragment is a reliable packet of its own, acked and resent on its own, so a lost one costs
+//one packet again rather than the whole message. They go out packed together like everything else.
+void Server::SendFragmentedMessageToClient( const std::vector< unsigned char >& message, ConnectedClient& clientToSendTo )
+{
+	int numMessageBytes = static_cast< int >( message.size() );
+	int numFragments = GetNumFragmentsForMessage( numMessageBytes, FRAGMENT_PAYLOAD_BYTES );
+
+	FATAL_ASSERTION( numMessageBytes <= MAX_FRAGMENTED_MESSAGE_BYTES, "Message is too big to be sent in fragments." );
+
+	++clientToSendTo.numFragmentedMessagesSent;
+
+	CS6Packet fragmentPacket;
+
+	for( int i = 0; i < numFragments; ++i )
+	{
+		int fragmentOffset = i * FRAGMENT_PAYLOAD_BYTES;
+		int numFragmentBytes = numMessageBytes - fragmentOffset;
+
+		if( numFragmentBytes > FRAGMENT_PAYLOAD_BYTES )
+		{
+			numFragmentBytes = FRAGMENT_PAYLOAD_BYTES;
+		}
+
+		ZeroMemory( &fragmentPacket, sizeof( fragmentPacket ) );
+
+		fragmentPacket.packetType = TYPE_Fragment;
+		fragmentPacket.data.fragment.messageID = static_cast< unsigned short >( clientToSendTo.numFragmentedMessagesSent );
+		fragmentPacket.data.fragment.fragmentIndex = static_cast< unsigned char >( i );
+		fragmentPacket.data.fragment.numFragments = static_cast< unsigned char >( numFragments );
+		fragmentPacket.data.fragment.numBytes = static_cast< unsigned char >( numFragmentBytes );
+
+		if( numFragmentBytes > 0 )
+		{
+			memcpy( fragmentPacket.data.fragment.bytes, &message[ fragmentOffset ], numFragmentBytes );
+		}
+
+		SendMessageToClient( fragmentPacket, clientToSendTo );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Sent at the end of the frame, packed in with everything else going to the same client
+void Server::QueuePacketForClient( const CS6Packet& packetToSend, ConnectedClient& clientToSendTo )
+{
+	QueuedClientPacket queuedPacket;
+
+	queuedPacket.packet = packetToSend;
+	queuedPacket.destinationAddress = clientToSendTo.peerAddress;
+	queuedPacket.connectionID = clientToSendTo.connectionID;
+
+	m_packetsToSendThisFrame.push_back( queuedPacket );
+}
 
-	ipAddressOfClient = theNetwork.GetIPAddressAsStringFromConnection( m_listenConnectionID );
-	portAsString = theNetwork.GetPortAsStringFromConnection( m_listenConnectionID );
 
-	if( ipAddressOfClient == "" || portAsString == "" )
+//-----------------------------------------------------------------------------------------------
+void Server::SendQueuedPacketsToClients()
+{
+	if( m_packetsToSendThisFrame.empty() )
 	{
 		return;
 	}
 
-	std::string idOfClient = portAsString + ipAddressOfClient;
+	//broadcasts queue one player's update for every client in turn. Grouping by client, without
+	//reordering any one client's packets, lines each client's share up to be packed together.
+	std::stable_sort( m_packetsToSendThisFrame.begin(), m_packetsToSendThisFrame.end() );
+
+	PackQueuedPacketsIntoDatagrams();
+
+	//queued sends go out from the network thread, so nothing here waits on the socket
+	if( m_networkThread.IsRunning() )
+	{
+		for( int i = 0; i < static_cast< int >( m_datagramsToSendThisFrame.size() ); ++i )
+		{
+			const OutgoingDatagram& datagram = m_datagramsToSendThisFrame[ i ];
+
+			m_networkThread.SendTo( datagram.destinationAddress, datagram.message, datagram.messageSize );
+		}
+	}
+	else
+	{
+		Network::GetInstance().SendUDPMessages( m_datagramsToSendThisFrame, m_listenConnectionID );
+	}
+
+	//clear() keeps capacity, so steady state sends do not reallocate
+	m_packetsToSendThisFrame.clear();
+	m_datagramsToSendThisFrame.clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Each client's run of packets goes into as few datagrams as fit under the max datagram size, and
+//never shares one with another client's. Datagram memory only stops moving once packing is done,
+//so messages are pointed at last.
+void Server::PackQueuedPacketsIntoDatagrams()
+{
+	int numQueuedPackets = static_cast< int >( m_packetsToSendThisFrame.size() );
+	int runStartIndex = 0;
+
+	m_packedPacketsThisFrame.Clear();
+	m_datagramsToSendThisFrame.clear();
+
+	while( runStartIndex < numQueuedPackets )
+	{
+		const QueuedClientPacket& firstPacketInRun = m_packetsToSendThisFrame[ runStartIndex ];
+		int runEndIndex = runStartIndex;
+
+		m_packedPacketsThisFrame.FinishDatagram();
+
+		while( runEndIndex < numQueuedPackets && m_packetsToSendThisFrame[ runEndIndex ].destinationAddress == firstPacketInRun.destinationAddress )
+		{
+			m_packedPacketsThisFrame.AppendMessage( &m_packetsToSendThisFrame[ runEndIndex ].packet, sizeof( CS6Packet ) );
+			++runEndIndex;
+		}
+
+		//the client may have been removed since its packets were queued, they still go out
+		auto clientIter = m_connectedAndActiveClients.find( firstPacketInRun.connectionID );
+		ConnectedClient* client = ( clientIter != m_connectedAndActiveClients.end() ) ? clientIter->second : nullptr;
+
+		for( int i = static_cast< int >( m_datagramsToSendThisFrame.size() ); i < m_packedPacketsThisFrame.GetNumDatagrams(); ++i )
+		{
+			OutgoingDatagram datagram;
+
+			datagram.message = nullptr;
+			m_packedPacketsThisFrame.GetDatagram( i, datagram.messageSize );
+			datagram.destinationAddress = firstPacketInRun.destinationAddress;
+
+			if( client != nullptr )
+			{
+				client->connectionStats.RecordPacketSent( datagram.messageSize );
+				client->sendPacer.RecordBytesSent( datagram.messageSize );
+			}
+
+			m_datagramsToSendThisFrame.push_back( datagram );
+		}
+
+		runStartIndex = runEndIndex;
+	}
+
+	for( int i = 0; i < static_cast< int >( m_datagramsToSendThisFrame.size() ); ++i )
+	{
+		int datagramSize = 0;
+
+		m_datagramsToSendThisFrame[ i ].message = m_packedPacketsThisFrame.GetDatagram( i, datagramSize );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Server::AddOrUpdateConnectedClient( const CS6Packet& packet )
+{
+	if( !m_currentPacketSourceAddress.IsValid() )
+	{
+		return;
+	}
 
 	auto iter = m_connectedAndActiveClients.begin();
 
@@ -621,9 +1341,9 @@ void Server::AddOrUpdateConnectedClient( const CS6Packet& packet )
 		{
 			continue;
 		}
-		if( idOfClient == iter->second->clientID )
+		if( iter->second->peerAddress == m_currentPacketSourceAddress )
 		{
-			iter->second->timeSinceLastReceivedMessage = 0.f;
+			iter->second->lastReceivedMessageTimeSeconds = m_currentPacketArrivalTimeSeconds;
 
 			if( packet.packetType == TYPE_Update )
 			{
@@ -641,12 +1361,10 @@ void Server::AddOrUpdateConnectedClient( const CS6Packet& packet )
 
 	if( iter == m_connectedAndActiveClients.end() )
 	{
-		ConnectedClient* newConnectedClient = new ConnectedClient( ipAddressOfClient, portAsString );
+		ConnectedClient* newConnectedClient = new ConnectedClient( m_currentPacketSourceAddress );
 		newConnectedClient->playerIDAsRGB = Color( uchar( m_connectedAndActiveClients.size() ) );
 
-		++ConnectedClient::s_currentConnectedID;
-		m_connectedAndActiveClients[ ConnectedClient::s_currentConnectedID ] = newConnectedClient;
-		newConnectedClient->connectionID = ConnectedClient::s_currentConnectedID;
+		AddConnectedClient( newConnectedClient );
 
 		PutNewClientInLobbyAndSendListOfCurrentGames( *newConnectedClient );
 
@@ -658,6 +1376,60 @@ void Server::AddOrUpdateConnectedClient( const CS6Packet& packet )
 }
 
 
+//-----------------------------------------------------------------------------------------------
+void Server::AddConnectedClient( ConnectedClient* newConnectedClient )
+{
+	++m_currentMaxConnectionID;
+	m_connectedAndActiveClients[ m_currentMaxConnectionID ] = newConnectedClient;
+	++m_numClientListChanges;
+	newConnectedClient->connectionID = m_currentMaxConnectionID;
+	newConnectedClient->lastReceivedMessageTimeSeconds = Time::GetCurrentTimeInSeconds();
+
+	m_timerWheel.Schedule( newConnectedClient->lastReceivedMessageTimeSeconds + MAX_SECONDS_OF_INACTIVITY, TIMER_CLIENT_INACTIVITY, newConnectedClient->connectionID, 0 );
+
+	if( m_sharedLobby != nullptr )
+	{
+		m_sharedLobby->SetShardIndexOwningClient( newConnectedClient->peerAddress, m_shardIndex );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Shards take IDs from the shared lobby so a game ID means the same game on every shard
+GameID Server::CreateNewGameID()
+{
+	if( m_sharedLobby != nullptr )
+	{
+		return m_sharedLobby->AddGame( m_shardIndex );
+	}
+
+	++m_currentMaxGameID;
+
+	return m_currentMaxGameID;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Server::GetCurrentGameIDs( std::vector< GameID >& out_gameIDs ) const
+{
+	if( m_sharedLobby != nullptr )
+	{
+		m_sharedLobby->GetGameIDs( out_gameIDs );
+		return;
+	}
+
+	out_gameIDs.clear();
+
+	for( auto iter = m_gamesAndTheirClients.begin(); iter != m_gamesAndTheirClients.end(); ++iter )
+	{
+		if( iter->first != LOBBY_ID )
+		{
+			out_gameIDs.push_back( iter->first );
+		}
+	}
+}
+
+
 //-----------------------------------------------------------------------------------------------
 void Server::RemoveClientFromRoom( GameID roomID, ConnectedClient& clientToSendRemove )
 {
@@ -722,36 +1494,14 @@ void Server::RemoveRoom( GameID roomID )
 {
 	m_gamesAndTheirClients.erase( roomID );
 
-	CS6Packet lobbyPacket;
-
-	for( auto iter = m_connectedAndActiveClients.begin(); iter != m_connectedAndActiveClients.end(); ++iter ) 
+	//every shard's lobby picks this up in RefreshLobbyIfSharedGamesChanged
+	if( m_sharedLobby != nullptr )
 	{
-		if( iter->second == nullptr )
-		{
-			continue;
-		}
-
-		ZeroMemory( &lobbyPacket, sizeof( lobbyPacket ) );
-		lobbyPacket.packetType = TYPE_Acknowledge;
-		lobbyPacket.data.acknowledged.packetType = TYPE_LobbyStart;
-
-		SendMessageToClient( lobbyPacket, *( iter->second ) );
-
-		auto clientIter = m_gamesAndTheirClients.begin();
-
-		for( ; clientIter != m_gamesAndTheirClients.end(); ++clientIter )
-		{
-			if( clientIter->first == LOBBY_ID )
-			{
-				continue;
-			}
-
-			lobbyPacket.packetType = TYPE_LobbyStart;
-			lobbyPacket.data.lobbyStart.m_gameID = clientIter->first;
-
-			SendMessageToClient( lobbyPacket, *( iter->second ) );
-		}
+		m_sharedLobby->RemoveGame( roomID );
+		return;
 	}
+
+	SendListOfCurrentGamesToLobby();
 }
 
 
@@ -831,4 +1581,54 @@ void Server::SetPortToBindToFromParameters( NamedProperties& parameters )
 	FATAL_ASSERTION( portAsString != "", "Command: port did not receive the correct parameters.\nport expects a non empty string." );
 
 	m_currentServerPort = u_short( atoi( portAsString.c_str() ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Server::EnableNetworkThread( NamedProperties& parameters )
+{
+	UNUSED( parameters );
+
+	m_useNetworkThread = true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//maxDatagramSize <bytes>, how big a datagram of packed packets can get. Never below one packet.
+void Server::SetMaxDatagramSize( NamedProperties& parameters )
+{
+	std::string maxDatagramSizeAsString;
+
+	parameters.Get( "param1", maxDatagramSizeAsString );
+
+	int maxDatagramSizeBytes = atoi( maxDatagramSizeAsString.c_str() );
+
+	if( maxDatagramSizeBytes < static_cast< int >( sizeof( CS6Packet ) ) )
+	{
+		maxDatagramSizeBytes = sizeof( CS6Packet );
+	}
+
+	m_packedPacketsThisFrame.SetMaxDatagramSize( maxDatagramSizeBytes );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Server::ConsolePrintNetworkStats( NamedProperties& parameters )
+{
+	UNUSED( parameters );
+
+	Network::GetInstance().GetSocketStats( m_listenConnectionID ).ConsolePrintStats( "Listen socket" );
+
+	for( auto iter = m_connectedAndActiveClients.begin(); iter != m_connectedAndActiveClients.end(); ++iter )
+	{
+		const ConnectedClient* client = iter->second;
+
+		if( client == nullptr )
+		{
+			continue;
+		}
+
+		client->connectionStats.ConsolePrintStats( "Client " + client->ipAddressAsString + ":" + client->portAsString );
+		client->sendPacer.ConsolePrintStats();
+	}
 }
\ No newline at end of file
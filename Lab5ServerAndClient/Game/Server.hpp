@@ -5,10 +5,14 @@
 #include <vector>
 
 #include "Engine/Networking/Network.hpp"
+#include "Engine/Networking/NetworkThread.hpp"
+#include "Engine/Networking/MessageCoalescer.hpp"
 #include "Engine/Utilities/EventSystem.hpp"
+#include "Engine/Utilities/TimerWheel.hpp"
 
 #include "CS6Packet.hpp"
 #include "ConnectedClient.hpp"
+#include "SharedLobby.hpp"
 
 //-----------------------------------------------------------------------------------------------
 typedef unsigned int ConnectionID;
@@ -25,15 +29,36 @@ public:
 	void ShutDown();
 
 	void Update();
+	void Update( float deltaSeconds );
 	void Render() const;
+	bool HasChangedSinceLastRender() const;
+
+	void WaitForClientMessagesOrNextScheduledEvent( double maxSecondsToWait );
+
+	void AttachToSharedLobby( SharedLobby* sharedLobby, int shardIndex );
+
+	inline u_short	GetServerPort() const;
+	inline void		SetServerPort( u_short port );
+	inline int		GetShardIndex() const;
 
 	inline void RegisterForEvents();
 
 private:
 
 	void ReceiveMessagesFromClientsIfAny();
+	void ReceiveMessagesFromNetworkThread();
+	void OnReceiveDatagram( const char* buffer, int numBytes, const PeerAddress& sourceAddress, double arrivalTimeSeconds );
+	void RecordPacketReceivedFromCurrentSource( int numBytes );
+	ConnectedClient* FindConnectedClient( const PeerAddress& clientAddress );
 	void ProcessPacket( const CS6Packet& packet );
 
+	bool ForwardPacketIfOwnedByAnotherShard( const CS6Packet& packet );
+	void ProcessPacketsForwardedFromOtherShards();
+	void AdoptClientsHandedOffFromOtherShards();
+	void HandOffClientToShard( ConnectionID clientID, GameID gameIDToJoin, int shardIndex );
+	void RefreshLobbyIfSharedGamesChanged();
+	void SendListOfCurrentGamesToLobby();
+
 	void OnReceiveUpdatePacket( const CS6Packet& packet );
 	void OnReceiveVictoryPacket( const CS6Packet& packet );
 	void OnReceiveHostGamePacket( const CS6Packet& packet );
@@ -41,18 +66,36 @@ private:
 	void OnReceiveAckPacket( const CS6Packet& packet );
 	void OnAckAcknowledge( const CS6Packet& packet );
 	void OnAckReliablePacket( const CS6Packet& packet );
+	void OnReceivePiggybackedAcks( const CS6Packet& packet );
+	void AckReliablePacket( ConnectedClient& ackingClient, uint ackedPacketNumber );
 
-	void RemoveInactiveClients();
-	void ResendAnyGuaranteedPacketsThatHaveTimedOut();
+	double GetSecondsUntilNextScheduledEvent() const;
+
+	void ProcessExpiredTimers();
+	void OnReliablePacketResendTimerExpired( const ScheduledTimer& timer, double currentTimeSeconds );
+	void OnClientInactivityTimerExpired( const ScheduledTimer& timer, double currentTimeSeconds );
+	void OnStalledClientTimerExpired( const ScheduledTimer& timer );
+	void RemoveClient( ConnectionID clientID );
 
 	void SendUpdatePacketsToAllClients();
 	void BroadCastMessageToAllClients( const CS6Packet& messageAsPacket, int messageLength );
 	void BroadCastMessageToAllClientsInRoom( GameID room, const CS6Packet& messageAsPacket, int messageLength );
 	void SendAGameStartPacketToNewClient( ConnectedClient& clientToSendTo );
 	void PutNewClientInLobbyAndSendListOfCurrentGames( ConnectedClient& clientToSendTo );
+	void SendListOfCurrentGamesToClient( ConnectedClient& clientToSendTo );
 	void SendMessageToClient( const CS6Packet& messageAsPacket, ConnectedClient& clientToSendTo );
+	void SendReliablePacketWhenThereIsRoom( const CS6Packet& packetToSend, ConnectedClient& clientToSendTo );
+	void SendReliablePacketsWaitingForRoom( ConnectedClient& clientToSendTo );
+	void SendReliablePacketNow( const CS6Packet& messageAsPacket, ConnectedClient& clientToSendTo );
+	void SendFragmentedMessageToClient( const std::vector< unsigned char >& message, ConnectedClient& clientToSendTo );
+	void QueuePacketForClient( const CS6Packet& packetToSend, ConnectedClient& clientToSendTo );
+	void SendQueuedPacketsToClients();
+	void PackQueuedPacketsIntoDatagrams();
 
 	void AddOrUpdateConnectedClient( const CS6Packet& packet );
+	void AddConnectedClient( ConnectedClient* newConnectedClient );
+	GameID CreateNewGameID();
+	void GetCurrentGameIDs( std::vector< GameID >& out_gameIDs ) const;
 	void RemoveClientFromRoom( GameID roomID, ConnectedClient& clientToSendRemove );
 	void RemoveRoom( GameID roomID );
 
@@ -60,9 +103,23 @@ private:
 
 	void SetServerIpFromParameters( NamedProperties& parameters );
 	void SetPortToBindToFromParameters( NamedProperties& parameters );
+	void EnableNetworkThread( NamedProperties& parameters );
+	void ConsolePrintNetworkStats( NamedProperties& parameters );
+	void SetMaxDatagramSize( NamedProperties& parameters );
+
+	enum ServerTimerType
+	{
+		TIMER_RESEND_RELIABLE_PACKET,
+		TIMER_CLIENT_INACTIVITY,
+		TIMER_STALLED_CLIENT
+	};
 
 	int m_listenConnectionID;
 
+	bool			m_useNetworkThread;
+	NetworkThread	m_networkThread;
+	int				m_numQueuedDatagramsThisFrame;
+
 	std::string m_currentServerIPAddressAsString;
 	u_short		m_currentServerPort;
 
@@ -70,13 +127,66 @@ private:
 
 	std::map< ConnectionID, ConnectedClient* > m_connectedAndActiveClients;
 	//std::vector< ConnectedClient > m_connectedAndActiveClients;
+	uint			m_numClientListChanges;
+	mutable uint	m_numClientListChangesRendered;
 	std::map< GameID, std::vector< int > > m_gamesAndTheirClients;
 	std::map< GameID, Vector2f > m_currentFlagPositions;
 
-	static GameID s_currentMaxGameID;
+	struct QueuedClientPacket
+	{
+		CS6Packet			packet;
+		PeerAddress			destinationAddress;
+		ConnectionID		connectionID;
+
+		inline bool operator<( const QueuedClientPacket& other ) const;
+	};
+
+	PeerAddress							m_currentPacketSourceAddress;
+	double								m_currentPacketArrivalTimeSeconds;
+	std::vector< QueuedClientPacket >	m_packetsToSendThisFrame;
+	MessageCoalescer					m_packedPacketsThisFrame;
+	std::vector< OutgoingDatagram >		m_datagramsToSendThisFrame;
+
+	float			m_currentSendElapsedTime;
+	ConnectionID	m_currentMaxConnectionID;
+	GameID			m_currentMaxGameID;
+
+	//Only set when this server is one shard of a ShardedServer
+	SharedLobby*					m_sharedLobby;
+	int								m_shardIndex;
+	uint							m_lastSeenLobbyVersion;
+	std::vector< ForwardedPacket >	m_forwardedPackets;
+	std::vector< ClientHandoff >	m_clientHandoffs;
+	std::vector< GameID >			m_currentGameIDs;
+	std::vector< unsigned char >	m_gameListMessage;
+
+	//Resend timers are keyed by client and packet number, inactivity timers by client
+	TimerWheel						m_timerWheel;
+	std::vector< ScheduledTimer >	m_expiredTimers;
 };
 
 
+//-----------------------------------------------------------------------------------------------
+inline u_short Server::GetServerPort() const
+{
+	return m_currentServerPort;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void Server::SetServerPort( u_short port )
+{
+	m_currentServerPort = port;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline int Server::GetShardIndex() const
+{
+	return m_shardIndex;
+}
+
+
 //-----------------------------------------------------------------------------------------------
 inline void Server::RegisterForEvents()
 {
@@ -84,6 +194,17 @@ inline void Server::RegisterForEvents()
 
 	eventSystem.RegisterEventWithCallbackAndObject( "ip", &Server::SetServerIpFromParameters, this );
 	eventSystem.RegisterEventWithCallbackAndObject( "port", &Server::SetPortToBindToFromParameters, this );
+	eventSystem.RegisterEventWithCallbackAndObject( "networkThread", &Server::EnableNetworkThread, this );
+	eventSystem.RegisterEventWithCallbackAndObject( "dumpNetStats", &Server::ConsolePrintNetworkStats, this );
+	eventSystem.RegisterEventWithCallbackAndObject( "maxDatagramSize", &Server::SetMaxDatagramSize, this );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//By client only, so a stable sort keeps each client's packets in the order they were queued
+inline bool Server::QueuedClientPacket::operator<( const QueuedClientPacket& other ) const
+{
+	return destinationAddress < other.destinationAddress;
 }
 
 
@@ -0,0 +1,169 @@
+#define STATIC
+
+#include "ShardedServer.hpp"
+
+#include <process.h>
+#include <sstream>
+#include <time.h>
+
+#include "Engine/Rendering/OpenGLRenderer.hpp"
+#include "Engine/Rendering/BitmapFont.hpp"
+#include "Engine/Primitives/Vector3.hpp"
+#include "Engine/Utilities/InputHandler.hpp"
+#include "Engine/Utilities/Time.hpp"
+
+//Forwarded packets and handoffs arrive without waking the shard's socket, this bounds how long they wait
+const double MAX_SHARD_IDLE_SECONDS = 0.005;
+
+volatile LONG ShardedServer::s_numShardThreadsRunning = 0;
+volatile LONG ShardedServer::s_shouldShardsStop = 0;
+
+//-----------------------------------------------------------------------------------------------
+//Public Methods
+//-----------------------------------------------------------------------------------------------
+ShardedServer::ShardedServer()
+	: m_numLobbyChangesRendered( 0 )
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ShardedServer::~ShardedServer()
+{
+	ShutDown();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Every shard's socket is created and bound here on the calling thread before any shard starts
+void ShardedServer::StartUp( int numShards, u_short port )
+{
+	InterlockedExchange( &s_shouldShardsStop, 0 );
+	m_sharedLobby.SetNumShards( numShards );
+
+	for( int i = 0; i < numShards; ++i )
+	{
+		Server* newShard = new Server();
+
+		newShard->SetServerPort( port );
+		newShard->AttachToSharedLobby( &m_sharedLobby, i );
+		newShard->StartUp();
+
+		m_shards.push_back( newShard );
+	}
+
+	for( int i = 0; i < numShards; ++i )
+	{
+		InterlockedIncrement( &s_numShardThreadsRunning );
+		_beginthread( &ShardedServer::ShardThreadEntryFunction, 0, m_shards[ i ] );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ShardedServer::ShutDown()
+{
+	if( m_shards.empty() )
+	{
+		return;
+	}
+
+	InterlockedExchange( &s_shouldShardsStop, 1 );
+
+	while( s_numShardThreadsRunning > 0 )
+	{
+		Sleep( 1 );
+	}
+
+	for( int i = 0; i < static_cast< int >( m_shards.size() ); ++i )
+	{
+		delete m_shards[ i ];
+	}
+
+	m_shards.clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Shards belong to their threads, so this only draws what the shared lobby knows about them
+void ShardedServer::Render() const
+{
+	m_numLobbyChangesRendered = m_sharedLobby.GetNumChanges();
+
+	RenderShards();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//The shards do all the networking, so the main thread only has their changes to wake up for
+void ShardedServer::WaitForShardChanges( double maxSecondsToWait )
+{
+	m_sharedLobby.WaitForChange( maxSecondsToWait );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool ShardedServer::HasChangedSinceLastRender() const
+{
+	return m_sharedLobby.GetNumChanges() != m_numLobbyChangesRendered;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Private Methods
+//-----------------------------------------------------------------------------------------------
+STATIC void ShardedServer::ShardThreadEntryFunction( void* shardAsVoid )
+{
+	Server* shard = static_cast< Server* >( shardAsVoid );
+
+	//the CRT keeps rand state per thread, so seed each shard differently
+	srand( ( unsigned int )time( NULL ) + shard->GetShardIndex() );
+
+	double timeAtLastUpdate = Time::GetCurrentTimeInSeconds();
+
+	while( !InputHandler::ShouldQuit() && s_shouldShardsStop == 0 )
+	{
+		shard->WaitForClientMessagesOrNextScheduledEvent( MAX_SHARD_IDLE_SECONDS );
+
+		double timeNow = Time::GetCurrentTimeInSeconds();
+
+		shard->Update( static_cast< float >( timeNow - timeAtLastUpdate ) );
+
+		timeAtLastUpdate = timeNow;
+	}
+
+	InterlockedDecrement( &s_numShardThreadsRunning );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ShardedServer::RenderShards() const
+{
+	const float fontSize = 24.f;
+	const Vector3f offsetVector( 0.f, fontSize, 0.f );
+	const Vector3f initialPosition( 0.f, 1000.f, 0.f ); //LAZY
+
+	BitmapFont* font = BitmapFont::CreateOrGetFont( "Data/Fonts/MainFont_EN_00.png", "Data/Fonts/MainFont_EN.FontDef.xml" );
+	std::ostringstream outputStringStream;
+	std::string stringToRender;
+
+	Vector3f textPosition = initialPosition;
+
+	outputStringStream.str( "" );
+	outputStringStream << "Server Shards: " << m_shards.size();
+	stringToRender = outputStringStream.str();
+
+	OpenGLRenderer::RenderText( stringToRender, font, fontSize, textPosition );
+	textPosition -= offsetVector;
+
+	for( int i = 0; i < static_cast< int >( m_shards.size() ); ++i )
+	{
+		outputStringStream.str( "" );
+		outputStringStream << "Shard " << i << ": " << m_sharedLobby.GetNumClientsOwnedByShard( i ) << " clients, " << m_sharedLobby.GetNumGamesOwnedByShard( i ) << " games";
+		stringToRender = outputStringStream.str();
+
+		OpenGLRenderer::RenderText( stringToRender, font, fontSize, textPosition );
+		textPosition -= offsetVector;
+	}
+}
@@ -0,0 +1,52 @@
+#ifndef SHARDED_SERVER_HPP
+#define SHARDED_SERVER_HPP
+
+#include <vector>
+
+#include "Server.hpp"
+#include "SharedLobby.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Runs several Servers on their own threads, all bound to the same port. The kernel spreads
+//clients across the shards' sockets, each shard owns its clients and games outright, and the
+//SharedLobby is the only thing they touch in common.
+class ShardedServer
+{
+
+public:
+
+	ShardedServer();
+	~ShardedServer();
+
+	void StartUp( int numShards, u_short port );
+	void ShutDown();
+
+	void Render() const;
+	void WaitForShardChanges( double maxSecondsToWait );
+	bool HasChangedSinceLastRender() const;
+
+	inline bool IsRunning() const;
+
+private:
+
+	static void ShardThreadEntryFunction( void* shardAsVoid );
+
+	void RenderShards() const;
+
+	std::vector< Server* >	m_shards;
+	SharedLobby				m_sharedLobby;
+	mutable uint			m_numLobbyChangesRendered;
+
+	static volatile LONG	s_numShardThreadsRunning;
+	static volatile LONG	s_shouldShardsStop;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline bool ShardedServer::IsRunning() const
+{
+	return !m_shards.empty();
+}
+
+
+#endif
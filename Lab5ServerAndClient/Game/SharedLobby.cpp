@@ -0,0 +1,313 @@
+#include "SharedLobby.hpp"
+
+//-----------------------------------------------------------------------------------------------
+SharedLobby::SharedLobby()
+	: m_currentMaxGameID( 0 )
+	, m_version( 0 )
+	, m_numChanges( 0 )
+{
+	InitializeCriticalSection( &m_lobbyCS );
+
+	m_changedEvent = CreateEvent( nullptr, FALSE, FALSE, nullptr );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+SharedLobby::~SharedLobby()
+{
+	CloseHandle( m_changedEvent );
+	DeleteCriticalSection( &m_lobbyCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Only call before the shards start running
+void SharedLobby::SetNumShards( int numShards )
+{
+	EnterCriticalSection( &m_lobbyCS );
+
+	m_forwardedPacketsByShard.resize( numShards );
+	m_clientHandoffsByShard.resize( numShards );
+
+	LeaveCriticalSection( &m_lobbyCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+GameID SharedLobby::AddGame( int owningShardIndex )
+{
+	EnterCriticalSection( &m_lobbyCS );
+
+	++m_currentMaxGameID;
+	GameID newGameID = m_currentMaxGameID;
+
+	m_shardIndicesByGameID[ newGameID ] = owningShardIndex;
+	++m_version;
+	RecordChange();
+
+	LeaveCriticalSection( &m_lobbyCS );
+
+	return newGameID;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SharedLobby::RemoveGame( GameID gameID )
+{
+	EnterCriticalSection( &m_lobbyCS );
+
+	if( m_shardIndicesByGameID.erase( gameID ) > 0 )
+	{
+		++m_version;
+		RecordChange();
+	}
+
+	LeaveCriticalSection( &m_lobbyCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int SharedLobby::GetShardIndexOwningGame( GameID gameID ) const
+{
+	int shardIndex = NO_SHARD;
+
+	EnterCriticalSection( &m_lobbyCS );
+
+	auto foundIter = m_shardIndicesByGameID.find( gameID );
+
+	if( foundIter != m_shardIndicesByGameID.end() )
+	{
+		shardIndex = foundIter->second;
+	}
+
+	LeaveCriticalSection( &m_lobbyCS );
+
+	return shardIndex;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SharedLobby::GetGameIDs( std::vector< GameID >& out_gameIDs ) const
+{
+	out_gameIDs.clear();
+
+	EnterCriticalSection( &m_lobbyCS );
+
+	for( auto iter = m_shardIndicesByGameID.begin(); iter != m_shardIndicesByGameID.end(); ++iter )
+	{
+		out_gameIDs.push_back( iter->first );
+	}
+
+	LeaveCriticalSection( &m_lobbyCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+uint SharedLobby::GetVersion() const
+{
+	EnterCriticalSection( &m_lobbyCS );
+
+	uint version = m_version;
+
+	LeaveCriticalSection( &m_lobbyCS );
+
+	return version;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SharedLobby::SetShardIndexOwningClient( const PeerAddress& clientAddress, int shardIndex )
+{
+	EnterCriticalSection( &m_lobbyCS );
+
+	m_shardIndicesByClientAddress[ clientAddress ] = shardIndex;
+	RecordChange();
+
+	LeaveCriticalSection( &m_lobbyCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Only the owning shard may remove a client, so a stale timeout cannot undo a handoff
+void SharedLobby::RemoveClient( const PeerAddress& clientAddress, int shardIndex )
+{
+	EnterCriticalSection( &m_lobbyCS );
+
+	auto foundIter = m_shardIndicesByClientAddress.find( clientAddress );
+
+	if( foundIter != m_shardIndicesByClientAddress.end() && foundIter->second == shardIndex )
+	{
+		m_shardIndicesByClientAddress.erase( foundIter );
+		RecordChange();
+	}
+
+	LeaveCriticalSection( &m_lobbyCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int SharedLobby::GetShardIndexOwningClient( const PeerAddress& clientAddress ) const
+{
+	int shardIndex = NO_SHARD;
+
+	EnterCriticalSection( &m_lobbyCS );
+
+	auto foundIter = m_shardIndicesByClientAddress.find( clientAddress );
+
+	if( foundIter != m_shardIndicesByClientAddress.end() )
+	{
+		shardIndex = foundIter->second;
+	}
+
+	LeaveCriticalSection( &m_lobbyCS );
+
+	return shardIndex;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int SharedLobby::GetNumClientsOwnedByShard( int shardIndex ) const
+{
+	int numClients = 0;
+
+	EnterCriticalSection( &m_lobbyCS );
+
+	for( auto iter = m_shardIndicesByClientAddress.begin(); iter != m_shardIndicesByClientAddress.end(); ++iter )
+	{
+		if( iter->second == shardIndex )
+		{
+			++numClients;
+		}
+	}
+
+	LeaveCriticalSection( &m_lobbyCS );
+
+	return numClients;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int SharedLobby::GetNumGamesOwnedByShard( int shardIndex ) const
+{
+	int numGames = 0;
+
+	EnterCriticalSection( &m_lobbyCS );
+
+	for( auto iter = m_shardIndicesByGameID.begin(); iter != m_shardIndicesByGameID.end(); ++iter )
+	{
+		if( iter->second == shardIndex )
+		{
+			++numGames;
+		}
+	}
+
+	LeaveCriticalSection( &m_lobbyCS );
+
+	return numGames;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SharedLobby::ForwardPacketToShard( int shardIndex, const PeerAddress& sourceAddress, const CS6Packet& packet )
+{
+	ForwardedPacket forwardedPacket;
+
+	forwardedPacket.sourceAddress = sourceAddress;
+	forwardedPacket.packet = packet;
+
+	EnterCriticalSection( &m_lobbyCS );
+
+	if( shardIndex >= 0 && shardIndex < static_cast< int >( m_forwardedPacketsByShard.size() ) )
+	{
+		m_forwardedPacketsByShard[ shardIndex ].push_back( forwardedPacket );
+	}
+
+	LeaveCriticalSection( &m_lobbyCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Ownership changes here, before the new shard has seen the client, so any packet arriving
+//in between is forwarded after the handoff and never adopted by the old shard again
+void SharedLobby::HandOffClientToShard( int shardIndex, const ClientHandoff& handoff )
+{
+	EnterCriticalSection( &m_lobbyCS );
+
+	if( shardIndex >= 0 && shardIndex < static_cast< int >( m_clientHandoffsByShard.size() ) )
+	{
+		m_shardIndicesByClientAddress[ handoff.client.peerAddress ] = shardIndex;
+		m_clientHandoffsByShard[ shardIndex ].push_back( handoff );
+	}
+
+	LeaveCriticalSection( &m_lobbyCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Swaps rather than copies, out_packets should come in empty and its capacity is reused next time
+void SharedLobby::TakeForwardedPackets( int shardIndex, std::vector< ForwardedPacket >& out_packets )
+{
+	out_packets.clear();
+
+	EnterCriticalSection( &m_lobbyCS );
+
+	if( shardIndex >= 0 && shardIndex < static_cast< int >( m_forwardedPacketsByShard.size() ) )
+	{
+		m_forwardedPacketsByShard[ shardIndex ].swap( out_packets );
+	}
+
+	LeaveCriticalSection( &m_lobbyCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SharedLobby::TakeClientHandoffs( int shardIndex, std::vector< ClientHandoff >& out_handoffs )
+{
+	out_handoffs.clear();
+
+	EnterCriticalSection( &m_lobbyCS );
+
+	if( shardIndex >= 0 && shardIndex < static_cast< int >( m_clientHandoffsByShard.size() ) )
+	{
+		m_clientHandoffsByShard[ shardIndex ].swap( out_handoffs );
+	}
+
+	LeaveCriticalSection( &m_lobbyCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//False if nothing changed before the time ran out
+bool SharedLobby::WaitForChange( double maxSecondsToWait )
+{
+	if( maxSecondsToWait < 0.0 )
+	{
+		maxSecondsToWait = 0.0;
+	}
+
+	return WaitForSingleObject( m_changedEvent, static_cast< DWORD >( maxSecondsToWait * 1000.0 ) ) == WAIT_OBJECT_0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+uint SharedLobby::GetNumChanges() const
+{
+	EnterCriticalSection( &m_lobbyCS );
+
+	uint numChanges = m_numChanges;
+
+	LeaveCriticalSection( &m_lobbyCS );
+
+	return numChanges;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Private Methods
+//-----------------------------------------------------------------------------------------------
+//Call from inside the lobby's critical section
+void SharedLobby::RecordChange()
+{
+	++m_numChanges;
+	SetEvent( m_changedEvent );
+}
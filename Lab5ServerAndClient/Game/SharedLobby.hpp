@@ -0,0 +1,88 @@
+#ifndef SHARED_LOBBY_HPP
+#define SHARED_LOBBY_HPP
+
+#include <map>
+#include <vector>
+
+#include "Engine/Networking/PeerAddress.hpp"
+#include "Engine/Utilities/PlatformThreading.hpp"
+
+#include "CS6Packet.hpp"
+#include "ConnectedClient.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//A client moving to a room owned by another shard. The whole client goes across so its
+//packet numbers and unacked reliable packets carry on where the old shard left off.
+struct ClientHandoff
+{
+	ConnectedClient	client;
+	GameID			gameIDToJoin;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+//A packet the kernel delivered to one shard for a client owned by another
+struct ForwardedPacket
+{
+	PeerAddress	sourceAddress;
+	CS6Packet	packet;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+//The only state the server shards share. Every shard lists every room from here, and looks up
+//which shard owns a client or room. Everything else a shard owns stays on its own thread.
+class SharedLobby
+{
+
+public:
+
+	SharedLobby();
+	~SharedLobby();
+
+	void SetNumShards( int numShards );
+
+	GameID	AddGame( int owningShardIndex );
+	void	RemoveGame( GameID gameID );
+	int		GetShardIndexOwningGame( GameID gameID ) const;
+	void	GetGameIDs( std::vector< GameID >& out_gameIDs ) const;
+	uint	GetVersion() const;
+
+	void	SetShardIndexOwningClient( const PeerAddress& clientAddress, int shardIndex );
+	void	RemoveClient( const PeerAddress& clientAddress, int shardIndex );
+	int		GetShardIndexOwningClient( const PeerAddress& clientAddress ) const;
+	int		GetNumClientsOwnedByShard( int shardIndex ) const;
+	int		GetNumGamesOwnedByShard( int shardIndex ) const;
+
+	void	ForwardPacketToShard( int shardIndex, const PeerAddress& sourceAddress, const CS6Packet& packet );
+	void	HandOffClientToShard( int shardIndex, const ClientHandoff& handoff );
+	void	TakeForwardedPackets( int shardIndex, std::vector< ForwardedPacket >& out_packets );
+	void	TakeClientHandoffs( int shardIndex, std::vector< ClientHandoff >& out_handoffs );
+
+	bool	WaitForChange( double maxSecondsToWait );
+	uint	GetNumChanges() const;
+
+	static const int NO_SHARD = -1;
+
+private:
+
+	void	RecordChange();
+
+	mutable CRITICAL_SECTION					m_lobbyCS;
+
+	std::map< GameID, int >						m_shardIndicesByGameID;
+	std::map< PeerAddress, int >				m_shardIndicesByClientAddress;
+
+	std::vector< std::vector< ForwardedPacket > >	m_forwardedPacketsByShard;
+	std::vector< std::vector< ClientHandoff > >		m_clientHandoffsByShard;
+
+	GameID	m_currentMaxGameID;
+	uint	m_version;
+
+	//any change to which shard owns what, for whoever draws the shards
+	HANDLE	m_changedEvent;
+	uint	m_numChanges;
+};
+
+
+#endif
@@ -0,0 +1,174 @@
+#include "BitStream.hpp"
+
+//Variable length values spend this many bits saying how many whole bytes follow
+const int VARIABLE_UINT_BYTE_COUNT_BITS = 2;
+
+//-----------------------------------------------------------------------------------------------
+static uint GetMaxQuantizedValue( int numBits )
+{
+	return static_cast< uint >( ( 1ULL << numBits ) - 1 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+BitWriter::BitWriter( char* buffer, int bufferSizeBytes )
+	: m_buffer( buffer )
+	, m_bufferSizeBytes( bufferSizeBytes )
+	, m_numBytesWritten( 0 )
+	, m_scratchBits( 0 )
+	, m_numScratchBits( 0 )
+	, m_hasOverflowed( false )
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Bits collect in a scratch word and whole bytes go to the buffer as soon as they fill
+void BitWriter::WriteBits( uint value, int numBits )
+{
+	if( numBits < 32 )
+	{
+		value &= GetMaxQuantizedValue( numBits );
+	}
+
+	m_scratchBits |= static_cast< uint64 >( value ) << m_numScratchBits;
+	m_numScratchBits += numBits;
+
+	while( m_numScratchBits >= 8 )
+	{
+		if( m_numBytesWritten < m_bufferSizeBytes )
+		{
+			m_buffer[ m_numBytesWritten ] = static_cast< char >( m_scratchBits & 0xFF );
+			++m_numBytesWritten;
+		}
+		else
+		{
+			m_hasOverflowed = true;
+		}
+
+		m_scratchBits >>= 8;
+		m_numScratchBits -= 8;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void BitWriter::WriteBool( bool value )
+{
+	WriteBits( value ? 1 : 0, 1 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Small numbers, like early packet numbers, cost 10 bits instead of 32
+void BitWriter::WriteVariableUint( uint value )
+{
+	int numBytes = 1;
+
+	while( numBytes < 4 && ( value >> ( numBytes * 8 ) ) != 0 )
+	{
+		++numBytes;
+	}
+
+	WriteBits( numBytes - 1, VARIABLE_UINT_BYTE_COUNT_BITS );
+	WriteBits( value, numBytes * 8 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Values outside the range are clamped to its ends. Precision is ( maxValue - minValue ) / 2^numBits.
+void BitWriter::WriteQuantizedFloat( float value, float minValue, float maxValue, int numBits )
+{
+	if( value < minValue )
+	{
+		value = minValue;
+	}
+	else if( value > maxValue )
+	{
+		value = maxValue;
+	}
+
+	float normalizedValue = ( value - minValue ) / ( maxValue - minValue );
+	uint quantizedValue = static_cast< uint >( normalizedValue * static_cast< float >( GetMaxQuantizedValue( numBits ) ) + 0.5f );
+
+	WriteBits( quantizedValue, numBits );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Pads the last partial byte with zeros and returns the number of bytes to send
+int BitWriter::Flush()
+{
+	if( m_numScratchBits > 0 )
+	{
+		WriteBits( 0, 8 - m_numScratchBits );
+	}
+
+	return m_numBytesWritten;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+BitReader::BitReader( const char* buffer, int numBytes )
+	: m_buffer( buffer )
+	, m_numBytes( numBytes )
+	, m_numBytesRead( 0 )
+	, m_scratchBits( 0 )
+	, m_numScratchBits( 0 )
+	, m_hasOverrun( false )
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+uint BitReader::ReadBits( int numBits )
+{
+	while( m_numScratchBits < numBits )
+	{
+		if( m_numBytesRead < m_numBytes )
+		{
+			m_scratchBits |= static_cast< uint64 >( static_cast< uchar >( m_buffer[ m_numBytesRead ] ) ) << m_numScratchBits;
+			++m_numBytesRead;
+		}
+		else
+		{
+			m_hasOverrun = true;
+		}
+
+		m_numScratchBits += 8;
+	}
+
+	uint value = static_cast< uint >( m_scratchBits & GetMaxQuantizedValue( numBits ) );
+
+	m_scratchBits >>= numBits;
+	m_numScratchBits -= numBits;
+
+	return value;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool BitReader::ReadBool()
+{
+	return ReadBits( 1 ) != 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+uint BitReader::ReadVariableUint()
+{
+	int numBytes = static_cast< int >( ReadBits( VARIABLE_UINT_BYTE_COUNT_BITS ) ) + 1;
+
+	return ReadBits( numBytes * 8 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+float BitReader::ReadQuantizedFloat( float minValue, float maxValue, int numBits )
+{
+	float normalizedValue = static_cast< float >( ReadBits( numBits ) ) / static_cast< float >( GetMaxQuantizedValue( numBits ) );
+
+	return minValue + ( normalizedValue * ( maxValue - minValue ) );
+}
@@ -0,0 +1,97 @@
+#ifndef BIT_STREAM_HPP
+#define BIT_STREAM_HPP
+
+#pragma once
+
+#include "Engine/Utilities/CommonUtilities.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Packs values into a caller's buffer using only as many bits as each one needs, lowest bit first.
+//Writing past the end of the buffer drops the value and marks the writer as overflowed, so a whole
+//packet can be written and checked once at the end.
+class BitWriter
+{
+public:
+
+	BitWriter( char* buffer, int bufferSizeBytes );
+
+	void WriteBits( uint value, int numBits );
+	void WriteBool( bool value );
+	void WriteVariableUint( uint value );
+	void WriteQuantizedFloat( float value, float minValue, float maxValue, int numBits );
+
+	int	 Flush();
+
+	inline int	GetNumBitsWritten() const;
+	inline bool HasOverflowed() const;
+
+private:
+
+	char*	m_buffer;
+	int		m_bufferSizeBytes;
+	int		m_numBytesWritten;
+	uint64	m_scratchBits;
+	int		m_numScratchBits;
+	bool	m_hasOverflowed;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+//Reads back what a BitWriter wrote, in the same order. Reading past the end returns zeros and marks
+//the reader as overrun, so a truncated packet is caught with one check at the end.
+class BitReader
+{
+public:
+
+	BitReader( const char* buffer, int numBytes );
+
+	uint	ReadBits( int numBits );
+	bool	ReadBool();
+	uint	ReadVariableUint();
+	float	ReadQuantizedFloat( float minValue, float maxValue, int numBits );
+
+	inline int	GetNumBytesRead() const;
+	inline bool HasOverrun() const;
+
+private:
+
+	const char*	m_buffer;
+	int			m_numBytes;
+	int			m_numBytesRead;
+	uint64		m_scratchBits;
+	int			m_numScratchBits;
+	bool		m_hasOverrun;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline int BitWriter::GetNumBitsWritten() const
+{
+	return ( m_numBytesWritten * 8 ) + m_numScratchBits;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline bool BitWriter::HasOverflowed() const
+{
+	return m_hasOverflowed;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Whole bytes, counting the one the last read finished in. After reading everything a BitWriter
+//wrote and flushed, this is exactly the size it flushed.
+inline int BitReader::GetNumBytesRead() const
+{
+	return m_numBytesRead;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline bool BitReader::HasOverrun() const
+{
+	return m_hasOverrun;
+}
+
+
+#endif
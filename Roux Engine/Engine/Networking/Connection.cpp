@@ -1,9 +1,17 @@
 #include "Connection.hpp"
+#include "IoUringSocket.hpp"
 
 //-----------------------------------------------------------------------------------------------
 Connection::Connection()
 	: m_socket( SOCKET_ERROR )
 	, m_socketAddrInfoLength( sizeof( m_socketAddressInfo ) )
+	, m_numKernelReceiveDrops( 0 )
+	, m_peakBytesReceivedAtOnce( 0 )
+	, m_canSendDatagramTrains( true )
+	, m_numDatagramTrainsSent( 0 )
+	, m_numDatagramsSentInTrains( 0 )
+	, m_numSendBufferDrops( 0 )
+	, m_ioUring( nullptr )
 {
 	memset( ( char* )&m_socketAddressInfo, 0, m_socketAddrInfoLength );
 }
@@ -11,5 +19,30 @@ Connection::Connection()
 //-----------------------------------------------------------------------------------------------
 Connection::~Connection()
 {
-
+	delete m_ioUring;
 }
+
+//-----------------------------------------------------------------------------------------------
+//Readies a closed connection's slot for reuse. The receive ring keeps its memory for the next socket.
+void Connection::Reset()
+{
+	m_socket = SOCKET_ERROR;
+	m_socketAddrInfoLength = sizeof( m_socketAddressInfo );
+	memset( ( char* )&m_socketAddressInfo, 0, m_socketAddrInfoLength );
+
+	m_receiveRing.ReleaseAllSlots();
+
+	m_numKernelReceiveDrops = 0;
+	m_peakBytesReceivedAtOnce = 0;
+
+	m_canSendDatagramTrains = true;
+	m_numDatagramTrainsSent = 0;
+	m_numDatagramsSentInTrains = 0;
+	m_numSendBufferDrops = 0;
+
+	delete m_ioUring;
+	m_ioUring = nullptr;
+
+	m_outgoingSimulator.Clear();
+	m_incomingSimulator.Clear();
+}
\ No newline at end of file
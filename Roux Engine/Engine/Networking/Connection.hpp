@@ -3,7 +3,12 @@
 
 #pragma once
 
-#include <WinSock2.h>
+#include "SocketPlatform.hpp"
+
+#include "DatagramRing.hpp"
+#include "NetworkSimulator.hpp"
+
+class IoUringSocket;
 
 //-----------------------------------------------------------------------------------------------
 class Connection
@@ -13,9 +18,35 @@ public:
 	Connection();
 	~Connection();
 
+	void Reset();
+
 	SOCKET				m_socket;
 	struct sockaddr_in	m_socketAddressInfo;
-	int					m_socketAddrInfoLength;
+	socklen_t			m_socketAddrInfoLength;
+
+	//Only allocated once something receives in place on this connection
+	DatagramRing		m_receiveRing;
+
+	//Kernel's running count where the platform tags datagrams with it, and the most bytes one drain
+	//of the socket has read, which shows how close the receive buffer came to overflowing
+	uint				m_numKernelReceiveDrops;
+	int					m_peakBytesReceivedAtOnce;
+
+	//Cleared the first time the kernel turns down a segmented send, every train after that goes out
+	//one datagram at a time
+	bool				m_canSendDatagramTrains;
+	uint				m_numDatagramTrainsSent;
+	uint				m_numDatagramsSentInTrains;
+
+	//Datagrams given up on because the send buffer was full, the same as losing them on the wire
+	uint				m_numSendBufferDrops;
+
+	//Only set while the connection runs on the io_uring backend
+	IoUringSocket*		m_ioUring;
+
+	//Only used while Network is simulating a bad link
+	NetworkSimulator	m_outgoingSimulator;
+	NetworkSimulator	m_incomingSimulator;
 };
 
 
@@ -0,0 +1,325 @@
+#include "ConnectionStats.hpp"
+
+#include <sstream>
+#include <iomanip>
+
+#include "Engine/Rendering/ConsoleLog.hpp"
+
+//Jacobson's gains, the same ones TCP uses for its round trip estimate
+const double ROUND_TRIP_SMOOTHING = 0.125;
+const double ROUND_TRIP_VARIANCE_SMOOTHING = 0.25;
+
+//Before the first sample, and the bounds after it. The floor covers acks that wait for the peer's
+//next send, the ceiling keeps a dead link from backing off for minutes.
+const double INITIAL_RETRANSMIT_TIMEOUT_SECONDS = 1.0;
+const double MIN_RETRANSMIT_TIMEOUT_SECONDS = 0.1;
+const double MAX_RETRANSMIT_TIMEOUT_SECONDS = 8.0;
+
+//-----------------------------------------------------------------------------------------------
+SocketStats::SocketStats()
+	: receiveBufferBytes( 0 )
+	, sendBufferBytes( 0 )
+	, canCountKernelDrops( false )
+	, numKernelReceiveDrops( 0 )
+	, peakBytesReceivedAtOnce( 0 )
+	, canSendDatagramTrains( false )
+	, numDatagramTrainsSent( 0 )
+	, numDatagramsSentInTrains( 0 )
+	, numSendBufferDrops( 0 )
+	, isUsingIoUring( false )
+	, numFailedQueuedSends( 0 )
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SocketStats::ConsolePrintStats( const std::string& socketName ) const
+{
+	if( ConsoleLog::s_currentLog == nullptr )
+	{
+		return;
+	}
+
+	std::ostringstream outputStringStream;
+
+	outputStringStream << socketName << ": receive buffer " << receiveBufferBytes << " bytes, send buffer " << sendBufferBytes << " bytes, ";
+
+	if( canCountKernelDrops )
+	{
+		outputStringStream << "kernel drops " << numKernelReceiveDrops << ", ";
+	}
+	else
+	{
+		outputStringStream << "kernel drops not reported, ";
+	}
+
+	outputStringStream << "most read at once " << peakBytesReceivedAtOnce << " bytes, ";
+
+	if( canSendDatagramTrains )
+	{
+		outputStringStream << numDatagramsSentInTrains << " datagrams sent in " << numDatagramTrainsSent << " segmented sends";
+	}
+	else
+	{
+		outputStringStream << "segmented sends unavailable";
+	}
+
+	outputStringStream << ", send buffer drops " << numSendBufferDrops;
+
+	if( isUsingIoUring )
+	{
+		outputStringStream << ", io_uring with " << numFailedQueuedSends << " failed sends";
+	}
+
+	ConsoleLog::s_currentLog->ConsolePrint( outputStringStream.str() );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------------------
+ConnectionStats::ConnectionStats()
+{
+	Reset();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ConnectionStats::Reset()
+{
+	m_numPacketsSent = 0;
+	m_numPacketsReceived = 0;
+	m_numBytesSent = 0;
+	m_numBytesReceived = 0;
+
+	m_numResends = 0;
+	m_numPacketsLost = 0;
+	m_numDuplicatesReceived = 0;
+	m_numSequencedPacketsReceived = 0;
+	m_highestSequencedPacketNumber = 0;
+	m_hasReceivedSequencedPacket = false;
+
+	m_smoothedRoundTripSeconds = 0.0;
+	m_roundTripVarianceSeconds = 0.0;
+	m_hasRoundTripSample = false;
+
+	m_unackedReliableSends.clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ConnectionStats::RecordPacketSent( int numBytes )
+{
+	++m_numPacketsSent;
+	m_numBytesSent += numBytes;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ConnectionStats::RecordPacketReceived( int numBytes )
+{
+	++m_numPacketsReceived;
+	m_numBytesReceived += numBytes;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ConnectionStats::RecordReliablePacketSent( uint packetNumber, double sendTimeSeconds )
+{
+	ReliableSendRecord& sendRecord = m_unackedReliableSends[ packetNumber ];
+
+	sendRecord.firstSendTimeSeconds = sendTimeSeconds;
+	sendRecord.wasResent = false;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ConnectionStats::RecordReliablePacketResent( uint packetNumber )
+{
+	++m_numResends;
+
+	auto foundIter = m_unackedReliableSends.find( packetNumber );
+
+	if( foundIter != m_unackedReliableSends.end() )
+	{
+		foundIter->second.wasResent = true;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Karn's rule, an ack for a resent packet could be answering any of the copies, so it gives no sample
+void ConnectionStats::RecordReliablePacketAcked( uint packetNumber, double ackArrivalTimeSeconds )
+{
+	auto foundIter = m_unackedReliableSends.find( packetNumber );
+
+	if( foundIter == m_unackedReliableSends.end() )
+	{
+		return;
+	}
+
+	if( !foundIter->second.wasResent )
+	{
+		AddRoundTripSample( ackArrivalTimeSeconds - foundIter->second.firstSendTimeSeconds );
+	}
+
+	m_unackedReliableSends.erase( foundIter );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//For reliable packets given up on without an ack, such as ones refused with a nack
+void ConnectionStats::RecordReliablePacketDropped( uint packetNumber )
+{
+	m_unackedReliableSends.erase( packetNumber );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//For a stream numbered one apart per send. Skipped numbers count as lost, and anything at or below
+//the highest number seen so far counts as a duplicate, since a late packet is as useless as a copy.
+void ConnectionStats::RecordSequencedPacketReceived( uint packetNumber )
+{
+	if( m_hasReceivedSequencedPacket && packetNumber <= m_highestSequencedPacketNumber )
+	{
+		RecordDuplicateReceived();
+		return;
+	}
+
+	if( m_hasReceivedSequencedPacket )
+	{
+		m_numPacketsLost += packetNumber - m_highestSequencedPacketNumber - 1;
+	}
+
+	++m_numSequencedPacketsReceived;
+	m_highestSequencedPacketNumber = packetNumber;
+	m_hasReceivedSequencedPacket = true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ConnectionStats::RecordDuplicateReceived()
+{
+	++m_numDuplicatesReceived;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+float ConnectionStats::GetLossRate() const
+{
+	uint numExpected = m_numSequencedPacketsReceived + m_numPacketsLost;
+
+	if( numExpected == 0 )
+	{
+		return 0.f;
+	}
+
+	return static_cast< float >( m_numPacketsLost ) / static_cast< float >( numExpected );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+float ConnectionStats::GetDuplicateRate() const
+{
+	if( m_numPacketsReceived == 0 )
+	{
+		return 0.f;
+	}
+
+	return static_cast< float >( m_numDuplicatesReceived ) / static_cast< float >( m_numPacketsReceived );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Jacobson's smoothed round trip plus four deviations, doubled for every time this packet has already
+//been resent. With Karn's rule keeping resent packets out of the samples, a bad link backs off
+//instead of feeding its own resends back into the estimate.
+double ConnectionStats::GetRetransmitTimeoutSeconds( int numTimesResent ) const
+{
+	double timeoutSeconds = INITIAL_RETRANSMIT_TIMEOUT_SECONDS;
+
+	if( m_hasRoundTripSample )
+	{
+		timeoutSeconds = m_smoothedRoundTripSeconds + ( 4.0 * m_roundTripVarianceSeconds );
+	}
+
+	if( timeoutSeconds < MIN_RETRANSMIT_TIMEOUT_SECONDS )
+	{
+		timeoutSeconds = MIN_RETRANSMIT_TIMEOUT_SECONDS;
+	}
+
+	for( int i = 0; i < numTimesResent && timeoutSeconds < MAX_RETRANSMIT_TIMEOUT_SECONDS; ++i )
+	{
+		timeoutSeconds *= 2.0;
+	}
+
+	if( timeoutSeconds > MAX_RETRANSMIT_TIMEOUT_SECONDS )
+	{
+		timeoutSeconds = MAX_RETRANSMIT_TIMEOUT_SECONDS;
+	}
+
+	return timeoutSeconds;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ConnectionStats::ConsolePrintStats( const std::string& connectionName ) const
+{
+	if( ConsoleLog::s_currentLog == nullptr )
+	{
+		return;
+	}
+
+	std::ostringstream outputStringStream;
+
+	outputStringStream << std::fixed << std::setprecision( 1 );
+
+	outputStringStream << connectionName << ": sent " << m_numPacketsSent << " packets / " << m_numBytesSent << " bytes, received " << m_numPacketsReceived << " packets / " << m_numBytesReceived << " bytes";
+	ConsoleLog::s_currentLog->ConsolePrint( outputStringStream.str() );
+
+	outputStringStream.str( "" );
+
+	if( m_hasRoundTripSample )
+	{
+		outputStringStream << "  rtt " << m_smoothedRoundTripSeconds * 1000.0 << "ms +/- " << m_roundTripVarianceSeconds * 1000.0 << "ms, ";
+	}
+	else
+	{
+		outputStringStream << "  rtt unknown, ";
+	}
+
+	outputStringStream << "resend after " << GetRetransmitTimeoutSeconds( 0 ) * 1000.0 << "ms, ";
+	outputStringStream << "loss " << GetLossRate() * 100.f << "%, duplicates " << GetDuplicateRate() * 100.f << "%, resends " << m_numResends;
+	ConsoleLog::s_currentLog->ConsolePrint( outputStringStream.str() );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Private Methods
+//-----------------------------------------------------------------------------------------------
+void ConnectionStats::AddRoundTripSample( double roundTripSeconds )
+{
+	if( roundTripSeconds < 0.0 )
+	{
+		return;
+	}
+
+	if( !m_hasRoundTripSample )
+	{
+		m_smoothedRoundTripSeconds = roundTripSeconds;
+		m_roundTripVarianceSeconds = roundTripSeconds * 0.5;
+		m_hasRoundTripSample = true;
+		return;
+	}
+
+	double error = roundTripSeconds - m_smoothedRoundTripSeconds;
+
+	if( error < 0.0 )
+	{
+		error = -error;
+	}
+
+	m_roundTripVarianceSeconds += ROUND_TRIP_VARIANCE_SMOOTHING * ( error - m_roundTripVarianceSeconds );
+	m_smoothedRoundTripSeconds += ROUND_TRIP_SMOOTHING * ( roundTripSeconds - m_smoothedRoundTripSeconds );
+}
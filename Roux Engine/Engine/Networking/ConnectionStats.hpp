@@ -0,0 +1,174 @@
+#ifndef CONNECTION_STATS_HPP
+#define CONNECTION_STATS_HPP
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "Engine/Utilities/CommonUtilities.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//What the kernel did with one socket, where ConnectionStats is what the game saw from one peer.
+//Drops the kernel counted are the network's fault only if the receive buffer never came close to
+//full; a peak near the buffer size means the reads came too late.
+struct SocketStats
+{
+	SocketStats();
+
+	void ConsolePrintStats( const std::string& socketName ) const;
+
+	int		receiveBufferBytes;
+	int		sendBufferBytes;
+	bool	canCountKernelDrops;
+	uint	numKernelReceiveDrops;
+	int		peakBytesReceivedAtOnce;
+	bool	canSendDatagramTrains;
+	uint	numDatagramTrainsSent;
+	uint	numDatagramsSentInTrains;
+	uint	numSendBufferDrops;
+	bool	isUsingIoUring;
+	uint	numFailedQueuedSends;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+//Link quality for one peer. Traffic counts are recorded on every send and receive. Round trip
+//time, loss and duplicates come from the packet numbers and acks the game layer already has.
+class ConnectionStats
+{
+public:
+
+	ConnectionStats();
+
+	void Reset();
+
+	void RecordPacketSent( int numBytes );
+	void RecordPacketReceived( int numBytes );
+
+	void RecordReliablePacketSent( uint packetNumber, double sendTimeSeconds );
+	void RecordReliablePacketResent( uint packetNumber );
+	void RecordReliablePacketAcked( uint packetNumber, double ackArrivalTimeSeconds );
+	void RecordReliablePacketDropped( uint packetNumber );
+
+	void RecordSequencedPacketReceived( uint packetNumber );
+	void RecordDuplicateReceived();
+
+	float GetLossRate() const;
+	float GetDuplicateRate() const;
+	double GetRetransmitTimeoutSeconds( int numTimesResent ) const;
+
+	void ConsolePrintStats( const std::string& connectionName ) const;
+
+	inline uint		GetNumPacketsSent() const;
+	inline uint		GetNumPacketsReceived() const;
+	inline uint64	GetNumBytesSent() const;
+	inline uint64	GetNumBytesReceived() const;
+	inline uint		GetNumResends() const;
+	inline uint		GetNumPacketsLost() const;
+	inline uint		GetNumDuplicatesReceived() const;
+	inline bool		HasRoundTripSample() const;
+	inline double	GetSmoothedRoundTripSeconds() const;
+	inline double	GetRoundTripVarianceSeconds() const;
+
+private:
+
+	void AddRoundTripSample( double roundTripSeconds );
+
+	struct ReliableSendRecord
+	{
+		double	firstSendTimeSeconds;
+		bool	wasResent;
+	};
+
+	uint	m_numPacketsSent;
+	uint	m_numPacketsReceived;
+	uint64	m_numBytesSent;
+	uint64	m_numBytesReceived;
+
+	uint	m_numResends;
+	uint	m_numPacketsLost;
+	uint	m_numDuplicatesReceived;
+	uint	m_numSequencedPacketsReceived;
+	uint	m_highestSequencedPacketNumber;
+	bool	m_hasReceivedSequencedPacket;
+
+	double	m_smoothedRoundTripSeconds;
+	double	m_roundTripVarianceSeconds;
+	bool	m_hasRoundTripSample;
+
+	std::map< uint, ReliableSendRecord > m_unackedReliableSends;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline uint ConnectionStats::GetNumPacketsSent() const
+{
+	return m_numPacketsSent;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline uint ConnectionStats::GetNumPacketsReceived() const
+{
+	return m_numPacketsReceived;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline uint64 ConnectionStats::GetNumBytesSent() const
+{
+	return m_numBytesSent;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline uint64 ConnectionStats::GetNumBytesReceived() const
+{
+	return m_numBytesReceived;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline uint ConnectionStats::GetNumResends() const
+{
+	return m_numResends;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline uint ConnectionStats::GetNumPacketsLost() const
+{
+	return m_numPacketsLost;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline uint ConnectionStats::GetNumDuplicatesReceived() const
+{
+	return m_numDuplicatesReceived;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline bool ConnectionStats::HasRoundTripSample() const
+{
+	return m_hasRoundTripSample;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline double ConnectionStats::GetSmoothedRoundTripSeconds() const
+{
+	return m_smoothedRoundTripSeconds;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline double ConnectionStats::GetRoundTripVarianceSeconds() const
+{
+	return m_roundTripVarianceSeconds;
+}
+
+
+#endif
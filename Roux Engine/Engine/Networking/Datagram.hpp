@@ -0,0 +1,33 @@
+#ifndef DATAGRAM_HPP
+#define DATAGRAM_HPP
+
+#pragma once
+
+#include "PeerAddress.hpp"
+
+//Largest UDP payload that fits an ethernet frame without IP fragmentation
+const int MAX_DATAGRAM_SIZE_BYTES = 1472;
+
+//-----------------------------------------------------------------------------------------------
+//Caller owns the buffer, Network fills in bytesReceived, the address it came from and when it was read
+struct ReceivedDatagram
+{
+	char*				buffer;
+	int					bufferSize;
+	int					bytesReceived;
+	PeerAddress			sourceAddress;
+	double				arrivalTimeSeconds;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+//Message memory must stay valid until the send call returns
+struct OutgoingDatagram
+{
+	const char*			message;
+	int					messageSize;
+	PeerAddress			destinationAddress;
+};
+
+
+#endif
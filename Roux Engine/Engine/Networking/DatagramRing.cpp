@@ -0,0 +1,104 @@
+#include "DatagramRing.hpp"
+
+//-----------------------------------------------------------------------------------------------
+DatagramRing::DatagramRing()
+	: m_slotMemory( nullptr )
+	, m_slots( nullptr )
+	, m_numSlots( 0 )
+	, m_slotSizeBytes( 0 )
+	, m_writeIndex( 0 )
+	, m_numSlotsInUse( 0 )
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+DatagramRing::~DatagramRing()
+{
+	Free();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//One allocation for every slot. Slot sizes are rounded up to 8 bytes so each buffer can be read
+//directly as a packet struct.
+void DatagramRing::Allocate( int numSlots, int slotSizeBytes )
+{
+	Free();
+
+	const int SLOT_ALIGNMENT_BYTES = 8;
+
+	m_numSlots = numSlots;
+	m_slotSizeBytes = ( slotSizeBytes + SLOT_ALIGNMENT_BYTES - 1 ) & ~( SLOT_ALIGNMENT_BYTES - 1 );
+
+	m_slotMemory = new char[ m_numSlots * m_slotSizeBytes ];
+	m_slots = new ReceivedDatagram[ m_numSlots ];
+
+	for( int i = 0; i < m_numSlots; ++i )
+	{
+		m_slots[ i ].buffer = m_slotMemory + ( i * m_slotSizeBytes );
+		m_slots[ i ].bufferSize = m_slotSizeBytes;
+		m_slots[ i ].bytesReceived = 0;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DatagramRing::Free()
+{
+	delete[] m_slotMemory;
+	delete[] m_slots;
+
+	m_slotMemory = nullptr;
+	m_slots = nullptr;
+	m_numSlots = 0;
+	m_slotSizeBytes = 0;
+	m_writeIndex = 0;
+	m_numSlotsInUse = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Only returns the run up to the end of the ring, callers receive again to use the wrapped part
+ReceivedDatagram* DatagramRing::GetFreeSlots( int& out_numContiguousFreeSlots )
+{
+	int numFreeSlots = m_numSlots - m_numSlotsInUse;
+	int numSlotsBeforeWrap = m_numSlots - m_writeIndex;
+
+	out_numContiguousFreeSlots = numFreeSlots;
+
+	if( numSlotsBeforeWrap < out_numContiguousFreeSlots )
+	{
+		out_numContiguousFreeSlots = numSlotsBeforeWrap;
+	}
+
+	if( out_numContiguousFreeSlots <= 0 )
+	{
+		out_numContiguousFreeSlots = 0;
+		return nullptr;
+	}
+
+	return &m_slots[ m_writeIndex ];
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DatagramRing::CommitSlots( int numSlotsFilled )
+{
+	if( m_numSlots == 0 )
+	{
+		return;
+	}
+
+	m_writeIndex = ( m_writeIndex + numSlotsFilled ) % m_numSlots;
+	m_numSlotsInUse += numSlotsFilled;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Everything handed out so far becomes invalid
+void DatagramRing::ReleaseAllSlots()
+{
+	m_numSlotsInUse = 0;
+}
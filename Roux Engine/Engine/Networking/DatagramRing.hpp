@@ -0,0 +1,56 @@
+#ifndef DATAGRAM_RING_HPP
+#define DATAGRAM_RING_HPP
+
+#pragma once
+
+#include "Datagram.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Fixed set of receive buffers, allocated once and reused forever. Slots are filled in order and
+//stay put until released, so received datagrams can be read in place instead of copied out.
+class DatagramRing
+{
+public:
+
+	DatagramRing();
+	~DatagramRing();
+
+	void Allocate( int numSlots, int slotSizeBytes );
+	void Free();
+
+	ReceivedDatagram*	GetFreeSlots( int& out_numContiguousFreeSlots );
+	void				CommitSlots( int numSlotsFilled );
+	void				ReleaseAllSlots();
+
+	inline bool IsAllocated() const;
+	inline int	GetNumSlotsInUse() const;
+
+private:
+
+	DatagramRing( const DatagramRing& );
+	void operator=( const DatagramRing& );
+
+	char*				m_slotMemory;
+	ReceivedDatagram*	m_slots;
+	int					m_numSlots;
+	int					m_slotSizeBytes;
+	int					m_writeIndex;
+	int					m_numSlotsInUse;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline bool DatagramRing::IsAllocated() const
+{
+	return m_slots != nullptr;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline int DatagramRing::GetNumSlotsInUse() const
+{
+	return m_numSlotsInUse;
+}
+
+
+#endif
@@ -0,0 +1,205 @@
+#include "FragmentReassembler.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+//Well past the longest the sender backs off between resends, so only abandoned messages run out
+const double MESSAGE_REASSEMBLY_TIMEOUT_SECONDS = 20.0;
+
+//-----------------------------------------------------------------------------------------------
+FragmentReassembler::FragmentReassembler( int fragmentPayloadBytes, int maxMessageBytes )
+	: m_fragmentPayloadBytes( fragmentPayloadBytes )
+	, m_maxMessageBytes( maxMessageBytes )
+{
+	for( int i = 0; i < NUM_FRAGMENTED_MESSAGE_BUFFERS; ++i )
+	{
+		m_messages[ i ].bytes.resize( maxMessageBytes );
+		m_messages[ i ].hasFragment.resize( MAX_FRAGMENTS_PER_MESSAGE );
+	}
+
+	Clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Only the last fragment may be short. The message is done once every fragment is in, and waits for
+//PopCompletedMessage so it can be handed over in the same order as the rest of the reliable stream.
+FragmentResult FragmentReassembler::AddFragment( uint messageID, int fragmentIndex, int numFragments, const unsigned char* fragmentBytes, int numBytes, double currentTimeSeconds )
+{
+	bool isLastFragment = fragmentIndex == numFragments - 1;
+	int messageOffset = fragmentIndex * m_fragmentPayloadBytes;
+
+	if( numFragments < 1 || numFragments > MAX_FRAGMENTS_PER_MESSAGE || fragmentIndex < 0 || fragmentIndex >= numFragments )
+	{
+		return FRAGMENT_Invalid;
+	}
+
+	if( numBytes < 0 || numBytes > m_fragmentPayloadBytes || ( !isLastFragment && numBytes != m_fragmentPayloadBytes ) || messageOffset + numBytes > m_maxMessageBytes )
+	{
+		return FRAGMENT_Invalid;
+	}
+
+	if( WasRecentlyCompleted( messageID ) )
+	{
+		return FRAGMENT_Duplicate;
+	}
+
+	PartialMessage* message = FindMessage( messageID );
+
+	if( message == nullptr )
+	{
+		message = StartMessage( messageID, numFragments, currentTimeSeconds );
+
+		if( message == nullptr )
+		{
+			return FRAGMENT_NoRoom;
+		}
+	}
+
+	if( message->numFragments != numFragments )
+	{
+		return FRAGMENT_Invalid;
+	}
+
+	if( message->hasFragment[ fragmentIndex ] )
+	{
+		return FRAGMENT_Duplicate;
+	}
+
+	memcpy( &message->bytes[ messageOffset ], fragmentBytes, numBytes );
+
+	message->hasFragment[ fragmentIndex ] = true;
+	++message->numFragmentsReceived;
+	message->lastFragmentTimeSeconds = currentTimeSeconds;
+
+	if( isLastFragment )
+	{
+		message->numBytes = messageOffset + numBytes;
+	}
+
+	return FRAGMENT_Stored;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//False until every fragment of the message is in. Its buffer is free again afterwards.
+bool FragmentReassembler::PopCompletedMessage( uint messageID, std::vector< unsigned char >& out_message )
+{
+	PartialMessage* message = FindMessage( messageID );
+
+	if( message == nullptr || message->numFragmentsReceived < message->numFragments )
+	{
+		return false;
+	}
+
+	out_message.assign( message->bytes.begin(), message->bytes.begin() + message->numBytes );
+	message->isInUse = false;
+
+	RecordCompleted( messageID );
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FragmentReassembler::DropExpiredMessages( double currentTimeSeconds )
+{
+	for( int i = 0; i < NUM_FRAGMENTED_MESSAGE_BUFFERS; ++i )
+	{
+		PartialMessage& message = m_messages[ i ];
+
+		if( message.isInUse && currentTimeSeconds - message.lastFragmentTimeSeconds >= MESSAGE_REASSEMBLY_TIMEOUT_SECONDS )
+		{
+			message.isInUse = false;
+			++m_numMessagesDropped;
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//For a new sender, whose message IDs start over
+void FragmentReassembler::Clear()
+{
+	for( int i = 0; i < NUM_FRAGMENTED_MESSAGE_BUFFERS; ++i )
+	{
+		m_messages[ i ].isInUse = false;
+	}
+
+	m_numRecentlyCompleted = 0;
+	m_nextRecentlyCompletedIndex = 0;
+	m_numMessagesDropped = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Private Methods
+//-----------------------------------------------------------------------------------------------
+FragmentReassembler::PartialMessage* FragmentReassembler::FindMessage( uint messageID )
+{
+	for( int i = 0; i < NUM_FRAGMENTED_MESSAGE_BUFFERS; ++i )
+	{
+		if( m_messages[ i ].isInUse && m_messages[ i ].messageID == messageID )
+		{
+			return &m_messages[ i ];
+		}
+	}
+
+	return nullptr;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+FragmentReassembler::PartialMessage* FragmentReassembler::StartMessage( uint messageID, int numFragments, double currentTimeSeconds )
+{
+	for( int i = 0; i < NUM_FRAGMENTED_MESSAGE_BUFFERS; ++i )
+	{
+		PartialMessage& message = m_messages[ i ];
+
+		if( message.isInUse )
+		{
+			continue;
+		}
+
+		std::fill( message.hasFragment.begin(), message.hasFragment.end(), false );
+
+		message.messageID = messageID;
+		message.numFragments = numFragments;
+		message.numFragmentsReceived = 0;
+		message.numBytes = 0;
+		message.lastFragmentTimeSeconds = currentTimeSeconds;
+		message.isInUse = true;
+
+		return &message;
+	}
+
+	return nullptr;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool FragmentReassembler::WasRecentlyCompleted( uint messageID ) const
+{
+	for( int i = 0; i < m_numRecentlyCompleted; ++i )
+	{
+		if( m_recentlyCompletedMessageIDs[ i ] == messageID )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FragmentReassembler::RecordCompleted( uint messageID )
+{
+	m_recentlyCompletedMessageIDs[ m_nextRecentlyCompletedIndex ] = messageID;
+	m_nextRecentlyCompletedIndex = ( m_nextRecentlyCompletedIndex + 1 ) % NUM_RECENTLY_COMPLETED_MESSAGES;
+
+	if( m_numRecentlyCompleted < NUM_RECENTLY_COMPLETED_MESSAGES )
+	{
+		++m_numRecentlyCompleted;
+	}
+}
@@ -0,0 +1,95 @@
+#ifndef FRAGMENT_REASSEMBLER_HPP
+#define FRAGMENT_REASSEMBLER_HPP
+
+#pragma once
+
+#include <vector>
+
+#include "Engine/Utilities/CommonUtilities.hpp"
+
+//A fragment index and count each fit in a byte on the wire
+const int MAX_FRAGMENTS_PER_MESSAGE = 255;
+
+//Messages put together at once, and finished ones remembered so their resent fragments are spotted
+const int NUM_FRAGMENTED_MESSAGE_BUFFERS = 8;
+const int NUM_RECENTLY_COMPLETED_MESSAGES = 32;
+
+enum FragmentResult
+{
+	FRAGMENT_Stored,
+	FRAGMENT_Duplicate,
+	FRAGMENT_NoRoom,
+	FRAGMENT_Invalid
+};
+
+//-----------------------------------------------------------------------------------------------
+//Puts messages too big for one packet back together from their fragments. Every fragment but the
+//last carries exactly the fragment payload size, so each one lands at a fixed offset whatever order
+//they arrive in. Memory is a fixed number of message buffers allocated up front. Fragments are meant
+//to travel reliably, one packet each, so only the ones lost are ever resent. One that finds every
+//buffer busy is refused, and should not be acked so the sender tries it again later. A message still
+//missing fragments long after the last one arrived was given up on by the sender and is dropped.
+class FragmentReassembler
+{
+public:
+
+	FragmentReassembler( int fragmentPayloadBytes, int maxMessageBytes );
+
+	FragmentResult	AddFragment( uint messageID, int fragmentIndex, int numFragments, const unsigned char* fragmentBytes, int numBytes, double currentTimeSeconds );
+	bool			PopCompletedMessage( uint messageID, std::vector< unsigned char >& out_message );
+	void			DropExpiredMessages( double currentTimeSeconds );
+	void			Clear();
+
+	inline uint GetNumMessagesDropped() const;
+
+private:
+
+	struct PartialMessage
+	{
+		std::vector< unsigned char >	bytes;
+		std::vector< bool >				hasFragment;
+		uint							messageID;
+		int								numFragments;
+		int								numFragmentsReceived;
+		int								numBytes;
+		double							lastFragmentTimeSeconds;
+		bool							isInUse;
+	};
+
+	PartialMessage*	FindMessage( uint messageID );
+	PartialMessage*	StartMessage( uint messageID, int numFragments, double currentTimeSeconds );
+	bool			WasRecentlyCompleted( uint messageID ) const;
+	void			RecordCompleted( uint messageID );
+
+	PartialMessage	m_messages[ NUM_FRAGMENTED_MESSAGE_BUFFERS ];
+	uint			m_recentlyCompletedMessageIDs[ NUM_RECENTLY_COMPLETED_MESSAGES ];
+	int				m_numRecentlyCompleted;
+	int				m_nextRecentlyCompletedIndex;
+
+	int				m_fragmentPayloadBytes;
+	int				m_maxMessageBytes;
+	uint			m_numMessagesDropped;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline uint FragmentReassembler::GetNumMessagesDropped() const
+{
+	return m_numMessagesDropped;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//How many fragments the sender splits a message into, always at least one
+inline int GetNumFragmentsForMessage( int numBytes, int fragmentPayloadBytes )
+{
+	if( numBytes <= 0 )
+	{
+		return 1;
+	}
+
+	return ( numBytes + fragmentPayloadBytes - 1 ) / fragmentPayloadBytes;
+}
+
+
+#endif
@@ -0,0 +1,274 @@
+#define STATIC
+
+#include "HostNameResolver.hpp"
+
+#include "Engine/Utilities/EventSystem.hpp"
+#include "Engine/Utilities/JobManager.hpp"
+#include "Engine/Utilities/Time.hpp"
+
+#include "Engine/Utilities/NewAndDeleteOverrides.hpp"
+
+//Resolvers do not hand TTLs back through getaddrinfo, so every answer is kept this long
+const double RESOLVED_HOST_CACHE_SECONDS = 300.0;
+
+//Failures are remembered briefly so a bad name does not queue a lookup every frame
+const double FAILED_HOST_CACHE_SECONDS = 5.0;
+
+//-----------------------------------------------------------------------------------------------
+ResolveHostNameJob::ResolveHostNameJob( const std::string& hostName, TypeOfWork typeOfWork, JobPriority priority )
+	: Job( "", typeOfWork, priority )
+	, m_hostName( hostName )
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Runs on a worker thread
+void ResolveHostNameJob::Execute()
+{
+	u_long ipAddress = INADDR_NONE;
+	bool didResolve = HostNameResolver::LookUpHostName( m_hostName, ipAddress );
+
+	HostNameResolver::GetInstance().StoreResult( m_hostName, didResolve, ipAddress );
+	HostNameResolver::SetResultProperties( m_callbackProperties, m_hostName, didResolve, ipAddress );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Runs on the main thread from JobManager::Update
+void ResolveHostNameJob::FireCallbackEvent()
+{
+	EventSystem& eventSystem = EventSystem::GetInstance();
+	std::vector< std::string > eventNamesToFire;
+
+	HostNameResolver::GetInstance().TakeEventsWaitingOnHostName( m_hostName, eventNamesToFire );
+
+	for( int i = 0; i < static_cast< int >( eventNamesToFire.size() ); ++i )
+	{
+		eventSystem.FireEvent( eventNamesToFire[ i ], m_callbackProperties );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------------------
+HostNameResolver::HostNameResolver()
+	: m_hasCreatedWorkerThread( false )
+{
+	InitializeCriticalSection( &m_resolverCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+HostNameResolver::~HostNameResolver()
+{
+	DeleteCriticalSection( &m_resolverCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Dotted IPs and fresh cached answers fire the event before this returns. Otherwise the lookup is
+//queued and the event fires from JobManager::Update, along with every other caller waiting on the name.
+void HostNameResolver::ResolveAsync( const std::string& hostName, const std::string& eventNameToFireOnCallback )
+{
+	u_long ipAddress = inet_addr( hostName.c_str() );
+
+	if( ipAddress != INADDR_NONE )
+	{
+		FireResultEvent( eventNameToFireOnCallback, hostName, true, ipAddress );
+		return;
+	}
+
+	EnterCriticalSection( &m_resolverCS );
+
+	auto foundCacheIter = m_cachedAddressesByHostName.find( hostName );
+
+	if( foundCacheIter != m_cachedAddressesByHostName.end() && foundCacheIter->second.expiryTimeSeconds > Time::GetCurrentTimeInSeconds() )
+	{
+		bool didResolve = foundCacheIter->second.didResolve;
+		ipAddress = foundCacheIter->second.ipAddress;
+
+		LeaveCriticalSection( &m_resolverCS );
+
+		FireResultEvent( eventNameToFireOnCallback, hostName, didResolve, ipAddress );
+		return;
+	}
+
+	std::vector< std::string >& waitingEventNames = m_waitingEventNamesByHostName[ hostName ];
+	bool isLookUpAlreadyQueued = !waitingEventNames.empty();
+
+	waitingEventNames.push_back( eventNameToFireOnCallback );
+
+	LeaveCriticalSection( &m_resolverCS );
+
+	if( isLookUpAlreadyQueued )
+	{
+		return;
+	}
+
+	//with no worker threads JobManager runs jobs inline on the main thread, which is the stall this avoids
+	JobManager& jobManager = JobManager::GetInstance();
+
+	if( !m_hasCreatedWorkerThread )
+	{
+		jobManager.CreateAndAddWorkerThreads( WORK_FILE_IO, 1 );
+		m_hasCreatedWorkerThread = true;
+	}
+
+	jobManager.AddJobToPendingList( new ResolveHostNameJob( hostName ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//For callers that cannot continue without the address. Still uses and fills the cache.
+bool HostNameResolver::ResolveBlocking( const std::string& hostName, u_long& out_ipAddress )
+{
+	if( TryGetCachedAddress( hostName, out_ipAddress ) )
+	{
+		return true;
+	}
+
+	bool didResolve = LookUpHostName( hostName, out_ipAddress );
+
+	StoreResult( hostName, didResolve, out_ipAddress );
+
+	return didResolve;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Only true for a fresh answer that actually resolved
+bool HostNameResolver::TryGetCachedAddress( const std::string& hostName, u_long& out_ipAddress )
+{
+	bool isCached = false;
+
+	EnterCriticalSection( &m_resolverCS );
+
+	auto foundIter = m_cachedAddressesByHostName.find( hostName );
+
+	if( foundIter != m_cachedAddressesByHostName.end() && foundIter->second.didResolve && foundIter->second.expiryTimeSeconds > Time::GetCurrentTimeInSeconds() )
+	{
+		out_ipAddress = foundIter->second.ipAddress;
+		isCached = true;
+	}
+
+	LeaveCriticalSection( &m_resolverCS );
+
+	return isCached;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void HostNameResolver::ClearCache()
+{
+	EnterCriticalSection( &m_resolverCS );
+
+	m_cachedAddressesByHostName.clear();
+
+	LeaveCriticalSection( &m_resolverCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Blocks. getaddrinfo is safe to call from any thread, unlike the shared hostent gethostbyname returns.
+//Dotted IPs come straight back without touching the resolver.
+STATIC bool HostNameResolver::LookUpHostName( const std::string& hostName, u_long& out_ipAddress )
+{
+	u_long ipAddress = inet_addr( hostName.c_str() );
+
+	if( ipAddress != INADDR_NONE )
+	{
+		out_ipAddress = ipAddress;
+		return true;
+	}
+
+	struct addrinfo hints;
+	struct addrinfo* results = nullptr;
+
+	memset( &hints, 0, sizeof( hints ) );
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_protocol = IPPROTO_UDP;
+
+	if( getaddrinfo( hostName.c_str(), nullptr, &hints, &results ) != 0 || results == nullptr )
+	{
+		return false;
+	}
+
+	//grabs first ip from host
+	out_ipAddress = ( ( struct sockaddr_in* )results->ai_addr )->sin_addr.s_addr;
+
+	freeaddrinfo( results );
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void HostNameResolver::SetResultProperties( NamedProperties& out_properties, const std::string& hostName, bool didResolve, u_long ipAddress )
+{
+	std::string ipAddressAsString = "";
+
+	if( didResolve )
+	{
+		struct in_addr address;
+
+		address.s_addr = ipAddress;
+		ipAddressAsString = inet_ntoa( address );
+	}
+
+	out_properties.Set( "hostName", hostName );
+	out_properties.Set( "ipAddress", ipAddressAsString );
+	out_properties.Set( "didResolve", didResolve );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Private Methods
+//-----------------------------------------------------------------------------------------------
+STATIC void HostNameResolver::FireResultEvent( const std::string& eventName, const std::string& hostName, bool didResolve, u_long ipAddress )
+{
+	NamedProperties resultProperties;
+
+	SetResultProperties( resultProperties, hostName, didResolve, ipAddress );
+
+	EventSystem::GetInstance().FireEvent( eventName, resultProperties );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void HostNameResolver::StoreResult( const std::string& hostName, bool didResolve, u_long ipAddress )
+{
+	CachedHostAddress cachedAddress;
+
+	cachedAddress.ipAddress = ipAddress;
+	cachedAddress.didResolve = didResolve;
+	cachedAddress.expiryTimeSeconds = Time::GetCurrentTimeInSeconds() + ( didResolve ? RESOLVED_HOST_CACHE_SECONDS : FAILED_HOST_CACHE_SECONDS );
+
+	EnterCriticalSection( &m_resolverCS );
+
+	m_cachedAddressesByHostName[ hostName ] = cachedAddress;
+
+	LeaveCriticalSection( &m_resolverCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void HostNameResolver::TakeEventsWaitingOnHostName( const std::string& hostName, std::vector< std::string >& out_eventNames )
+{
+	out_eventNames.clear();
+
+	EnterCriticalSection( &m_resolverCS );
+
+	auto foundIter = m_waitingEventNamesByHostName.find( hostName );
+
+	if( foundIter != m_waitingEventNamesByHostName.end() )
+	{
+		foundIter->second.swap( out_eventNames );
+		m_waitingEventNamesByHostName.erase( foundIter );
+	}
+
+	LeaveCriticalSection( &m_resolverCS );
+}
@@ -0,0 +1,84 @@
+#ifndef HOST_NAME_RESOLVER_HPP
+#define HOST_NAME_RESOLVER_HPP
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SocketPlatform.hpp"
+#include "Engine/Utilities/Job.hpp"
+#include "Engine/Utilities/PlatformThreading.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Looks a host name up on a file IO worker. Fires every event waiting on that name from the
+//main thread once done, with "hostName", "ipAddress" ( empty on failure ) and "didResolve".
+class ResolveHostNameJob : public Job
+{
+public:
+
+	ResolveHostNameJob( const std::string& hostName, TypeOfWork typeOfWork = WORK_FILE_IO, JobPriority priority = PRIORITY_HIGH );
+
+	virtual void Execute();
+	virtual void FireCallbackEvent();
+
+private:
+
+	std::string m_hostName;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+//Resolves host names to IPv4 addresses without stalling the caller, and remembers the answers
+//for a while so reconnecting to the same host does not go back to the resolver.
+class HostNameResolver
+{
+public:
+
+	static HostNameResolver& GetInstance()
+	{
+		static HostNameResolver instance;
+
+		return instance;
+	}
+
+	void ResolveAsync( const std::string& hostName, const std::string& eventNameToFireOnCallback );
+	bool ResolveBlocking( const std::string& hostName, u_long& out_ipAddress );
+	bool TryGetCachedAddress( const std::string& hostName, u_long& out_ipAddress );
+	void ClearCache();
+
+	static bool LookUpHostName( const std::string& hostName, u_long& out_ipAddress );
+	static void SetResultProperties( NamedProperties& out_properties, const std::string& hostName, bool didResolve, u_long ipAddress );
+
+private:
+
+	friend class ResolveHostNameJob;
+
+	HostNameResolver();
+	~HostNameResolver();
+
+	HostNameResolver( HostNameResolver const& );
+	void operator=( HostNameResolver const& );
+
+	static void FireResultEvent( const std::string& eventName, const std::string& hostName, bool didResolve, u_long ipAddress );
+
+	void StoreResult( const std::string& hostName, bool didResolve, u_long ipAddress );
+	void TakeEventsWaitingOnHostName( const std::string& hostName, std::vector< std::string >& out_eventNames );
+
+	struct CachedHostAddress
+	{
+		u_long	ipAddress;
+		bool	didResolve;
+		double	expiryTimeSeconds;
+	};
+
+	std::map< std::string, CachedHostAddress >				m_cachedAddressesByHostName;
+	std::map< std::string, std::vector< std::string > >		m_waitingEventNamesByHostName;
+	bool													m_hasCreatedWorkerThread;
+
+	mutable CRITICAL_SECTION								m_resolverCS;
+};
+
+
+#endif
@@ -0,0 +1,669 @@
+#define STATIC
+
+#include "IoUringSocket.hpp"
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+
+//Completions are told apart by these bits, the low bits of a send's hold its slot index
+const unsigned long long RECEIVE_USER_DATA = 0;
+const unsigned long long SEND_USER_DATA_FLAG = 1ULL << 32;
+const unsigned long long CANCEL_USER_DATA_FLAG = 1ULL << 33;
+const unsigned long long SLOT_INDEX_USER_DATA_MASK = 0xFFFFFFFFULL;
+
+const unsigned short RECEIVE_BUFFER_GROUP_ID = 0;
+
+//The kernel fills each receive buffer with this header, then the source address, then the control
+//messages, then the datagram
+const int RECEIVE_BUFFER_HEADER_BYTES = sizeof( struct io_uring_recvmsg_out ) + sizeof( struct sockaddr_in ) + CMSG_SPACE( sizeof( uint ) );
+#endif
+
+//-----------------------------------------------------------------------------------------------
+IoUringSocket::IoUringSocket()
+#ifdef __linux__
+	: m_submissionHead( nullptr )
+	, m_submissionTail( nullptr )
+	, m_submissionArray( nullptr )
+	, m_submissionMask( 0 )
+	, m_submissionEntries( nullptr )
+	, m_completionHead( nullptr )
+	, m_completionTail( nullptr )
+	, m_completionMask( 0 )
+	, m_completionEntries( nullptr )
+	, m_ringMemory( nullptr )
+	, m_ringMemoryBytes( 0 )
+	, m_submissionEntriesBytes( 0 )
+	, m_receiveBufferRing( nullptr )
+	, m_receiveBufferRingBytes( 0 )
+	, m_receiveBufferMask( 0 )
+	, m_numReceiveBuffers( 0 )
+	, m_receiveBufferSizeBytes( 0 )
+	, m_receiveBufferMemory( nullptr )
+	, m_isReceivePosted( false )
+	, m_sendSlotMemory( nullptr )
+	, m_firstCompletedReceiveIndex( 0 )
+	, m_numUnsubmittedEntries( 0 )
+	, m_numRequestsInFlight( 0 )
+	, m_isShuttingDown( false )
+	, m_socket( INVALID_SOCKET )
+#else
+	: m_socket( INVALID_SOCKET )
+#endif
+	, m_ringDescriptor( -1 )
+	, m_numFailedSends( 0 )
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+IoUringSocket::~IoUringSocket()
+{
+	ShutDown();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Only says the build has io_uring, the running kernel can still turn StartUp down
+STATIC bool IoUringSocket::IsSupported()
+{
+#ifdef __linux__
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+#ifdef __linux__
+
+//-----------------------------------------------------------------------------------------------
+//The receive buffer count is rounded up to a power of two. Sends, the receive and ShutDown's cancel
+//are the most requests ever in flight, so the queues are sized to never overflow.
+bool IoUringSocket::StartUp( SOCKET socketToDrive, int numReceiveBuffers, int numSendSlots )
+{
+	ShutDown();
+
+	struct io_uring_params parameters;
+	memset( &parameters, 0, sizeof( parameters ) );
+
+	unsigned numEntries = static_cast< unsigned >( numSendSlots + 2 );
+	int ringDescriptor = static_cast< int >( syscall( __NR_io_uring_setup, numEntries, &parameters ) );
+
+	if( ringDescriptor < 0 )
+	{
+		return false;
+	}
+
+	const unsigned REQUIRED_FEATURES = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_FAST_POLL | IORING_FEAT_NODROP;
+
+	if( ( parameters.features & REQUIRED_FEATURES ) != REQUIRED_FEATURES )
+	{
+		close( ringDescriptor );
+		return false;
+	}
+
+	size_t submissionRingBytes = parameters.sq_off.array + parameters.sq_entries * sizeof( unsigned );
+	size_t completionRingBytes = parameters.cq_off.cqes + parameters.cq_entries * sizeof( struct io_uring_cqe );
+
+	m_ringMemoryBytes = ( submissionRingBytes > completionRingBytes ) ? submissionRingBytes : completionRingBytes;
+	m_ringMemory = mmap( nullptr, m_ringMemoryBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_SQ_RING );
+
+	if( m_ringMemory == MAP_FAILED )
+	{
+		m_ringMemory = nullptr;
+		close( ringDescriptor );
+		return false;
+	}
+
+	m_submissionEntriesBytes = parameters.sq_entries * sizeof( struct io_uring_sqe );
+	void* submissionEntriesMemory = mmap( nullptr, m_submissionEntriesBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_SQES );
+
+	if( submissionEntriesMemory == MAP_FAILED )
+	{
+		munmap( m_ringMemory, m_ringMemoryBytes );
+		m_ringMemory = nullptr;
+		close( ringDescriptor );
+		return false;
+	}
+
+	//the buffer ring has to start on a page, which an anonymous mapping always does
+	m_numReceiveBuffers = 1;
+
+	while( m_numReceiveBuffers < numReceiveBuffers )
+	{
+		m_numReceiveBuffers *= 2;
+	}
+
+	m_receiveBufferRingBytes = m_numReceiveBuffers * sizeof( struct io_uring_buf );
+	void* receiveBufferRingMemory = mmap( nullptr, m_receiveBufferRingBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+	struct io_uring_buf_reg bufferRingRegistration;
+	memset( &bufferRingRegistration, 0, sizeof( bufferRingRegistration ) );
+
+	bufferRingRegistration.ring_addr = reinterpret_cast< unsigned long long >( receiveBufferRingMemory );
+	bufferRingRegistration.ring_entries = static_cast< unsigned >( m_numReceiveBuffers );
+	bufferRingRegistration.bgid = RECEIVE_BUFFER_GROUP_ID;
+
+	//buffer rings are Linux 5.19, and the multishot receive that needs them 6.0
+	if( receiveBufferRingMemory == MAP_FAILED || syscall( __NR_io_uring_register, ringDescriptor, IORING_REGISTER_PBUF_RING, &bufferRingRegistration, 1 ) < 0 )
+	{
+		if( receiveBufferRingMemory != MAP_FAILED )
+		{
+			munmap( receiveBufferRingMemory, m_receiveBufferRingBytes );
+		}
+
+		munmap( submissionEntriesMemory, m_submissionEntriesBytes );
+		munmap( m_ringMemory, m_ringMemoryBytes );
+		m_ringMemory = nullptr;
+		close( ringDescriptor );
+		return false;
+	}
+
+	char* ringBytes = static_cast< char* >( m_ringMemory );
+
+	m_submissionHead = reinterpret_cast< unsigned* >( ringBytes + parameters.sq_off.head );
+	m_submissionTail = reinterpret_cast< unsigned* >( ringBytes + parameters.sq_off.tail );
+	m_submissionArray = reinterpret_cast< unsigned* >( ringBytes + parameters.sq_off.array );
+	m_submissionMask = *reinterpret_cast< unsigned* >( ringBytes + parameters.sq_off.ring_mask );
+	m_submissionEntries = static_cast< struct io_uring_sqe* >( submissionEntriesMemory );
+
+	m_completionHead = reinterpret_cast< unsigned* >( ringBytes + parameters.cq_off.head );
+	m_completionTail = reinterpret_cast< unsigned* >( ringBytes + parameters.cq_off.tail );
+	m_completionMask = *reinterpret_cast< unsigned* >( ringBytes + parameters.cq_off.ring_mask );
+	m_completionEntries = reinterpret_cast< struct io_uring_cqe* >( ringBytes + parameters.cq_off.cqes );
+
+	m_socket = socketToDrive;
+	m_ringDescriptor = ringDescriptor;
+	m_numFailedSends = 0;
+	m_isShuttingDown = false;
+
+	m_receiveBufferRing = static_cast< struct io_uring_buf_ring* >( receiveBufferRingMemory );
+	m_receiveBufferMask = static_cast< unsigned short >( m_numReceiveBuffers - 1 );
+	m_receiveBufferSizeBytes = RECEIVE_BUFFER_HEADER_BYTES + MAX_DATAGRAM_SIZE_BYTES;
+	m_receiveBufferMemory = new char[ m_numReceiveBuffers * m_receiveBufferSizeBytes ];
+	m_completedReceives.reserve( m_numReceiveBuffers );
+
+	for( int i = 0; i < m_numReceiveBuffers; ++i )
+	{
+		ReturnReceiveBuffer( i );
+	}
+
+	//only the name and control lengths are read, they set how much of each buffer goes to those
+	memset( &m_receiveMessage, 0, sizeof( m_receiveMessage ) );
+	m_receiveMessage.msg_namelen = sizeof( struct sockaddr_in );
+	m_receiveMessage.msg_controllen = CMSG_SPACE( sizeof( uint ) );
+
+	//send slots point into themselves, so the list is sized once and never grows
+	m_sendSlotMemory = new char[ numSendSlots * MAX_DATAGRAM_SIZE_BYTES ];
+	m_sendSlots.resize( numSendSlots );
+	m_freeSendSlotIndices.reserve( numSendSlots );
+
+	for( int i = 0; i < numSendSlots; ++i )
+	{
+		SendSlot& slot = m_sendSlots[ i ];
+
+		memset( &slot.message, 0, sizeof( slot.message ) );
+		slot.payload.iov_base = m_sendSlotMemory + ( i * MAX_DATAGRAM_SIZE_BYTES );
+		slot.payload.iov_len = 0;
+		slot.message.msg_name = &slot.destinationAddress;
+		slot.message.msg_namelen = sizeof( slot.destinationAddress );
+		slot.message.msg_iov = &slot.payload;
+		slot.message.msg_iovlen = 1;
+
+		m_freeSendSlotIndices.push_back( i );
+	}
+
+	PostReceive();
+	SubmitQueuedEntries();
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//The kernel may still be writing into a receive buffer, so the receive is cancelled and everything
+//in flight waited out before any memory is freed
+void IoUringSocket::ShutDown()
+{
+	if( m_ringDescriptor == -1 )
+	{
+		return;
+	}
+
+	m_isShuttingDown = true;
+
+	SubmitQueuedEntries();
+	HarvestCompletions();
+
+	if( m_isReceivePosted )
+	{
+		struct io_uring_sqe* entry = GetNextSubmissionEntry();
+
+		entry->opcode = IORING_OP_ASYNC_CANCEL;
+		entry->fd = -1;
+		entry->addr = RECEIVE_USER_DATA;
+		entry->user_data = CANCEL_USER_DATA_FLAG;
+
+		SubmitQueuedEntries();
+	}
+
+	while( m_numRequestsInFlight > 0 && WaitForCompletion() )
+	{
+		HarvestCompletions();
+	}
+
+	munmap( m_receiveBufferRing, m_receiveBufferRingBytes );
+	munmap( m_submissionEntries, m_submissionEntriesBytes );
+	munmap( m_ringMemory, m_ringMemoryBytes );
+	close( m_ringDescriptor );
+
+	delete[] m_receiveBufferMemory;
+	delete[] m_sendSlotMemory;
+
+	m_submissionHead = nullptr;
+	m_submissionTail = nullptr;
+	m_submissionArray = nullptr;
+	m_submissionEntries = nullptr;
+	m_completionHead = nullptr;
+	m_completionTail = nullptr;
+	m_completionEntries = nullptr;
+	m_ringMemory = nullptr;
+	m_receiveBufferRing = nullptr;
+	m_receiveBufferMemory = nullptr;
+	m_sendSlotMemory = nullptr;
+
+	m_sendSlots.clear();
+	m_freeSendSlotIndices.clear();
+	m_completedReceives.clear();
+	m_firstCompletedReceiveIndex = 0;
+	m_numUnsubmittedEntries = 0;
+	m_numRequestsInFlight = 0;
+	m_isReceivePosted = false;
+
+	m_socket = INVALID_SOCKET;
+	m_ringDescriptor = -1;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Copies the datagram into a send slot, so the caller's memory is free once this returns. Nothing
+//reaches the kernel until SubmitQueuedEntries. False when the datagram does not fit a slot.
+bool IoUringSocket::QueueSend( const struct sockaddr_in& destinationAddress, const char* message, int messageSize )
+{
+	if( m_ringDescriptor == -1 || messageSize < 0 || messageSize > MAX_DATAGRAM_SIZE_BYTES )
+	{
+		return false;
+	}
+
+	if( m_freeSendSlotIndices.empty() )
+	{
+		SubmitQueuedEntries();
+		HarvestCompletions();
+	}
+
+	//every slot is on its way to the kernel, so one of them finishing is only a short wait
+	while( m_freeSendSlotIndices.empty() )
+	{
+		if( !WaitForCompletion() )
+		{
+			return false;
+		}
+
+		HarvestCompletions();
+	}
+
+	int sendSlotIndex = m_freeSendSlotIndices.back();
+	m_freeSendSlotIndices.pop_back();
+
+	SendSlot& slot = m_sendSlots[ sendSlotIndex ];
+
+	memcpy( slot.payload.iov_base, message, messageSize );
+	slot.payload.iov_len = messageSize;
+	slot.destinationAddress = destinationAddress;
+
+	struct io_uring_sqe* entry = GetNextSubmissionEntry();
+
+	entry->opcode = IORING_OP_SENDMSG;
+	entry->fd = m_socket;
+	entry->addr = reinterpret_cast< unsigned long long >( &slot.message );
+	entry->len = 1;
+	entry->user_data = SEND_USER_DATA_FLAG | static_cast< unsigned long long >( sendSlotIndex );
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//One system call for everything queued since the last one
+void IoUringSocket::SubmitQueuedEntries()
+{
+	while( m_numUnsubmittedEntries > 0 )
+	{
+		int numSubmitted = static_cast< int >( syscall( __NR_io_uring_enter, m_ringDescriptor, m_numUnsubmittedEntries, 0, 0, nullptr, 0 ) );
+
+		if( numSubmitted < 0 )
+		{
+			if( errno == EINTR )
+			{
+				continue;
+			}
+
+			//busy means completions are backed up, reading them lets the kernel take more
+			if( errno == EBUSY )
+			{
+				HarvestCompletions();
+				continue;
+			}
+
+			return;
+		}
+
+		m_numUnsubmittedEntries -= static_cast< unsigned >( numSubmitted );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Same contract as Network's socket receive. Buffers go back to the kernel as soon as they are copied.
+int IoUringSocket::PopReceivedDatagrams( ReceivedDatagram* datagrams, int maxNumDatagrams, uint& inout_numKernelReceiveDrops )
+{
+	HarvestCompletions();
+
+	int numDatagramsPopped = 0;
+
+	while( numDatagramsPopped < maxNumDatagrams && m_firstCompletedReceiveIndex < static_cast< int >( m_completedReceives.size() ) )
+	{
+		const CompletedReceive& completedReceive = m_completedReceives[ m_firstCompletedReceiveIndex ];
+		++m_firstCompletedReceiveIndex;
+
+		char* receiveBuffer = m_receiveBufferMemory + ( completedReceive.bufferIndex * m_receiveBufferSizeBytes );
+		const struct io_uring_recvmsg_out* receiveHeader = reinterpret_cast< const struct io_uring_recvmsg_out* >( receiveBuffer );
+
+		char* sourceAddress = receiveBuffer + sizeof( struct io_uring_recvmsg_out );
+		char* controlMessages = sourceAddress + m_receiveMessage.msg_namelen;
+		char* payload = controlMessages + m_receiveMessage.msg_controllen;
+
+		ReceivedDatagram& datagram = datagrams[ numDatagramsPopped ];
+
+		//a datagram too big for the buffer was cut short, what landed is all there is
+		int numBytes = completedReceive.numBytesInBuffer - static_cast< int >( payload - receiveBuffer );
+
+		if( numBytes > static_cast< int >( receiveHeader->payloadlen ) )
+		{
+			numBytes = static_cast< int >( receiveHeader->payloadlen );
+		}
+
+		if( numBytes > datagram.bufferSize )
+		{
+			numBytes = datagram.bufferSize;
+		}
+
+		memcpy( datagram.buffer, payload, numBytes );
+
+		struct sockaddr_in sourceSocketAddress;
+		memcpy( &sourceSocketAddress, sourceAddress, sizeof( sourceSocketAddress ) );
+
+		datagram.bytesReceived = numBytes;
+		datagram.sourceAddress = PeerAddress( sourceSocketAddress );
+
+#ifdef SO_RXQ_OVFL
+		struct msghdr controlHeader;
+
+		memset( &controlHeader, 0, sizeof( controlHeader ) );
+		controlHeader.msg_control = controlMessages;
+		controlHeader.msg_controllen = receiveHeader->controllen;
+
+		for( struct cmsghdr* controlMessage = CMSG_FIRSTHDR( &controlHeader ); controlMessage != nullptr; controlMessage = CMSG_NXTHDR( &controlHeader, controlMessage ) )
+		{
+			if( controlMessage->cmsg_level == SOL_SOCKET && controlMessage->cmsg_type == SO_RXQ_OVFL )
+			{
+				memcpy( &inout_numKernelReceiveDrops, CMSG_DATA( controlMessage ), sizeof( uint ) );
+			}
+		}
+#endif
+
+		ReturnReceiveBuffer( completedReceive.bufferIndex );
+
+		++numDatagramsPopped;
+	}
+
+	if( m_firstCompletedReceiveIndex == static_cast< int >( m_completedReceives.size() ) )
+	{
+		m_completedReceives.clear();
+		m_firstCompletedReceiveIndex = 0;
+	}
+
+	//the receive stops once the kernel runs out of buffers, and starts again now some are back
+	if( !m_isReceivePosted && numDatagramsPopped > 0 )
+	{
+		PostReceive();
+		SubmitQueuedEntries();
+	}
+
+	return numDatagramsPopped;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool IoUringSocket::HasReceivedDatagrams()
+{
+	HarvestCompletions();
+
+	return m_firstCompletedReceiveIndex < static_cast< int >( m_completedReceives.size() );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Private Methods
+//-----------------------------------------------------------------------------------------------
+//No kernel polling thread, so the kernel only reads entries inside io_uring_enter and the tail can
+//move before the entry is filled in
+struct io_uring_sqe* IoUringSocket::GetNextSubmissionEntry()
+{
+	unsigned tail = *m_submissionTail;
+
+	if( tail - __atomic_load_n( m_submissionHead, __ATOMIC_ACQUIRE ) > m_submissionMask )
+	{
+		SubmitQueuedEntries();
+	}
+
+	unsigned entryIndex = tail & m_submissionMask;
+	struct io_uring_sqe* entry = &m_submissionEntries[ entryIndex ];
+
+	memset( entry, 0, sizeof( *entry ) );
+	m_submissionArray[ entryIndex ] = entryIndex;
+
+	__atomic_store_n( m_submissionTail, tail + 1, __ATOMIC_RELEASE );
+
+	++m_numUnsubmittedEntries;
+	++m_numRequestsInFlight;
+
+	return entry;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Multishot, so one request keeps completing, once per datagram, until the buffers run out. Only one
+//waiter ever sits on the socket, where a receive posted per buffer would wake all of them per datagram.
+void IoUringSocket::PostReceive()
+{
+	struct io_uring_sqe* entry = GetNextSubmissionEntry();
+
+	entry->opcode = IORING_OP_RECVMSG;
+	entry->fd = m_socket;
+	entry->addr = reinterpret_cast< unsigned long long >( &m_receiveMessage );
+	entry->len = 1;
+	entry->ioprio = IORING_RECV_MULTISHOT;
+	entry->flags = IOSQE_BUFFER_SELECT;
+	entry->buf_group = RECEIVE_BUFFER_GROUP_ID;
+	entry->user_data = RECEIVE_USER_DATA;
+
+	m_isReceivePosted = true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void IoUringSocket::ReturnReceiveBuffer( int bufferIndex )
+{
+	//the ring is indexed as plain entries, in C++ the header's bufs member sits past an empty struct
+	//and lands at the wrong offset
+	struct io_uring_buf* ringEntries = reinterpret_cast< struct io_uring_buf* >( m_receiveBufferRing );
+
+	unsigned short tail = m_receiveBufferRing->tail;
+	struct io_uring_buf& buffer = ringEntries[ tail & m_receiveBufferMask ];
+
+	buffer.addr = reinterpret_cast< unsigned long long >( m_receiveBufferMemory + ( bufferIndex * m_receiveBufferSizeBytes ) );
+	buffer.len = static_cast< unsigned >( m_receiveBufferSizeBytes );
+	buffer.bid = static_cast< unsigned short >( bufferIndex );
+
+	__atomic_store_n( &m_receiveBufferRing->tail, static_cast< unsigned short >( tail + 1 ), __ATOMIC_RELEASE );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Sends give their slot back and filled receive buffers wait to be popped
+void IoUringSocket::HarvestCompletions()
+{
+	unsigned head = *m_completionHead;
+	unsigned tail = __atomic_load_n( m_completionTail, __ATOMIC_ACQUIRE );
+
+	while( head != tail )
+	{
+		const struct io_uring_cqe& completion = m_completionEntries[ head & m_completionMask ];
+
+		unsigned long long userData = completion.user_data;
+
+		if( ( userData & CANCEL_USER_DATA_FLAG ) != 0 )
+		{
+			//nothing to do, the cancelled receive completes on its own
+			--m_numRequestsInFlight;
+		}
+		else if( ( userData & SEND_USER_DATA_FLAG ) != 0 )
+		{
+			if( completion.res < 0 )
+			{
+				++m_numFailedSends;
+			}
+
+			m_freeSendSlotIndices.push_back( static_cast< int >( userData & SLOT_INDEX_USER_DATA_MASK ) );
+			--m_numRequestsInFlight;
+		}
+		else
+		{
+			if( ( completion.flags & IORING_CQE_F_BUFFER ) != 0 )
+			{
+				CompletedReceive completedReceive;
+
+				completedReceive.bufferIndex = static_cast< int >( completion.flags >> IORING_CQE_BUFFER_SHIFT );
+				completedReceive.numBytesInBuffer = completion.res;
+
+				//a buffer that came back with an error still has to go back on the ring
+				if( completion.res >= 0 )
+				{
+					m_completedReceives.push_back( completedReceive );
+				}
+				else
+				{
+					ReturnReceiveBuffer( completedReceive.bufferIndex );
+				}
+			}
+
+			if( ( completion.flags & IORING_CQE_F_MORE ) == 0 )
+			{
+				m_isReceivePosted = false;
+				--m_numRequestsInFlight;
+			}
+		}
+
+		++head;
+	}
+
+	__atomic_store_n( m_completionHead, head, __ATOMIC_RELEASE );
+
+	//ended for some reason other than running dry, so there are buffers to start again with
+	if( !m_isReceivePosted && !m_isShuttingDown && static_cast< int >( m_completedReceives.size() ) - m_firstCompletedReceiveIndex < m_numReceiveBuffers )
+	{
+		PostReceive();
+		SubmitQueuedEntries();
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool IoUringSocket::WaitForCompletion()
+{
+	for( ;; )
+	{
+		int result = static_cast< int >( syscall( __NR_io_uring_enter, m_ringDescriptor, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0 ) );
+
+		if( result >= 0 )
+		{
+			return true;
+		}
+
+		if( errno != EINTR )
+		{
+			return false;
+		}
+	}
+}
+
+#else
+
+//-----------------------------------------------------------------------------------------------
+bool IoUringSocket::StartUp( SOCKET socketToDrive, int numReceiveBuffers, int numSendSlots )
+{
+	( void )socketToDrive;
+	( void )numReceiveBuffers;
+	( void )numSendSlots;
+
+	return false;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void IoUringSocket::ShutDown()
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool IoUringSocket::QueueSend( const struct sockaddr_in& destinationAddress, const char* message, int messageSize )
+{
+	( void )destinationAddress;
+	( void )message;
+	( void )messageSize;
+
+	return false;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void IoUringSocket::SubmitQueuedEntries()
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int IoUringSocket::PopReceivedDatagrams( ReceivedDatagram* datagrams, int maxNumDatagrams, uint& inout_numKernelReceiveDrops )
+{
+	( void )datagrams;
+	( void )maxNumDatagrams;
+	( void )inout_numKernelReceiveDrops;
+
+	return 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool IoUringSocket::HasReceivedDatagrams()
+{
+	return false;
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef IO_URING_SOCKET_HPP
+#define IO_URING_SOCKET_HPP
+
+#pragma once
+
+#include <vector>
+
+#include "SocketPlatform.hpp"
+#include "Datagram.hpp"
+#include "Engine/Utilities/CommonUtilities.hpp"
+
+#ifdef __linux__
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+#endif
+
+//-----------------------------------------------------------------------------------------------
+//Drives one UDP socket through a Linux io_uring. One receive stays posted for good and the kernel
+//lands every datagram in a buffer from a ring set up ahead of time, so reading a tick's worth is a
+//walk over the completion queue with no system call. Sends are copied into their own slots and
+//queued, then go to the kernel together in one call. Needs Linux 6.0, anywhere older StartUp fails
+//and Network keeps using plain non-blocking calls.
+class IoUringSocket
+{
+public:
+
+	IoUringSocket();
+	~IoUringSocket();
+
+	bool StartUp( SOCKET socketToDrive, int numReceiveBuffers, int numSendSlots );
+	void ShutDown();
+
+	bool QueueSend( const struct sockaddr_in& destinationAddress, const char* message, int messageSize );
+	void SubmitQueuedEntries();
+
+	int  PopReceivedDatagrams( ReceivedDatagram* datagrams, int maxNumDatagrams, uint& inout_numKernelReceiveDrops );
+	bool HasReceivedDatagrams();
+
+	inline bool IsRunning() const;
+	inline int	GetRingDescriptor() const;
+	inline uint GetNumFailedSends() const;
+
+	static bool IsSupported();
+
+private:
+
+	IoUringSocket( const IoUringSocket& );
+	void operator=( const IoUringSocket& );
+
+#ifdef __linux__
+	struct SendSlot
+	{
+		struct msghdr		message;
+		struct iovec		payload;
+		struct sockaddr_in	destinationAddress;
+	};
+
+	struct CompletedReceive
+	{
+		int	bufferIndex;
+		int	numBytesInBuffer;
+	};
+
+	struct io_uring_sqe*	GetNextSubmissionEntry();
+	void					PostReceive();
+	void					ReturnReceiveBuffer( int bufferIndex );
+	void					HarvestCompletions();
+	bool					WaitForCompletion();
+
+	//the kernel's ring indices, shared through the mapped memory
+	unsigned*				m_submissionHead;
+	unsigned*				m_submissionTail;
+	unsigned*				m_submissionArray;
+	unsigned				m_submissionMask;
+	struct io_uring_sqe*	m_submissionEntries;
+
+	unsigned*				m_completionHead;
+	unsigned*				m_completionTail;
+	unsigned				m_completionMask;
+	struct io_uring_cqe*	m_completionEntries;
+
+	void*					m_ringMemory;
+	size_t					m_ringMemoryBytes;
+	size_t					m_submissionEntriesBytes;
+
+	//buffers the kernel picks from for each datagram it receives, handed back once copied out
+	struct io_uring_buf_ring*	m_receiveBufferRing;
+	size_t						m_receiveBufferRingBytes;
+	unsigned short				m_receiveBufferMask;
+	int							m_numReceiveBuffers;
+	int							m_receiveBufferSizeBytes;
+	char*						m_receiveBufferMemory;
+	struct msghdr				m_receiveMessage;
+	bool						m_isReceivePosted;
+
+	std::vector< SendSlot >		m_sendSlots;
+	std::vector< int >			m_freeSendSlotIndices;
+	char*						m_sendSlotMemory;
+
+	//filled buffers, oldest first, waiting to be copied out
+	std::vector< CompletedReceive >	m_completedReceives;
+	int								m_firstCompletedReceiveIndex;
+
+	unsigned					m_numUnsubmittedEntries;
+	int							m_numRequestsInFlight;
+	bool						m_isShuttingDown;
+#endif
+
+	SOCKET	m_socket;
+	int		m_ringDescriptor;
+	uint	m_numFailedSends;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline bool IoUringSocket::IsRunning() const
+{
+	return m_ringDescriptor != -1;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Reads as ready to select and poll whenever completions are waiting
+inline int IoUringSocket::GetRingDescriptor() const
+{
+	return m_ringDescriptor;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline uint IoUringSocket::GetNumFailedSends() const
+{
+	return m_numFailedSends;
+}
+
+
+#endif
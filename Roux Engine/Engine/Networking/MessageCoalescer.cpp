@@ -0,0 +1,86 @@
+#include "MessageCoalescer.hpp"
+
+#include <cstring>
+
+//Enough for a busy tick to a busy peer without growing
+const int NUM_DATAGRAMS_TO_RESERVE = 8;
+
+//-----------------------------------------------------------------------------------------------
+MessageCoalescer::MessageCoalescer()
+	: m_maxDatagramSizeBytes( MAX_DATAGRAM_SIZE_BYTES )
+	, m_isLastDatagramFinished( true )
+{
+	m_messageBytes.reserve( NUM_DATAGRAMS_TO_RESERVE * MAX_DATAGRAM_SIZE_BYTES );
+	m_datagramEndOffsets.reserve( NUM_DATAGRAMS_TO_RESERVE );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Anything over what Network can send in one datagram is capped to it. Datagrams already packed
+//keep the size they were packed at.
+void MessageCoalescer::SetMaxDatagramSize( int maxDatagramSizeBytes )
+{
+	if( maxDatagramSizeBytes > MAX_DATAGRAM_SIZE_BYTES )
+	{
+		maxDatagramSizeBytes = MAX_DATAGRAM_SIZE_BYTES;
+	}
+
+	m_maxDatagramSizeBytes = maxDatagramSizeBytes;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Goes on the end of the last datagram if it fits there, otherwise starts the next one. False, and
+//nothing appended, for a message too big for any datagram.
+bool MessageCoalescer::AppendMessage( const void* message, int messageSize )
+{
+	if( messageSize <= 0 || messageSize > m_maxDatagramSizeBytes )
+	{
+		return false;
+	}
+
+	int numBytesPacked = static_cast< int >( m_messageBytes.size() );
+	int lastDatagramStartOffset = ( m_datagramEndOffsets.size() > 1 ) ? m_datagramEndOffsets[ m_datagramEndOffsets.size() - 2 ] : 0;
+
+	if( m_isLastDatagramFinished || numBytesPacked - lastDatagramStartOffset + messageSize > m_maxDatagramSizeBytes )
+	{
+		m_datagramEndOffsets.push_back( numBytesPacked );
+		m_isLastDatagramFinished = false;
+	}
+
+	m_messageBytes.resize( numBytesPacked + messageSize );
+	memcpy( &m_messageBytes[ numBytesPacked ], message, messageSize );
+
+	m_datagramEndOffsets.back() = numBytesPacked + messageSize;
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//The next message starts a new datagram, for callers packing several peers' messages in turn
+void MessageCoalescer::FinishDatagram()
+{
+	m_isLastDatagramFinished = true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Keeps the memory for the next tick
+void MessageCoalescer::Clear()
+{
+	m_messageBytes.clear();
+	m_datagramEndOffsets.clear();
+	m_isLastDatagramFinished = true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+const char* MessageCoalescer::GetDatagram( int datagramIndex, int& out_datagramSize ) const
+{
+	int startOffset = ( datagramIndex > 0 ) ? m_datagramEndOffsets[ datagramIndex - 1 ] : 0;
+
+	out_datagramSize = m_datagramEndOffsets[ datagramIndex ] - startOffset;
+
+	return &m_messageBytes[ startOffset ];
+}
@@ -0,0 +1,63 @@
+#ifndef MESSAGE_COALESCER_HPP
+#define MESSAGE_COALESCER_HPP
+
+#pragma once
+
+#include <vector>
+
+#include "Datagram.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Collects one peer's messages over a tick and packs them back to back into as few datagrams as
+//fit under the max datagram size, so small messages stop paying 28 bytes of UDP/IP header each.
+//Nothing is added between messages, so they have to tell their own length: fixed size structs, or
+//encodings the receiver can read one after another. Datagrams stay valid until the next append.
+class MessageCoalescer
+{
+public:
+
+	MessageCoalescer();
+
+	void SetMaxDatagramSize( int maxDatagramSizeBytes );
+
+	bool AppendMessage( const void* message, int messageSize );
+	void FinishDatagram();
+	void Clear();
+
+	const char* GetDatagram( int datagramIndex, int& out_datagramSize ) const;
+
+	inline int	GetNumDatagrams() const;
+	inline int	GetMaxDatagramSize() const;
+	inline bool IsEmpty() const;
+
+private:
+
+	std::vector< char >	m_messageBytes;
+	std::vector< int >	m_datagramEndOffsets;
+	int					m_maxDatagramSizeBytes;
+	bool				m_isLastDatagramFinished;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline int MessageCoalescer::GetNumDatagrams() const
+{
+	return static_cast< int >( m_datagramEndOffsets.size() );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline int MessageCoalescer::GetMaxDatagramSize() const
+{
+	return m_maxDatagramSizeBytes;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline bool MessageCoalescer::IsEmpty() const
+{
+	return m_datagramEndOffsets.empty();
+}
+
+
+#endif
@@ -1,12 +1,50 @@
+#define UNUSED(x) (void)(x);
+#define STATIC
+
 #include "Network.hpp"
 
+#include "Engine/Networking/HostNameResolver.hpp"
+#include "Engine/Networking/IoUringSocket.hpp"
+#include "Engine/Utilities/Time.hpp"
+
+//Enough for a busy server tick, one allocation per receiving connection
+const int RECEIVE_RING_NUM_SLOTS = 256;
+
+//Connection IDs are ( generation << 16 ) | slot index. Generations start at 1, so 0 is never a valid ID.
+const int CONNECTION_ID_INDEX_BITS = 16;
+const int CONNECTION_ID_INDEX_MASK = ( 1 << CONNECTION_ID_INDEX_BITS ) - 1;
+const int MAX_CONNECTION_GENERATION = 0x7FFF;
+
+//The kernel's cap on segments per send, and the most UDP payload one IPv4 send can carry
+const int MAX_DATAGRAMS_PER_TRAIN = 64;
+const int MAX_DATAGRAM_TRAIN_BYTES = 65507;
+
+//Datagrams handed to one recvmmsg or sendmmsg, small enough for the headers to live on the stack
+const int MAX_DATAGRAMS_PER_SYSTEM_CALL = 64;
+
+//Receives kept posted and sends that can wait on the kernel at once, per io_uring connection
+const int IO_URING_NUM_RECEIVE_BUFFERS = 256;
+const int IO_URING_NUM_SEND_SLOTS = 256;
+
 //-----------------------------------------------------------------------------------------------
 Network::Network()
-	: m_currentNumConnectionIDs( 0 )
-	, m_hostInformation( nullptr )
-	, m_hasBeenInitialized( false )
+	: m_hasBeenInitialized( false )
+	, m_numFreeConnectionSlots( 0 )
+	, m_defaultReceiveBufferBytes( 0 )
+	, m_defaultSendBufferBytes( 0 )
+	, m_defaultSocketBackend( SOCKET_BACKEND_NON_BLOCKING )
 {
-	ZeroMemory( &m_winSockAddrData, sizeof( m_winSockAddrData ) );
+	//lowest slots come off the free list first
+	for( int i = MAX_NUM_CONNECTIONS - 1; i >= 0; --i )
+	{
+		m_connectionSlots[ i ].generation = 1;
+		m_connectionSlots[ i ].isInUse = false;
+
+		m_freeConnectionSlotIndices[ m_numFreeConnectionSlots ] = i;
+		++m_numFreeConnectionSlots;
+	}
+
+	InitializeCriticalSection( &m_connectionsCS );
 }
 
 
@@ -14,19 +52,17 @@ Network::Network()
 Network::~Network()
 {
 	ShutDown();
+
+	DeleteCriticalSection( &m_connectionsCS );
 }
 
 
 //-----------------------------------------------------------------------------------------------
 void Network::Startup()
 {
-	int result = 0;
-
-	result = WSAStartup( MAKEWORD( 2, 2 ), &m_winSockAddrData );
-
-	if( result != 0 )
+	if( !SocketPlatform::StartUp() )
 	{
-		printf( "Failed, Error Code: %d", WSAGetLastError() );
+		printf( "Failed, Error Code: %d", SocketPlatform::GetLastError() );
 		exit( EXIT_FAILURE );
 	}
 }
@@ -35,41 +71,41 @@ void Network::Startup()
 //-----------------------------------------------------------------------------------------------
 void Network::ShutDown()
 {
-	WSACleanup();
+	SocketPlatform::ShutDown();
 }
 
 
 //-----------------------------------------------------------------------------------------------
+//Blocks on the resolver unless the name is already cached. Use HostNameResolver::ResolveAsync
+//first and create the socket from the resulting IP to keep the caller responsive.
 int Network::CreateUDPSocketFromDomainNameAndPort( const char* domainAsString, u_short port )
 {
-	Connection* newConnection = new Connection();
+	u_long hostIPAddress = INADDR_NONE;
+
+	if( !HostNameResolver::GetInstance().ResolveBlocking( domainAsString, hostIPAddress ) )
+	{
+		printf( "Could not resolve host %s", domainAsString );
+		exit( EXIT_FAILURE );
+	}
 
-	int newConnectionID = m_currentNumConnectionIDs;
-	++m_currentNumConnectionIDs;
+	int newConnectionID = INVALID_CONNECTION_ID;
+	Connection* newConnection = AllocateConnection( newConnectionID );
 
 	newConnection->m_socket = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
 
 	if( newConnection->m_socket == SOCKET_ERROR )
 	{
-		printf( "socket() failed, Error Code: %d", WSAGetLastError() );
+		printf( "socket() failed, Error Code: %d", SocketPlatform::GetLastError() );
 		exit( EXIT_FAILURE );
 	}
 
-	m_hostInformation = gethostbyname( domainAsString );
-
 	memset( ( char* )&newConnection->m_socketAddressInfo, 0, newConnection->m_socketAddrInfoLength );
 
 	newConnection->m_socketAddressInfo.sin_family = AF_INET;
 	newConnection->m_socketAddressInfo.sin_port = htons( port );
-	//grabs first ip from host
-	newConnection->m_socketAddressInfo.sin_addr.s_addr = inet_addr( inet_ntoa( *(struct in_addr* )*m_hostInformation->h_addr_list ) );
-
-	u_long nonBlockingIO = 1;
-	ioctlsocket( newConnection->m_socket, FIONBIO, &nonBlockingIO );
+	newConnection->m_socketAddressInfo.sin_addr.s_addr = hostIPAddress;
 
-
-	std::pair< int, Connection* > connectionPair( newConnectionID, newConnection );
-	m_connections.insert( connectionPair );
+	ConfigureNewSocket( newConnection );
 
 	return newConnectionID;
 }
@@ -78,16 +114,14 @@ int Network::CreateUDPSocketFromDomainNameAndPort( const char* domainAsString, u
 //-----------------------------------------------------------------------------------------------
 int Network::CreateUDPSocketFromIPAndPort( const char* ipAddressAsString, u_short port )
 {
-	Connection* newConnection = new Connection();
-
-	int newConnectionID = m_currentNumConnectionIDs;
-	++m_currentNumConnectionIDs;
+	int newConnectionID = INVALID_CONNECTION_ID;
+	Connection* newConnection = AllocateConnection( newConnectionID );
 
 	newConnection->m_socket = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
 
 	if( newConnection->m_socket == SOCKET_ERROR )
 	{
-		printf( "socket() failed, Error Code: %d", WSAGetLastError() );
+		printf( "socket() failed, Error Code: %d", SocketPlatform::GetLastError() );
 		exit( EXIT_FAILURE );
 	}
 
@@ -95,14 +129,9 @@ int Network::CreateUDPSocketFromIPAndPort( const char* ipAddressAsString, u_shor
 
 	newConnection->m_socketAddressInfo.sin_family = AF_INET;
 	newConnection->m_socketAddressInfo.sin_port = htons( port );
-	newConnection->m_socketAddressInfo.sin_addr.S_un.S_addr = inet_addr( ipAddressAsString );
-
-	u_long nonBlockingIO = 1;
-	ioctlsocket( newConnection->m_socket, FIONBIO, &nonBlockingIO );
-
+	newConnection->m_socketAddressInfo.sin_addr.s_addr = inet_addr( ipAddressAsString );
 
-	std::pair< int, Connection* > connectionPair( newConnectionID, newConnection );
-	m_connections.insert( connectionPair );
+	ConfigureNewSocket( newConnection );
 
 	return newConnectionID;
 }
@@ -111,34 +140,257 @@ int Network::CreateUDPSocketFromIPAndPort( const char* ipAddressAsString, u_shor
 //-----------------------------------------------------------------------------------------------
 void Network::BindSocket( int connectionID )
 {
-	std::unordered_map< int, Connection* >::const_iterator connectionIter = m_connections.find( connectionID );
+	Connection* connection = FindConnection( connectionID );
 
 	int bindResultAsInt = SOCKET_ERROR;
 
-	if( connectionIter != m_connections.end() )
+	if( connection != nullptr )
 	{
-		Connection* connection = connectionIter->second;
 
 		bindResultAsInt = bind( connection->m_socket, ( struct sockaddr * )&connection->m_socketAddressInfo, connection->m_socketAddrInfoLength );
 	}
 }
 
+//-----------------------------------------------------------------------------------------------
+//Lets several sockets bind the same port so the kernel spreads incoming datagrams across them.
+//Must be called before BindSocket. WinSock has no SO_REUSEPORT, and SO_REUSEADDR there hands
+//every datagram to a single socket, so this reports false and callers should use one socket.
+bool Network::EnablePortSharing( int connectionID )
+{
+#ifdef SO_REUSEPORT
+	Connection* connection = FindConnection( connectionID );
+
+	if( connection == nullptr )
+	{
+		return false;
+	}
+
+	int isEnabled = 1;
+	int result = setsockopt( connection->m_socket, SOL_SOCKET, SO_REUSEPORT, ( const char* )&isEnabled, sizeof( isEnabled ) );
+
+	return result == 0;
+#else
+	UNUSED( connectionID );
+
+	return false;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool Network::SupportsPortSharing() const
+{
+#ifdef SO_REUSEPORT
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Sizes of 0 leave that buffer alone. The kernel may round or cap what it is given, and Linux doubles
+//it for bookkeeping, so read GetSocketStats for what the socket actually got.
+bool Network::SetSocketBufferSizes( int connectionID, int receiveBufferBytes, int sendBufferBytes )
+{
+	Connection* connection = FindConnection( connectionID );
+
+	if( connection == nullptr )
+	{
+		return false;
+	}
+
+	bool didSetAll = true;
+
+	if( receiveBufferBytes > 0 )
+	{
+		didSetAll &= setsockopt( connection->m_socket, SOL_SOCKET, SO_RCVBUF, ( const char* )&receiveBufferBytes, sizeof( receiveBufferBytes ) ) == 0;
+	}
+
+	if( sendBufferBytes > 0 )
+	{
+		didSetAll &= setsockopt( connection->m_socket, SOL_SOCKET, SO_SNDBUF, ( const char* )&sendBufferBytes, sizeof( sendBufferBytes ) ) == 0;
+	}
+
+	return didSetAll;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Used by every socket created after this. 0 keeps the platform's default, which is what sockets get
+//until this is called.
+void Network::SetDefaultSocketBufferSizes( int receiveBufferBytes, int sendBufferBytes )
+{
+	m_defaultReceiveBufferBytes = receiveBufferBytes;
+	m_defaultSendBufferBytes = sendBufferBytes;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int Network::GetDefaultReceiveBufferBytes() const
+{
+	return m_defaultReceiveBufferBytes;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+SocketStats Network::GetSocketStats( int connectionID )
+{
+	SocketStats socketStats;
+
+	Connection* connection = FindConnection( connectionID );
+
+	if( connection == nullptr )
+	{
+		return socketStats;
+	}
+
+	socklen_t optionLength = sizeof( socketStats.receiveBufferBytes );
+	getsockopt( connection->m_socket, SOL_SOCKET, SO_RCVBUF, ( char* )&socketStats.receiveBufferBytes, &optionLength );
+
+	optionLength = sizeof( socketStats.sendBufferBytes );
+	getsockopt( connection->m_socket, SOL_SOCKET, SO_SNDBUF, ( char* )&socketStats.sendBufferBytes, &optionLength );
+
+	socketStats.canCountKernelDrops = SupportsKernelDropCounts();
+	socketStats.numKernelReceiveDrops = connection->m_numKernelReceiveDrops;
+	socketStats.peakBytesReceivedAtOnce = connection->m_peakBytesReceivedAtOnce;
+	socketStats.canSendDatagramTrains = SupportsDatagramTrains() && connection->m_canSendDatagramTrains;
+	socketStats.numDatagramTrainsSent = connection->m_numDatagramTrainsSent;
+	socketStats.numDatagramsSentInTrains = connection->m_numDatagramsSentInTrains;
+	socketStats.numSendBufferDrops = connection->m_numSendBufferDrops;
+	socketStats.isUsingIoUring = ( connection->m_ioUring != nullptr );
+
+	if( connection->m_ioUring != nullptr )
+	{
+		socketStats.numFailedQueuedSends = connection->m_ioUring->GetNumFailedSends();
+	}
+
+	return socketStats;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//WinSock keeps no per socket drop count, only Linux's SO_RXQ_OVFL does
+bool Network::SupportsKernelDropCounts() const
+{
+#ifdef SO_RXQ_OVFL
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Whether this build can hand the kernel a train of equal datagrams in one send. Only Linux's
+//UDP_SEGMENT can, and even there the kernel may refuse, see GetSocketStats for what a socket got.
+bool Network::SupportsDatagramTrains() const
+{
+#ifdef UDP_SEGMENT
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Switching to io_uring posts the connection's receives right away, so call it before anything is
+//waiting on the socket. Returns false, and leaves the connection as it was, if the kernel refuses.
+bool Network::SetSocketBackend( int connectionID, SocketBackend backend )
+{
+	Connection* connection = FindConnection( connectionID );
+
+	if( connection == nullptr )
+	{
+		return false;
+	}
+
+	if( backend == SOCKET_BACKEND_NON_BLOCKING )
+	{
+		delete connection->m_ioUring;
+		connection->m_ioUring = nullptr;
+
+		return true;
+	}
+
+	return StartIoUring( connection );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Used by every socket created after this, like the default buffer sizes
+void Network::SetDefaultSocketBackend( SocketBackend backend )
+{
+	m_defaultSocketBackend = backend;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+SocketBackend Network::GetSocketBackend( int connectionID )
+{
+	Connection* connection = FindConnection( connectionID );
+
+	if( connection == nullptr || connection->m_ioUring == nullptr )
+	{
+		return SOCKET_BACKEND_NON_BLOCKING;
+	}
+
+	return SOCKET_BACKEND_IO_URING;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Whether this build has io_uring at all. The running kernel can still turn it down, which
+//SetSocketBackend reports.
+bool Network::SupportsIoUring() const
+{
+	return IoUringSocket::IsSupported();
+}
+
+
 //-----------------------------------------------------------------------------------------------
 int Network::SendUDPMessage( void* message, int messageSize, int connectionID )
 {
 	int bytesSent = -1;
 
-	std::unordered_map< int, Connection* >::const_iterator connectionIter = m_connections.find( connectionID );
+	Connection* connection = FindConnection( connectionID );
 	
-	if( connectionIter != m_connections.end() )
+	if( connection != nullptr )
+	{
+		bytesSent = SendDatagram( connection, connection->m_socketAddressInfo, ( const char* )message, messageSize );
+		FlushQueuedSends( connection );
+	}
+
+	if( bytesSent == SOCKET_ERROR )
 	{
-		Connection* connection = connectionIter->second;
-		bytesSent = sendto( connection->m_socket, ( char*)message, messageSize, 0, ( struct sockaddr* )&connection->m_socketAddressInfo, connection->m_socketAddrInfoLength );
+		printf( "Failed to send, Error Code: %d", SocketPlatform::GetLastError() );
+		exit( EXIT_FAILURE );
+	}
+
+	return bytesSent;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int Network::SendTo( int connectionID, const PeerAddress& destination, const void* message, int messageSize )
+{
+	int bytesSent = -1;
+
+	Connection* connection = FindConnection( connectionID );
+
+	if( connection != nullptr )
+	{
+		//Goes to the given peer without touching the connection's own sockaddr
+		struct sockaddr_in destinationAddress = destination.ToSocketAddress();
+
+		bytesSent = SendDatagram( connection, destinationAddress, ( const char* )message, messageSize );
+		FlushQueuedSends( connection );
 	}
 
 	if( bytesSent == SOCKET_ERROR )
 	{
-		printf( "Failed to send, Error Code: %d", WSAGetLastError() );
+		printf( "Failed to send, Error Code: %d", SocketPlatform::GetLastError() );
 		exit( EXIT_FAILURE );
 	}
 
@@ -151,27 +403,266 @@ int Network::ReceiveUDPMessage( void* buffer, int bufferSize, int connectionID )
 {
 	int bytesReceived = -1;
 	
-	std::unordered_map< int, Connection* >::const_iterator connectionIter = m_connections.find( connectionID );
+	Connection* connection = FindConnection( connectionID );
 	
-	if( connectionIter != m_connections.end() )
+	if( connection != nullptr && ( IsSimulatingConditions( connection ) || connection->m_ioUring != nullptr ) )
+	{
+		ReceivedDatagram datagram;
+
+		datagram.buffer = ( char* )buffer;
+		datagram.bufferSize = bufferSize;
+
+		if( ReceiveDatagrams( connection, &datagram, 1 ) == 1 )
+		{
+			bytesReceived = datagram.bytesReceived;
+			connection->m_socketAddressInfo = datagram.sourceAddress.ToSocketAddress();
+		}
+	}
+	else if( connection != nullptr )
 	{
-		Connection* connection = connectionIter->second;
 		bytesReceived = recvfrom( connection->m_socket, ( char* )buffer, bufferSize, 0, ( struct sockaddr* )&connection->m_socketAddressInfo, &connection->m_socketAddrInfoLength );
+
+		if( bytesReceived > 0 && m_captureWriter.IsOpen() )
+		{
+			m_captureWriter.Record( CAPTURE_RECEIVED, PeerAddress( connection->m_socketAddressInfo ), ( const char* )buffer, bytesReceived, Time::GetCurrentTimeInSeconds() );
+		}
 	}
 
 	return bytesReceived;
 }
 
 
+//-----------------------------------------------------------------------------------------------
+int Network::ReceiveUDPMessages( ReceivedDatagram* datagrams, int maxNumDatagrams, int connectionID )
+{
+	int numDatagramsReceived = 0;
+
+	Connection* connection = FindConnection( connectionID );
+
+	if( connection == nullptr )
+	{
+		return numDatagramsReceived;
+	}
+
+	numDatagramsReceived = ReceiveDatagrams( connection, datagrams, maxNumDatagrams );
+
+	return numDatagramsReceived;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Receives into the connection's receive ring instead of caller memory. The datagrams stay where
+//they landed until ReleaseReceivedDatagrams, so callers can read packets straight out of them.
+//Returns 0 once the socket is empty or every slot is held, keep calling until then.
+int Network::ReceiveUDPMessagesInPlace( int connectionID, ReceivedDatagram*& out_datagrams )
+{
+	out_datagrams = nullptr;
+
+	Connection* connection = FindConnection( connectionID );
+
+	if( connection == nullptr )
+	{
+		return 0;
+	}
+
+	DatagramRing& receiveRing = connection->m_receiveRing;
+
+	if( !receiveRing.IsAllocated() )
+	{
+		receiveRing.Allocate( RECEIVE_RING_NUM_SLOTS, MAX_DATAGRAM_SIZE_BYTES );
+	}
+
+	int numFreeSlots = 0;
+	ReceivedDatagram* freeSlots = receiveRing.GetFreeSlots( numFreeSlots );
+
+	if( numFreeSlots == 0 )
+	{
+		return 0;
+	}
+
+	int numDatagramsReceived = ReceiveDatagrams( connection, freeSlots, numFreeSlots );
+
+	receiveRing.CommitSlots( numDatagramsReceived );
+
+	out_datagrams = freeSlots;
+
+	return numDatagramsReceived;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Network::ReleaseReceivedDatagrams( int connectionID )
+{
+	Connection* connection = FindConnection( connectionID );
+
+	if( connection != nullptr )
+	{
+		connection->m_receiveRing.ReleaseAllSlots();
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int Network::SendUDPMessages( const std::vector< OutgoingDatagram >& datagrams, int connectionID )
+{
+	int numDatagramsSent = 0;
+
+	Connection* connection = FindConnection( connectionID );
+
+	if( connection == nullptr )
+	{
+		return numDatagramsSent;
+	}
+
+	//runs of equal datagrams to one peer go out as a single segmented send where the kernel allows it,
+	//everything in between is gathered up and sent as one batch
+	int datagramIndex = 0;
+	int firstUnsentDatagramIndex = 0;
+
+	while( datagramIndex < static_cast< int >( datagrams.size() ) )
+	{
+		int numDatagramsInTrain = CountDatagramsInTrain( datagrams, datagramIndex );
+
+		if( numDatagramsInTrain > 1 && CanSendDatagramTrain( connection ) )
+		{
+			//whatever was gathered before the train has to leave first
+			SendDatagramBatch( connection, datagrams, firstUnsentDatagramIndex, datagramIndex - firstUnsentDatagramIndex );
+			firstUnsentDatagramIndex = datagramIndex;
+
+			if( SendDatagramTrain( connection, &datagrams[ datagramIndex ], numDatagramsInTrain ) )
+			{
+				firstUnsentDatagramIndex += numDatagramsInTrain;
+			}
+		}
+
+		datagramIndex += numDatagramsInTrain;
+	}
+
+	SendDatagramBatch( connection, datagrams, firstUnsentDatagramIndex, datagramIndex - firstUnsentDatagramIndex );
+	FlushQueuedSends( connection );
+
+	numDatagramsSent = datagramIndex;
+
+	return numDatagramsSent;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool Network::WaitForIncomingData( int connectionID, double maxSecondsToWait )
+{
+	std::vector< int > connectionIDs( 1, connectionID );
+
+	return WaitForIncomingData( connectionIDs, maxSecondsToWait );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//While simulating, readable sockets are not enough since what they hold may still be delayed. Keeps
+//moving datagrams through the simulators until one is due or the time runs out.
+bool Network::WaitForIncomingData( const std::vector< int >& connectionIDs, double maxSecondsToWait )
+{
+	if( !m_simulatedConditions.IsEnabled() )
+	{
+		bool isAnySimulatorInUse = false;
+
+		for( int i = 0; i < static_cast< int >( connectionIDs.size() ); ++i )
+		{
+			Connection* connection = FindConnection( connectionIDs[ i ] );
+
+			if( connection != nullptr && IsSimulatingConditions( connection ) )
+			{
+				isAnySimulatorInUse = true;
+				break;
+			}
+		}
+
+		if( !isAnySimulatorInUse )
+		{
+			return SelectReadableSockets( connectionIDs, maxSecondsToWait );
+		}
+	}
+
+	double deadlineSeconds = Time::GetCurrentTimeInSeconds() + maxSecondsToWait;
+
+	for( ;; )
+	{
+		double currentTimeSeconds = Time::GetCurrentTimeInSeconds();
+		double wakeUpTimeSeconds = deadlineSeconds;
+
+		for( int i = 0; i < static_cast< int >( connectionIDs.size() ); ++i )
+		{
+			Connection* connection = FindConnection( connectionIDs[ i ] );
+
+			if( connection == nullptr )
+			{
+				continue;
+			}
+
+			PumpSimulatedConnection( connection );
+
+			if( connection->m_incomingSimulator.HasDueDatagram( currentTimeSeconds ) )
+			{
+				return true;
+			}
+
+			double releaseTimeSeconds = 0.0;
+
+			if( connection->m_incomingSimulator.GetNextReleaseTime( releaseTimeSeconds ) && releaseTimeSeconds < wakeUpTimeSeconds )
+			{
+				wakeUpTimeSeconds = releaseTimeSeconds;
+			}
+
+			if( connection->m_outgoingSimulator.GetNextReleaseTime( releaseTimeSeconds ) && releaseTimeSeconds < wakeUpTimeSeconds )
+			{
+				wakeUpTimeSeconds = releaseTimeSeconds;
+			}
+		}
+
+		if( currentTimeSeconds >= deadlineSeconds )
+		{
+			return false;
+		}
+
+		SelectReadableSockets( connectionIDs, wakeUpTimeSeconds - currentTimeSeconds );
+	}
+}
+
+
 //-----------------------------------------------------------------------------------------------
 void Network::CloseUDPSocket( int connectionID )
 {
-	//FUTURE EDIT: Need to clean up socket from memory
+	EnterCriticalSection( &m_connectionsCS );
+
+	Connection* connection = FindConnection( connectionID );
+
+	if( connection == nullptr )
+	{
+		LeaveCriticalSection( &m_connectionsCS );
+		return;
+	}
+
+	//the ring has to let go of the socket before it closes
+	delete connection->m_ioUring;
+	connection->m_ioUring = nullptr;
+
+	SocketPlatform::CloseSocket( connection->m_socket );
+	connection->Reset();
+
+	//bumping the generation is what makes every copy of this ID stale
+	ConnectionSlot& slot = m_connectionSlots[ connectionID & CONNECTION_ID_INDEX_MASK ];
+
+	slot.isInUse = false;
+	++slot.generation;
 
-	std::unordered_map< int, Connection* >::const_iterator connectionIter = m_connections.find( connectionID );
-	Connection* connection = connectionIter->second;
+	if( slot.generation > MAX_CONNECTION_GENERATION )
+	{
+		slot.generation = 1;
+	}
 
-	closesocket( connection->m_socket );
+	m_freeConnectionSlotIndices[ m_numFreeConnectionSlots ] = connectionID & CONNECTION_ID_INDEX_MASK;
+	++m_numFreeConnectionSlots;
+
+	LeaveCriticalSection( &m_connectionsCS );
 }
 
 
@@ -180,11 +671,10 @@ std::string Network::GetIPAddressAsStringFromConnection( int connectionID )
 {
 	std::string result = "";
 
-	std::unordered_map< int, Connection* >::const_iterator connectionIter = m_connections.find( connectionID );
+	Connection* connection = FindConnection( connectionID );
 	
-	if( connectionIter != m_connections.end() )
+	if( connection != nullptr )
 	{
-		Connection* connection = connectionIter->second;
 
 		result = inet_ntoa( connection->m_socketAddressInfo.sin_addr );
 	}
@@ -198,15 +688,28 @@ std::string Network::GetPortAsStringFromConnection( int connectionID )
 {
 	std::string result = "";
 
-	std::unordered_map< int, Connection* >::const_iterator connectionIter = m_connections.find( connectionID );
+	Connection* connection = FindConnection( connectionID );
 
-	if( connectionIter != m_connections.end() )
+	if( connection != nullptr )
 	{
-		char buffer[ 100 ];
+		result = PeerAddress( connection->m_socketAddressInfo ).GetPortAsString();
+	}
+
+	return result;
+}
+
 
-		Connection* connection = connectionIter->second;
+//-----------------------------------------------------------------------------------------------
+//The address a connection sends to by default, for handing to senders that take a PeerAddress
+PeerAddress Network::GetPeerAddressFromConnection( int connectionID )
+{
+	PeerAddress result;
 
-		result = _itoa( static_cast< int >( ntohs( connection->m_socketAddressInfo.sin_port ) ), buffer, 10 );
+	Connection* connection = FindConnection( connectionID );
+
+	if( connection != nullptr )
+	{
+		result = PeerAddress( connection->m_socketAddressInfo );
 	}
 
 	return result;
@@ -216,13 +719,12 @@ std::string Network::GetPortAsStringFromConnection( int connectionID )
 //-----------------------------------------------------------------------------------------------
 void Network::SetIPAddressAsStringForConnection( int connectionID, const std::string& ipAddressAsString )
 {
-	std::unordered_map< int, Connection* >::const_iterator connectionIter = m_connections.find( connectionID );
+	Connection* connection = FindConnection( connectionID );
 
-	if( connectionIter != m_connections.end() )
+	if( connection != nullptr )
 	{
-		Connection* connection = connectionIter->second;
 
-		connection->m_socketAddressInfo.sin_addr.S_un.S_addr = inet_addr( ipAddressAsString.c_str() );
+		connection->m_socketAddressInfo.sin_addr.s_addr = inet_addr( ipAddressAsString.c_str() );
 	}
 }
 
@@ -230,12 +732,794 @@ void Network::SetIPAddressAsStringForConnection( int connectionID, const std::st
 //-----------------------------------------------------------------------------------------------
 void Network::SetPortAsStringForConnection( int connectionID, const std::string& portAsString )
 {
-	std::unordered_map< int, Connection* >::const_iterator connectionIter = m_connections.find( connectionID );
+	Connection* connection = FindConnection( connectionID );
 
-	if( connectionIter != m_connections.end() )
+	if( connection != nullptr )
 	{
-		Connection* connection = connectionIter->second;
 
 		connection->m_socketAddressInfo.sin_port = htons( u_short( atoi( portAsString.c_str() ) ) );
 	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Applies to every open connection and every one opened after, in both directions. Sends and
+//receives then go through the simulators, which only move datagrams along when Network is called
+//on that connection, so anything polling once a frame sees delays rounded up to its frame.
+void Network::SetSimulatedConditions( const SimulatedNetworkConditions& conditions )
+{
+	EnterCriticalSection( &m_connectionsCS );
+
+	m_simulatedConditions = conditions;
+
+	for( int i = 0; i < MAX_NUM_CONNECTIONS; ++i )
+	{
+		if( m_connectionSlots[ i ].isInUse )
+		{
+			ApplySimulatedConditions( i );
+		}
+	}
+
+	LeaveCriticalSection( &m_connectionsCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+const SimulatedNetworkConditions& Network::GetSimulatedConditions() const
+{
+	return m_simulatedConditions;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Records every datagram the game sends or receives on any connection until StopCapture. Sends are
+//recorded when handed to Network and receives when handed back, so simulated drops never show up.
+bool Network::StartCapture( const std::string& filePath )
+{
+	return m_captureWriter.Open( filePath );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Network::StopCapture()
+{
+	m_captureWriter.Close();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool Network::IsCapturing() const
+{
+	return m_captureWriter.IsOpen();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Slots never move, so a lookup is an index and a generation check with no lock. Only creating
+//and closing connections touch the free list.
+Connection* Network::FindConnection( int connectionID )
+{
+	if( connectionID <= INVALID_CONNECTION_ID )
+	{
+		return nullptr;
+	}
+
+	int slotIndex = connectionID & CONNECTION_ID_INDEX_MASK;
+	int generation = connectionID >> CONNECTION_ID_INDEX_BITS;
+
+	if( slotIndex >= MAX_NUM_CONNECTIONS )
+	{
+		return nullptr;
+	}
+
+	ConnectionSlot& slot = m_connectionSlots[ slotIndex ];
+
+	if( !slot.isInUse || slot.generation != generation )
+	{
+		return nullptr;
+	}
+
+	return &slot.connection;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Connection* Network::AllocateConnection( int& out_connectionID )
+{
+	EnterCriticalSection( &m_connectionsCS );
+
+	if( m_numFreeConnectionSlots == 0 )
+	{
+		printf( "Failed to create connection, all %d connections are in use", MAX_NUM_CONNECTIONS );
+		exit( EXIT_FAILURE );
+	}
+
+	--m_numFreeConnectionSlots;
+	int slotIndex = m_freeConnectionSlotIndices[ m_numFreeConnectionSlots ];
+
+	ConnectionSlot& slot = m_connectionSlots[ slotIndex ];
+
+	slot.isInUse = true;
+	out_connectionID = ( slot.generation << CONNECTION_ID_INDEX_BITS ) | slotIndex;
+
+	ApplySimulatedConditions( slotIndex );
+
+	LeaveCriticalSection( &m_connectionsCS );
+
+	return &slot.connection;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Drains the socket in batches so callers never loop themselves. Source addresses go into each
+//datagram rather than the connection's sockaddr.
+STATIC int Network::ReceiveDatagramsFromSocket( Connection* connection, ReceivedDatagram* datagrams, int maxNumDatagrams )
+{
+	int numDatagramsReceived = 0;
+	int numBytesReceived = 0;
+
+	//the ring already holds whatever landed since the last call, copying it out takes no system call
+	if( connection->m_ioUring != nullptr )
+	{
+		numDatagramsReceived = connection->m_ioUring->PopReceivedDatagrams( datagrams, maxNumDatagrams, connection->m_numKernelReceiveDrops );
+
+		double arrivalTimeSeconds = Time::GetCurrentTimeInSeconds();
+
+		for( int i = 0; i < numDatagramsReceived; ++i )
+		{
+			datagrams[ i ].arrivalTimeSeconds = arrivalTimeSeconds;
+			numBytesReceived += datagrams[ i ].bytesReceived;
+		}
+	}
+
+	while( connection->m_ioUring == nullptr && numDatagramsReceived < maxNumDatagrams )
+	{
+		int numDatagramsAskedFor = maxNumDatagrams - numDatagramsReceived;
+
+		if( numDatagramsAskedFor > MAX_DATAGRAMS_PER_SYSTEM_CALL )
+		{
+			numDatagramsAskedFor = MAX_DATAGRAMS_PER_SYSTEM_CALL;
+		}
+
+		int numDatagramsInBatch = ReceiveDatagramBatchFromSocket( connection, &datagrams[ numDatagramsReceived ], numDatagramsAskedFor );
+
+		for( int i = 0; i < numDatagramsInBatch; ++i )
+		{
+			numBytesReceived += datagrams[ numDatagramsReceived + i ].bytesReceived;
+		}
+
+		numDatagramsReceived += numDatagramsInBatch;
+
+		//a short batch means the socket is empty
+		if( numDatagramsInBatch < numDatagramsAskedFor )
+		{
+			break;
+		}
+	}
+
+	//the kernel charges some overhead per datagram too, so this undercounts how full the buffer got
+	if( numBytesReceived > connection->m_peakBytesReceivedAtOnce )
+	{
+		connection->m_peakBytesReceivedAtOnce = numBytesReceived;
+	}
+
+	return numDatagramsReceived;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//One recvmmsg for the whole batch where the platform has it. WinSock, and the BSDs without it, fall back
+//to a recvfrom per datagram. Comes back short only once the socket is empty.
+STATIC int Network::ReceiveDatagramBatchFromSocket( Connection* connection, ReceivedDatagram* datagrams, int maxNumDatagrams )
+{
+#ifdef SOCKET_PLATFORM_HAS_BATCH_CALLS
+	struct mmsghdr messages[ MAX_DATAGRAMS_PER_SYSTEM_CALL ];
+	struct iovec payloads[ MAX_DATAGRAMS_PER_SYSTEM_CALL ];
+	struct sockaddr_in sourceAddresses[ MAX_DATAGRAMS_PER_SYSTEM_CALL ];
+
+#ifdef SO_RXQ_OVFL
+	//the kernel tags each datagram with how many it has dropped on this socket so far
+	char controlBuffers[ MAX_DATAGRAMS_PER_SYSTEM_CALL ][ CMSG_SPACE( sizeof( uint ) ) ];
+#endif
+
+	memset( messages, 0, sizeof( messages[ 0 ] ) * maxNumDatagrams );
+
+	for( int i = 0; i < maxNumDatagrams; ++i )
+	{
+		payloads[ i ].iov_base = datagrams[ i ].buffer;
+		payloads[ i ].iov_len = datagrams[ i ].bufferSize;
+
+		struct msghdr& message = messages[ i ].msg_hdr;
+
+		message.msg_name = &sourceAddresses[ i ];
+		message.msg_namelen = sizeof( sourceAddresses[ i ] );
+		message.msg_iov = &payloads[ i ];
+		message.msg_iovlen = 1;
+
+#ifdef SO_RXQ_OVFL
+		message.msg_control = controlBuffers[ i ];
+		message.msg_controllen = sizeof( controlBuffers[ i ] );
+#endif
+	}
+
+	int numDatagramsReceived = recvmmsg( connection->m_socket, messages, maxNumDatagrams, 0, nullptr );
+
+	if( numDatagramsReceived <= 0 )
+	{
+		return 0;
+	}
+
+	double arrivalTimeSeconds = Time::GetCurrentTimeInSeconds();
+
+	for( int i = 0; i < numDatagramsReceived; ++i )
+	{
+		ReceivedDatagram& datagram = datagrams[ i ];
+
+		datagram.bytesReceived = static_cast< int >( messages[ i ].msg_len );
+		datagram.sourceAddress = PeerAddress( sourceAddresses[ i ] );
+		datagram.arrivalTimeSeconds = arrivalTimeSeconds;
+
+#ifdef SO_RXQ_OVFL
+		struct msghdr& message = messages[ i ].msg_hdr;
+
+		for( struct cmsghdr* controlMessage = CMSG_FIRSTHDR( &message ); controlMessage != nullptr; controlMessage = CMSG_NXTHDR( &message, controlMessage ) )
+		{
+			if( controlMessage->cmsg_level == SOL_SOCKET && controlMessage->cmsg_type == SO_RXQ_OVFL )
+			{
+				memcpy( &connection->m_numKernelReceiveDrops, CMSG_DATA( controlMessage ), sizeof( uint ) );
+			}
+		}
+#endif
+	}
+
+	return numDatagramsReceived;
+#else
+	int numDatagramsReceived = 0;
+
+	while( numDatagramsReceived < maxNumDatagrams )
+	{
+		ReceivedDatagram& datagram = datagrams[ numDatagramsReceived ];
+
+		struct sockaddr_in sourceAddress;
+		socklen_t sourceAddressLength = sizeof( sourceAddress );
+
+		datagram.bytesReceived = recvfrom( connection->m_socket, datagram.buffer, datagram.bufferSize, 0, ( struct sockaddr* )&sourceAddress, &sourceAddressLength );
+
+		if( datagram.bytesReceived <= 0 )
+		{
+			break;
+		}
+
+		datagram.sourceAddress = PeerAddress( sourceAddress );
+		datagram.arrivalTimeSeconds = Time::GetCurrentTimeInSeconds();
+
+		++numDatagramsReceived;
+	}
+
+	return numDatagramsReceived;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Network::ConfigureNewSocket( Connection* connection )
+{
+	SocketPlatform::SetNonBlocking( connection->m_socket );
+
+	if( m_defaultReceiveBufferBytes > 0 )
+	{
+		setsockopt( connection->m_socket, SOL_SOCKET, SO_RCVBUF, ( const char* )&m_defaultReceiveBufferBytes, sizeof( m_defaultReceiveBufferBytes ) );
+	}
+
+	if( m_defaultSendBufferBytes > 0 )
+	{
+		setsockopt( connection->m_socket, SOL_SOCKET, SO_SNDBUF, ( const char* )&m_defaultSendBufferBytes, sizeof( m_defaultSendBufferBytes ) );
+	}
+
+#ifdef SO_RXQ_OVFL
+	int isEnabled = 1;
+	setsockopt( connection->m_socket, SOL_SOCKET, SO_RXQ_OVFL, ( const char* )&isEnabled, sizeof( isEnabled ) );
+#endif
+
+	//stays on non-blocking calls if the kernel turns io_uring down
+	if( m_defaultSocketBackend == SOCKET_BACKEND_IO_URING )
+	{
+		StartIoUring( connection );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool Network::StartIoUring( Connection* connection )
+{
+	if( connection->m_ioUring != nullptr )
+	{
+		return true;
+	}
+
+	IoUringSocket* ioUring = new IoUringSocket();
+
+	if( !ioUring->StartUp( connection->m_socket, IO_URING_NUM_RECEIVE_BUFFERS, IO_URING_NUM_SEND_SLOTS ) )
+	{
+		delete ioUring;
+		return false;
+	}
+
+	connection->m_ioUring = ioUring;
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//On io_uring the datagram is only queued and counts as sent, FlushQueuedSends hands the queue over
+int Network::SendToSocket( Connection* connection, const struct sockaddr_in& destinationAddress, const char* message, int messageSize )
+{
+	if( connection->m_ioUring != nullptr && connection->m_ioUring->QueueSend( destinationAddress, message, messageSize ) )
+	{
+		return messageSize;
+	}
+
+	return sendto( connection->m_socket, message, messageSize, 0, ( const struct sockaddr* )&destinationAddress, sizeof( destinationAddress ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Network::FlushQueuedSends( Connection* connection )
+{
+	if( connection->m_ioUring != nullptr )
+	{
+		connection->m_ioUring->SubmitQueuedEntries();
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Either sends now or hands the datagram to the connection's outgoing simulator, which counts as sent
+int Network::SendDatagram( Connection* connection, const struct sockaddr_in& destinationAddress, const char* message, int messageSize )
+{
+	if( m_captureWriter.IsOpen() )
+	{
+		m_captureWriter.Record( CAPTURE_SENT, PeerAddress( destinationAddress ), message, messageSize, Time::GetCurrentTimeInSeconds() );
+	}
+
+	if( !IsSimulatingConditions( connection ) )
+	{
+		return SendToSocket( connection, destinationAddress, message, messageSize );
+	}
+
+	double currentTimeSeconds = Time::GetCurrentTimeInSeconds();
+
+	connection->m_outgoingSimulator.Submit( PeerAddress( destinationAddress ), message, messageSize, currentTimeSeconds );
+
+	PumpSimulatedConnection( connection );
+
+	return messageSize;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Datagrams that do not go out as a train. Where the platform has sendmmsg they are handed to the kernel
+//a batch per call. Everywhere else, and whenever io_uring or the simulator takes them instead, they
+//go one at a time. So does whatever is left if the kernel stops taking a batch part way through,
+//which is where a real send error gets reported. A full send buffer is not one: the rest of the batch
+//is dropped and counted, like loss on the wire, and the game's own resends cover it.
+void Network::SendDatagramBatch( Connection* connection, const std::vector< OutgoingDatagram >& datagrams, int firstDatagramIndex, int numDatagrams )
+{
+	int datagramIndex = firstDatagramIndex;
+	int endDatagramIndex = firstDatagramIndex + numDatagrams;
+
+#ifdef SOCKET_PLATFORM_HAS_BATCH_CALLS
+	while( connection->m_ioUring == nullptr && !IsSimulatingConditions( connection ) && datagramIndex < endDatagramIndex )
+	{
+		struct mmsghdr messages[ MAX_DATAGRAMS_PER_SYSTEM_CALL ];
+		struct iovec payloads[ MAX_DATAGRAMS_PER_SYSTEM_CALL ];
+		struct sockaddr_in destinationAddresses[ MAX_DATAGRAMS_PER_SYSTEM_CALL ];
+
+		int numDatagramsInBatch = endDatagramIndex - datagramIndex;
+
+		if( numDatagramsInBatch > MAX_DATAGRAMS_PER_SYSTEM_CALL )
+		{
+			numDatagramsInBatch = MAX_DATAGRAMS_PER_SYSTEM_CALL;
+		}
+
+		memset( messages, 0, sizeof( messages[ 0 ] ) * numDatagramsInBatch );
+
+		for( int i = 0; i < numDatagramsInBatch; ++i )
+		{
+			const OutgoingDatagram& datagram = datagrams[ datagramIndex + i ];
+
+			destinationAddresses[ i ] = datagram.destinationAddress.ToSocketAddress();
+			payloads[ i ].iov_base = const_cast< char* >( datagram.message );
+			payloads[ i ].iov_len = datagram.messageSize;
+
+			struct msghdr& message = messages[ i ].msg_hdr;
+
+			message.msg_name = &destinationAddresses[ i ];
+			message.msg_namelen = sizeof( destinationAddresses[ i ] );
+			message.msg_iov = &payloads[ i ];
+			message.msg_iovlen = 1;
+		}
+
+		int numDatagramsSent = sendmmsg( connection->m_socket, messages, numDatagramsInBatch, 0 );
+
+		if( numDatagramsSent < 0 && SocketPlatform::IsWouldBlockError( SocketPlatform::GetLastError() ) )
+		{
+			connection->m_numSendBufferDrops += endDatagramIndex - datagramIndex;
+			return;
+		}
+
+		if( numDatagramsSent <= 0 )
+		{
+			break;
+		}
+
+		if( m_captureWriter.IsOpen() )
+		{
+			double currentTimeSeconds = Time::GetCurrentTimeInSeconds();
+
+			for( int i = 0; i < numDatagramsSent; ++i )
+			{
+				const OutgoingDatagram& datagram = datagrams[ datagramIndex + i ];
+
+				m_captureWriter.Record( CAPTURE_SENT, datagram.destinationAddress, datagram.message, datagram.messageSize, currentTimeSeconds );
+			}
+		}
+
+		datagramIndex += numDatagramsSent;
+	}
+#endif
+
+	for( ; datagramIndex < endDatagramIndex; ++datagramIndex )
+	{
+		const OutgoingDatagram& datagram = datagrams[ datagramIndex ];
+		struct sockaddr_in destinationAddress = datagram.destinationAddress.ToSocketAddress();
+
+		int bytesSent = SendDatagram( connection, destinationAddress, datagram.message, datagram.messageSize );
+
+		if( bytesSent != SOCKET_ERROR )
+		{
+			continue;
+		}
+
+		int errorCode = SocketPlatform::GetLastError();
+
+		if( SocketPlatform::IsWouldBlockError( errorCode ) )
+		{
+			connection->m_numSendBufferDrops += endDatagramIndex - datagramIndex;
+			return;
+		}
+
+		printf( "Failed to send, Error Code: %d", errorCode );
+		exit( EXIT_FAILURE );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//No support in this build, a kernel that refused before, or a simulated link. io_uring already
+//hands a batch over in one call.
+bool Network::CanSendDatagramTrain( Connection* connection ) const
+{
+#ifdef UDP_SEGMENT
+	return connection->m_canSendDatagramTrains && connection->m_ioUring == nullptr && !IsSimulatingConditions( connection );
+#else
+	UNUSED( connection );
+
+	return false;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Sends the datagrams as one buffer the kernel cuts back into datagrams, so the train costs one trip
+//through the socket layer. Returns false without sending anything when the caller has to send them
+//some other way: see CanSendDatagramTrain, or a kernel that refuses.
+bool Network::SendDatagramTrain( Connection* connection, const OutgoingDatagram* datagrams, int numDatagrams )
+{
+#ifdef UDP_SEGMENT
+	if( !CanSendDatagramTrain( connection ) )
+	{
+		return false;
+	}
+
+	struct iovec payloads[ MAX_DATAGRAMS_PER_TRAIN ];
+
+	for( int i = 0; i < numDatagrams; ++i )
+	{
+		payloads[ i ].iov_base = const_cast< char* >( datagrams[ i ].message );
+		payloads[ i ].iov_len = datagrams[ i ].messageSize;
+	}
+
+	struct sockaddr_in destinationAddress = datagrams[ 0 ].destinationAddress.ToSocketAddress();
+
+	char controlBuffer[ CMSG_SPACE( sizeof( uint16_t ) ) ];
+	struct msghdr message;
+
+	memset( &message, 0, sizeof( message ) );
+	memset( controlBuffer, 0, sizeof( controlBuffer ) );
+
+	message.msg_name = &destinationAddress;
+	message.msg_namelen = sizeof( destinationAddress );
+	message.msg_iov = payloads;
+	message.msg_iovlen = numDatagrams;
+	message.msg_control = controlBuffer;
+	message.msg_controllen = sizeof( controlBuffer );
+
+	//every datagram in a train is the same size, so that size is where the kernel cuts
+	uint16_t segmentSize = static_cast< uint16_t >( datagrams[ 0 ].messageSize );
+	struct cmsghdr* controlMessage = CMSG_FIRSTHDR( &message );
+
+	controlMessage->cmsg_level = IPPROTO_UDP;
+	controlMessage->cmsg_type = UDP_SEGMENT;
+	controlMessage->cmsg_len = CMSG_LEN( sizeof( segmentSize ) );
+	memcpy( CMSG_DATA( controlMessage ), &segmentSize, sizeof( segmentSize ) );
+
+	if( sendmsg( connection->m_socket, &message, 0 ) < 0 )
+	{
+		int errorCode = SocketPlatform::GetLastError();
+
+		//kernels without it reject the option, and devices without checksum offload fail the send
+		if( errorCode == EINVAL || errorCode == ENOPROTOOPT || errorCode == EOPNOTSUPP || errorCode == EIO )
+		{
+			connection->m_canSendDatagramTrains = false;
+		}
+
+		return false;
+	}
+
+	++connection->m_numDatagramTrainsSent;
+	connection->m_numDatagramsSentInTrains += numDatagrams;
+
+	if( m_captureWriter.IsOpen() )
+	{
+		double currentTimeSeconds = Time::GetCurrentTimeInSeconds();
+
+		for( int i = 0; i < numDatagrams; ++i )
+		{
+			m_captureWriter.Record( CAPTURE_SENT, datagrams[ i ].destinationAddress, datagrams[ i ].message, datagrams[ i ].messageSize, currentTimeSeconds );
+		}
+	}
+
+	return true;
+#else
+	UNUSED( connection );
+	UNUSED( datagrams );
+	UNUSED( numDatagrams );
+
+	return false;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//How many datagrams from firstDatagramIndex on can share one segmented send: same peer, same size,
+//each small enough to leave the host unfragmented, and no more than one send can carry
+STATIC int Network::CountDatagramsInTrain( const std::vector< OutgoingDatagram >& datagrams, int firstDatagramIndex )
+{
+	const OutgoingDatagram& firstDatagram = datagrams[ firstDatagramIndex ];
+
+	if( firstDatagram.messageSize <= 0 || firstDatagram.messageSize > MAX_DATAGRAM_SIZE_BYTES )
+	{
+		return 1;
+	}
+
+	int maxNumDatagrams = MAX_DATAGRAM_TRAIN_BYTES / firstDatagram.messageSize;
+
+	if( maxNumDatagrams > MAX_DATAGRAMS_PER_TRAIN )
+	{
+		maxNumDatagrams = MAX_DATAGRAMS_PER_TRAIN;
+	}
+
+	int numDatagrams = 1;
+
+	while( numDatagrams < maxNumDatagrams && firstDatagramIndex + numDatagrams < static_cast< int >( datagrams.size() ) )
+	{
+		const OutgoingDatagram& datagram = datagrams[ firstDatagramIndex + numDatagrams ];
+
+		if( datagram.messageSize != firstDatagram.messageSize || datagram.destinationAddress != firstDatagram.destinationAddress )
+		{
+			break;
+		}
+
+		++numDatagrams;
+	}
+
+	return numDatagrams;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Same contract as ReceiveDatagramsFromSocket, but while simulating the datagrams come out of the
+//connection's incoming simulator once they are due. Oversized ones are cut to the caller's buffer.
+int Network::ReceiveDatagrams( Connection* connection, ReceivedDatagram* datagrams, int maxNumDatagrams )
+{
+	if( !IsSimulatingConditions( connection ) )
+	{
+		int numDatagramsReceived = ReceiveDatagramsFromSocket( connection, datagrams, maxNumDatagrams );
+
+		CaptureReceivedDatagrams( datagrams, numDatagramsReceived );
+
+		return numDatagramsReceived;
+	}
+
+	PumpSimulatedConnection( connection );
+
+	double currentTimeSeconds = Time::GetCurrentTimeInSeconds();
+	int numDatagramsReceived = 0;
+
+	SimulatedDatagram simulatedDatagram;
+
+	while( numDatagramsReceived < maxNumDatagrams && connection->m_incomingSimulator.PopDueDatagram( currentTimeSeconds, simulatedDatagram ) )
+	{
+		ReceivedDatagram& datagram = datagrams[ numDatagramsReceived ];
+
+		int numBytes = static_cast< int >( simulatedDatagram.data.size() );
+
+		if( numBytes > datagram.bufferSize )
+		{
+			numBytes = datagram.bufferSize;
+		}
+
+		memcpy( datagram.buffer, &simulatedDatagram.data[ 0 ], numBytes );
+
+		datagram.bytesReceived = numBytes;
+		datagram.sourceAddress = simulatedDatagram.address;
+		datagram.arrivalTimeSeconds = currentTimeSeconds;
+
+		++numDatagramsReceived;
+	}
+
+	CaptureReceivedDatagrams( datagrams, numDatagramsReceived );
+
+	return numDatagramsReceived;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool Network::IsSimulatingConditions( Connection* connection ) const
+{
+	return connection->m_outgoingSimulator.IsEnabled() || connection->m_incomingSimulator.IsEnabled();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Each direction of each slot gets its own seed so the rolls do not depend on how traffic interleaves
+void Network::ApplySimulatedConditions( int slotIndex )
+{
+	Connection& connection = m_connectionSlots[ slotIndex ].connection;
+
+	uint outgoingSeed = m_simulatedConditions.randomSeed + static_cast< uint >( slotIndex ) * 2;
+
+	connection.m_outgoingSimulator.SetConditions( m_simulatedConditions, outgoingSeed );
+	connection.m_incomingSimulator.SetConditions( m_simulatedConditions, outgoingSeed + 1 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Sends whatever outgoing datagrams are due and moves everything waiting in the socket into the
+//incoming simulator, where it sits until its own release time. A burst released at once can fill the
+//send buffer, what does not fit is dropped and counted like any other loss.
+void Network::PumpSimulatedConnection( Connection* connection )
+{
+	double currentTimeSeconds = Time::GetCurrentTimeInSeconds();
+
+	SimulatedDatagram simulatedDatagram;
+
+	while( connection->m_outgoingSimulator.PopDueDatagram( currentTimeSeconds, simulatedDatagram ) )
+	{
+		struct sockaddr_in destinationAddress = simulatedDatagram.address.ToSocketAddress();
+
+		int bytesSent = SendToSocket( connection, destinationAddress, &simulatedDatagram.data[ 0 ], static_cast< int >( simulatedDatagram.data.size() ) );
+
+		if( bytesSent != SOCKET_ERROR )
+		{
+			continue;
+		}
+
+		int errorCode = SocketPlatform::GetLastError();
+
+		if( SocketPlatform::IsWouldBlockError( errorCode ) )
+		{
+			++connection->m_numSendBufferDrops;
+			continue;
+		}
+
+		printf( "Failed to send, Error Code: %d", errorCode );
+		exit( EXIT_FAILURE );
+	}
+
+	FlushQueuedSends( connection );
+
+	char receiveBuffer[ MAX_DATAGRAM_SIZE_BYTES ];
+	ReceivedDatagram datagram;
+
+	datagram.buffer = receiveBuffer;
+	datagram.bufferSize = MAX_DATAGRAM_SIZE_BYTES;
+
+	while( ReceiveDatagramsFromSocket( connection, &datagram, 1 ) == 1 )
+	{
+		connection->m_incomingSimulator.Submit( datagram.sourceAddress, receiveBuffer, datagram.bytesReceived, datagram.arrivalTimeSeconds );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Network::CaptureReceivedDatagrams( const ReceivedDatagram* datagrams, int numDatagrams )
+{
+	if( !m_captureWriter.IsOpen() )
+	{
+		return;
+	}
+
+	for( int i = 0; i < numDatagrams; ++i )
+	{
+		m_captureWriter.Record( CAPTURE_RECEIVED, datagrams[ i ].sourceAddress, datagrams[ i ].buffer, datagrams[ i ].bytesReceived, datagrams[ i ].arrivalTimeSeconds );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//An io_uring connection waits on its ring, which also reads as ready when only sends completed. Those
+//wake-ups are harvested here and the wait carries on, so callers only wake for something to receive.
+bool Network::SelectReadableSockets( const std::vector< int >& connectionIDs, double maxSecondsToWait )
+{
+	double deadlineSeconds = Time::GetCurrentTimeInSeconds() + maxSecondsToWait;
+
+	SOCKET socketsToWaitOn[ MAX_NUM_CONNECTIONS ];
+	bool isSocketARing[ MAX_NUM_CONNECTIONS ];
+	bool isSocketReadable[ MAX_NUM_CONNECTIONS ];
+
+	for( ;; )
+	{
+		int numSocketsToWaitOn = 0;
+
+		for( int i = 0; i < static_cast< int >( connectionIDs.size() ) && numSocketsToWaitOn < MAX_NUM_CONNECTIONS; ++i )
+		{
+			Connection* connection = FindConnection( connectionIDs[ i ] );
+
+			if( connection == nullptr )
+			{
+				continue;
+			}
+
+			socketsToWaitOn[ numSocketsToWaitOn ] = connection->m_socket;
+			isSocketARing[ numSocketsToWaitOn ] = false;
+
+			if( connection->m_ioUring != nullptr )
+			{
+				if( connection->m_ioUring->HasReceivedDatagrams() )
+				{
+					return true;
+				}
+
+				socketsToWaitOn[ numSocketsToWaitOn ] = connection->m_ioUring->GetRingDescriptor();
+				isSocketARing[ numSocketsToWaitOn ] = true;
+			}
+
+			++numSocketsToWaitOn;
+		}
+
+		if( numSocketsToWaitOn == 0 )
+		{
+			return false;
+		}
+
+		double secondsToWait = deadlineSeconds - Time::GetCurrentTimeInSeconds();
+
+		if( SocketPlatform::WaitForReadable( socketsToWaitOn, numSocketsToWaitOn, secondsToWait, isSocketReadable ) == 0 )
+		{
+			return false;
+		}
+
+		for( int i = 0; i < numSocketsToWaitOn; ++i )
+		{
+			if( isSocketReadable[ i ] && !isSocketARing[ i ] )
+			{
+				return true;
+			}
+		}
+
+		//only rings woke, the next pass harvests them and finds out whether any of it was a receive
+	}
 }
\ No newline at end of file
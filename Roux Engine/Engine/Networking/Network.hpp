@@ -3,11 +3,27 @@
 
 #pragma once
 
-#include <WinSock2.h>
+#include "SocketPlatform.hpp"
 #include "Connection.hpp"
-#include <unordered_map>
-
-#pragma comment( lib, "ws2_32.lib" )
+#include "Datagram.hpp"
+#include "NetworkSimulator.hpp"
+#include "PacketCapture.hpp"
+#include "ConnectionStats.hpp"
+#include "Engine/Utilities/PlatformThreading.hpp"
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+//No call ever hands this out, so it is safe as a "no connection yet" value
+const int INVALID_CONNECTION_ID = 0;
+
+//-----------------------------------------------------------------------------------------------
+//How a connection's socket does its I/O. io_uring is Linux only, anywhere else asking for it leaves
+//the connection on plain non-blocking calls.
+enum SocketBackend
+{
+	SOCKET_BACKEND_NON_BLOCKING,
+	SOCKET_BACKEND_IO_URING
+};
 
 class Network
 {
@@ -32,18 +48,50 @@ public:
 	int  CreateUDPSocketFromDomainNameAndPort( const char* domainAsString, u_short port );
 	int  CreateUDPSocketFromIPAndPort( const char* ipAddressAsString, u_short port );
 	void BindSocket( int connectionID );
+	bool EnablePortSharing( int connectionID );
+	bool SupportsPortSharing() const;
+
+	bool SetSocketBufferSizes( int connectionID, int receiveBufferBytes, int sendBufferBytes );
+	void SetDefaultSocketBufferSizes( int receiveBufferBytes, int sendBufferBytes );
+	int  GetDefaultReceiveBufferBytes() const;
+	SocketStats GetSocketStats( int connectionID );
+	bool SupportsKernelDropCounts() const;
+	bool SupportsDatagramTrains() const;
+
+	bool SetSocketBackend( int connectionID, SocketBackend backend );
+	void SetDefaultSocketBackend( SocketBackend backend );
+	SocketBackend GetSocketBackend( int connectionID );
+	bool SupportsIoUring() const;
 
 	int SendUDPMessage( void* message, int messageSize, int connectionID );
+	int SendTo( int connectionID, const PeerAddress& destination, const void* message, int messageSize );
 	int ReceiveUDPMessage( void* buffer, int bufferSize, int connectionID );
 
+	int ReceiveUDPMessages( ReceivedDatagram* datagrams, int maxNumDatagrams, int connectionID );
+	int SendUDPMessages( const std::vector< OutgoingDatagram >& datagrams, int connectionID );
+
+	int  ReceiveUDPMessagesInPlace( int connectionID, ReceivedDatagram*& out_datagrams );
+	void ReleaseReceivedDatagrams( int connectionID );
+
+	bool WaitForIncomingData( int connectionID, double maxSecondsToWait );
+	bool WaitForIncomingData( const std::vector< int >& connectionIDs, double maxSecondsToWait );
+
 	void CloseUDPSocket( int connectionID );
 
 	std::string GetIPAddressAsStringFromConnection( int connectionID );
 	std::string GetPortAsStringFromConnection( int connectionID );
+	PeerAddress GetPeerAddressFromConnection( int connectionID );
 
 	void SetIPAddressAsStringForConnection( int connectionID, const std::string& ipAddressAsString );
 	void SetPortAsStringForConnection( int connectionID, const std::string& portAsString );
 
+	void SetSimulatedConditions( const SimulatedNetworkConditions& conditions );
+	const SimulatedNetworkConditions& GetSimulatedConditions() const;
+
+	bool StartCapture( const std::string& filePath );
+	void StopCapture();
+	bool IsCapturing() const;
+
 private:
 
 	Network(); 
@@ -52,13 +100,52 @@ private:
 	void operator=( Network const& ); 
 	~Network();
 
-	int				m_currentNumConnectionIDs;
-	struct hostent* m_hostInformation;
-	WSADATA			m_winSockAddrData;
+	Connection* FindConnection( int connectionID );
+	Connection* AllocateConnection( int& out_connectionID );
+
+	static int ReceiveDatagramsFromSocket( Connection* connection, ReceivedDatagram* datagrams, int maxNumDatagrams );
+	static int ReceiveDatagramBatchFromSocket( Connection* connection, ReceivedDatagram* datagrams, int maxNumDatagrams );
+
+	void ConfigureNewSocket( Connection* connection );
+	bool StartIoUring( Connection* connection );
+
+	int  SendToSocket( Connection* connection, const struct sockaddr_in& destinationAddress, const char* message, int messageSize );
+	void FlushQueuedSends( Connection* connection );
+	int  SendDatagram( Connection* connection, const struct sockaddr_in& destinationAddress, const char* message, int messageSize );
+	void SendDatagramBatch( Connection* connection, const std::vector< OutgoingDatagram >& datagrams, int firstDatagramIndex, int numDatagrams );
+	bool CanSendDatagramTrain( Connection* connection ) const;
+	bool SendDatagramTrain( Connection* connection, const OutgoingDatagram* datagrams, int numDatagrams );
+	static int CountDatagramsInTrain( const std::vector< OutgoingDatagram >& datagrams, int firstDatagramIndex );
+	int  ReceiveDatagrams( Connection* connection, ReceivedDatagram* datagrams, int maxNumDatagrams );
+	bool SelectReadableSockets( const std::vector< int >& connectionIDs, double maxSecondsToWait );
+
+	bool IsSimulatingConditions( Connection* connection ) const;
+	void ApplySimulatedConditions( int slotIndex );
+	void PumpSimulatedConnection( Connection* connection );
+	void CaptureReceivedDatagrams( const ReceivedDatagram* datagrams, int numDatagrams );
 
 	bool			m_hasBeenInitialized;
 
-	std::unordered_map< int, Connection* > m_connections;
+	static const int MAX_NUM_CONNECTIONS = 64;
+
+	struct ConnectionSlot
+	{
+		Connection	connection;
+		int			generation;
+		bool		isInUse;
+	};
+
+	ConnectionSlot		m_connectionSlots[ MAX_NUM_CONNECTIONS ];
+	int					m_freeConnectionSlotIndices[ MAX_NUM_CONNECTIONS ];
+	int					m_numFreeConnectionSlots;
+	CRITICAL_SECTION	m_connectionsCS;
+
+	int							m_defaultReceiveBufferBytes;
+	int							m_defaultSendBufferBytes;
+	SocketBackend				m_defaultSocketBackend;
+
+	SimulatedNetworkConditions	m_simulatedConditions;
+	PacketCaptureWriter			m_captureWriter;
 };
 
 #endif
\ No newline at end of file
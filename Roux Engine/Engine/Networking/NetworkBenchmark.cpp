@@ -0,0 +1,193 @@
+#define STATIC
+
+#include "NetworkBenchmark.hpp"
+
+#include <sstream>
+#include <vector>
+
+#include "Engine/Utilities/Time.hpp"
+
+const u_short BENCHMARK_PORT = 48771;
+const double BENCHMARK_TICK_SECONDS = 0.001;
+
+//Whatever is still in flight when sending stops gets this long to arrive
+const double BENCHMARK_DRAIN_SECONDS = 0.1;
+
+//About the size of a game update packet
+const int BENCHMARK_PACKET_SIZE_BYTES = 64;
+
+struct BenchmarkPacket
+{
+	double	sendTimeSeconds;
+	uint	packetNumber;
+	char	padding[ BENCHMARK_PACKET_SIZE_BYTES - sizeof( double ) - sizeof( uint ) ];
+};
+
+
+//-----------------------------------------------------------------------------------------------
+NetworkBenchmarkResult::NetworkBenchmarkResult()
+	: backend( SOCKET_BACKEND_NON_BLOCKING )
+	, wasBackendAvailable( false )
+	, targetPacketsPerSecond( 0 )
+	, durationSeconds( 0.0 )
+	, numPacketsSent( 0 )
+	, numPacketsReceived( 0 )
+	, secondsInSendCalls( 0.0 )
+	, secondsInReceiveCalls( 0.0 )
+	, totalLatencySeconds( 0.0 )
+	, maxLatencySeconds( 0.0 )
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Time per packet is what each backend costs the game thread, latency includes up to a tick of
+//waiting for the next drain
+std::string NetworkBenchmarkResult::GetAsString() const
+{
+	std::ostringstream outputStringStream;
+
+	outputStringStream << ( ( backend == SOCKET_BACKEND_IO_URING ) ? "io_uring" : "non-blocking" ) << " at " << targetPacketsPerSecond << "/s: ";
+
+	if( !wasBackendAvailable )
+	{
+		outputStringStream << "backend unavailable";
+		return outputStringStream.str();
+	}
+
+	outputStringStream << numPacketsReceived << " of " << numPacketsSent << " received";
+
+	if( numPacketsSent > 0 )
+	{
+		outputStringStream << ", send " << secondsInSendCalls * 1000000.0 / numPacketsSent << "us";
+	}
+
+	if( numPacketsReceived > 0 )
+	{
+		outputStringStream << ", receive " << secondsInReceiveCalls * 1000000.0 / numPacketsReceived << "us per packet";
+		outputStringStream << ", latency avg " << totalLatencySeconds * 1000.0 / numPacketsReceived << "ms max " << maxLatencySeconds * 1000.0 << "ms";
+	}
+
+	return outputStringStream.str();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC bool NetworkBenchmark::RunOverLoopback( SocketBackend backend, int packetsPerSecond, double durationSeconds, NetworkBenchmarkResult& out_result )
+{
+	Network& theNetwork = Network::GetInstance();
+
+	out_result = NetworkBenchmarkResult();
+	out_result.backend = backend;
+	out_result.targetPacketsPerSecond = packetsPerSecond;
+	out_result.durationSeconds = durationSeconds;
+
+	int receiverID = theNetwork.CreateUDPSocketFromIPAndPort( "127.0.0.1", BENCHMARK_PORT );
+	int senderID = theNetwork.CreateUDPSocketFromIPAndPort( "127.0.0.1", BENCHMARK_PORT );
+
+	//the default for new sockets may be the other backend, so both are set explicitly
+	out_result.wasBackendAvailable = theNetwork.SetSocketBackend( receiverID, backend ) && theNetwork.SetSocketBackend( senderID, backend );
+
+	if( !out_result.wasBackendAvailable )
+	{
+		theNetwork.CloseUDPSocket( senderID );
+		theNetwork.CloseUDPSocket( receiverID );
+		return false;
+	}
+
+	theNetwork.BindSocket( receiverID );
+
+	PeerAddress receiverAddress = theNetwork.GetPeerAddressFromConnection( receiverID );
+
+	std::vector< BenchmarkPacket > packetsToSend;
+	std::vector< OutgoingDatagram > datagramsToSend;
+
+	double startTimeSeconds = Time::GetCurrentTimeInSeconds();
+	double stopSendingTimeSeconds = startTimeSeconds + durationSeconds;
+	double stopTimeSeconds = stopSendingTimeSeconds + BENCHMARK_DRAIN_SECONDS;
+
+	for( ;; )
+	{
+		double currentTimeSeconds = Time::GetCurrentTimeInSeconds();
+
+		if( currentTimeSeconds >= stopTimeSeconds )
+		{
+			break;
+		}
+
+		//sends whatever the rate says is due by now, so a late tick catches up instead of falling behind
+		if( currentTimeSeconds < stopSendingTimeSeconds )
+		{
+			int numPacketsDue = static_cast< int >( ( currentTimeSeconds - startTimeSeconds ) * packetsPerSecond ) - out_result.numPacketsSent;
+
+			if( numPacketsDue > 0 )
+			{
+				packetsToSend.resize( numPacketsDue );
+				datagramsToSend.resize( numPacketsDue );
+
+				for( int i = 0; i < numPacketsDue; ++i )
+				{
+					packetsToSend[ i ].sendTimeSeconds = currentTimeSeconds;
+					packetsToSend[ i ].packetNumber = static_cast< uint >( out_result.numPacketsSent + i );
+
+					datagramsToSend[ i ].message = ( const char* )&packetsToSend[ i ];
+					datagramsToSend[ i ].messageSize = sizeof( BenchmarkPacket );
+					datagramsToSend[ i ].destinationAddress = receiverAddress;
+				}
+
+				double sendStartTimeSeconds = Time::GetCurrentTimeInSeconds();
+
+				theNetwork.SendUDPMessages( datagramsToSend, senderID );
+
+				out_result.secondsInSendCalls += Time::GetCurrentTimeInSeconds() - sendStartTimeSeconds;
+				out_result.numPacketsSent += numPacketsDue;
+			}
+		}
+
+		ReceivedDatagram* receivedDatagrams = nullptr;
+
+		for( ;; )
+		{
+			double receiveStartTimeSeconds = Time::GetCurrentTimeInSeconds();
+			int numDatagramsReceived = theNetwork.ReceiveUDPMessagesInPlace( receiverID, receivedDatagrams );
+			double receiveEndTimeSeconds = Time::GetCurrentTimeInSeconds();
+
+			out_result.secondsInReceiveCalls += receiveEndTimeSeconds - receiveStartTimeSeconds;
+
+			if( numDatagramsReceived == 0 )
+			{
+				break;
+			}
+
+			for( int i = 0; i < numDatagramsReceived; ++i )
+			{
+				if( receivedDatagrams[ i ].bytesReceived != sizeof( BenchmarkPacket ) )
+				{
+					continue;
+				}
+
+				const BenchmarkPacket* packet = reinterpret_cast< const BenchmarkPacket* >( receivedDatagrams[ i ].buffer );
+				double latencySeconds = receivedDatagrams[ i ].arrivalTimeSeconds - packet->sendTimeSeconds;
+
+				out_result.totalLatencySeconds += latencySeconds;
+
+				if( latencySeconds > out_result.maxLatencySeconds )
+				{
+					out_result.maxLatencySeconds = latencySeconds;
+				}
+
+				++out_result.numPacketsReceived;
+			}
+		}
+
+		theNetwork.ReleaseReceivedDatagrams( receiverID );
+
+		Sleep( static_cast< DWORD >( BENCHMARK_TICK_SECONDS * 1000.0 ) );
+	}
+
+	theNetwork.CloseUDPSocket( senderID );
+	theNetwork.CloseUDPSocket( receiverID );
+
+	return true;
+}
@@ -0,0 +1,42 @@
+#ifndef NETWORK_BENCHMARK_HPP
+#define NETWORK_BENCHMARK_HPP
+
+#pragma once
+
+#include <string>
+
+#include "Network.hpp"
+
+//-----------------------------------------------------------------------------------------------
+struct NetworkBenchmarkResult
+{
+	NetworkBenchmarkResult();
+
+	std::string GetAsString() const;
+
+	SocketBackend	backend;
+	bool			wasBackendAvailable;
+	int				targetPacketsPerSecond;
+	double			durationSeconds;
+	int				numPacketsSent;
+	int				numPacketsReceived;
+	double			secondsInSendCalls;
+	double			secondsInReceiveCalls;
+	double			totalLatencySeconds;
+	double			maxLatencySeconds;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+//Streams small datagrams between two sockets over loopback at a fixed rate, sending and draining
+//once a millisecond the way a server tick would, and times every Network call on the way. Both
+//sockets use the backend being measured. Blocks the calling thread for the whole run.
+class NetworkBenchmark
+{
+public:
+
+	static bool RunOverLoopback( SocketBackend backend, int packetsPerSecond, double durationSeconds, NetworkBenchmarkResult& out_result );
+};
+
+
+#endif
@@ -0,0 +1,198 @@
+#include "NetworkSimulator.hpp"
+
+//Like a router's queue, anything past this is dropped rather than held
+const int MAX_SIMULATED_DATAGRAMS_IN_FLIGHT = 4096;
+
+//xorshift gets stuck on zero
+const uint DEFAULT_SIMULATOR_SEED = 0x9E3779B9;
+
+//-----------------------------------------------------------------------------------------------
+SimulatedNetworkConditions::SimulatedNetworkConditions()
+	: latencySeconds( 0.0 )
+	, jitterSeconds( 0.0 )
+	, lossRate( 0.f )
+	, duplicateRate( 0.f )
+	, reorderRate( 0.f )
+	, reorderDelaySeconds( 0.0 )
+	, randomSeed( DEFAULT_SIMULATOR_SEED )
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool SimulatedNetworkConditions::IsEnabled() const
+{
+	return latencySeconds > 0.0 || jitterSeconds > 0.0 || lossRate > 0.f || duplicateRate > 0.f || reorderRate > 0.f;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------------------
+NetworkSimulator::NetworkSimulator()
+	: m_randomState( DEFAULT_SIMULATOR_SEED )
+{
+	InitializeCriticalSection( &m_simulatorCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+NetworkSimulator::~NetworkSimulator()
+{
+	DeleteCriticalSection( &m_simulatorCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Reseeds as well, so a run can be repeated by setting the same conditions again. Datagrams already
+//in flight keep the release times they were given.
+void NetworkSimulator::SetConditions( const SimulatedNetworkConditions& conditions, uint randomSeed )
+{
+	EnterCriticalSection( &m_simulatorCS );
+
+	m_conditions = conditions;
+	m_randomState = ( randomSeed != 0 ) ? randomSeed : DEFAULT_SIMULATOR_SEED;
+
+	LeaveCriticalSection( &m_simulatorCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Stays enabled while anything is still in flight so turning it off does not strand datagrams
+bool NetworkSimulator::IsEnabled() const
+{
+	EnterCriticalSection( &m_simulatorCS );
+
+	bool isEnabled = m_conditions.IsEnabled() || !m_datagramsInFlight.empty();
+
+	LeaveCriticalSection( &m_simulatorCS );
+
+	return isEnabled;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void NetworkSimulator::Clear()
+{
+	EnterCriticalSection( &m_simulatorCS );
+
+	m_conditions = SimulatedNetworkConditions();
+	m_datagramsInFlight.clear();
+
+	LeaveCriticalSection( &m_simulatorCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void NetworkSimulator::Submit( const PeerAddress& address, const char* data, int numBytes, double currentTimeSeconds )
+{
+	EnterCriticalSection( &m_simulatorCS );
+
+	int numCopies = 1;
+
+	if( GetRandomZeroToOne() < m_conditions.lossRate )
+	{
+		numCopies = 0;
+	}
+	else if( GetRandomZeroToOne() < m_conditions.duplicateRate )
+	{
+		numCopies = 2;
+	}
+
+	for( int i = 0; i < numCopies; ++i )
+	{
+		if( static_cast< int >( m_datagramsInFlight.size() ) >= MAX_SIMULATED_DATAGRAMS_IN_FLIGHT )
+		{
+			break;
+		}
+
+		//each copy rolls its own delay, so a duplicate can arrive before the original
+		auto insertedIter = m_datagramsInFlight.insert( std::make_pair( currentTimeSeconds + RollDelaySeconds(), SimulatedDatagram() ) );
+
+		insertedIter->second.address = address;
+		insertedIter->second.data.assign( data, data + numBytes );
+	}
+
+	LeaveCriticalSection( &m_simulatorCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool NetworkSimulator::PopDueDatagram( double currentTimeSeconds, SimulatedDatagram& out_datagram )
+{
+	bool didPop = false;
+
+	EnterCriticalSection( &m_simulatorCS );
+
+	auto firstIter = m_datagramsInFlight.begin();
+
+	if( firstIter != m_datagramsInFlight.end() && firstIter->first <= currentTimeSeconds )
+	{
+		out_datagram.address = firstIter->second.address;
+		out_datagram.data.swap( firstIter->second.data );
+
+		m_datagramsInFlight.erase( firstIter );
+		didPop = true;
+	}
+
+	LeaveCriticalSection( &m_simulatorCS );
+
+	return didPop;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool NetworkSimulator::HasDueDatagram( double currentTimeSeconds ) const
+{
+	double releaseTimeSeconds = 0.0;
+
+	return GetNextReleaseTime( releaseTimeSeconds ) && releaseTimeSeconds <= currentTimeSeconds;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool NetworkSimulator::GetNextReleaseTime( double& out_releaseTimeSeconds ) const
+{
+	bool hasDatagramInFlight = false;
+
+	EnterCriticalSection( &m_simulatorCS );
+
+	if( !m_datagramsInFlight.empty() )
+	{
+		out_releaseTimeSeconds = m_datagramsInFlight.begin()->first;
+		hasDatagramInFlight = true;
+	}
+
+	LeaveCriticalSection( &m_simulatorCS );
+
+	return hasDatagramInFlight;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Private Methods
+//-----------------------------------------------------------------------------------------------
+//xorshift32, rand() is shared with the game and would make runs depend on what else rolled
+float NetworkSimulator::GetRandomZeroToOne()
+{
+	m_randomState ^= m_randomState << 13;
+	m_randomState ^= m_randomState >> 17;
+	m_randomState ^= m_randomState << 5;
+
+	return static_cast< float >( m_randomState >> 8 ) * ( 1.f / 16777216.f );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+double NetworkSimulator::RollDelaySeconds()
+{
+	double delaySeconds = m_conditions.latencySeconds + m_conditions.jitterSeconds * GetRandomZeroToOne();
+
+	if( GetRandomZeroToOne() < m_conditions.reorderRate )
+	{
+		delaySeconds += m_conditions.reorderDelaySeconds;
+	}
+
+	return delaySeconds;
+}
@@ -0,0 +1,79 @@
+#ifndef NETWORK_SIMULATOR_HPP
+#define NETWORK_SIMULATOR_HPP
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "PeerAddress.hpp"
+#include "Engine/Utilities/PlatformThreading.hpp"
+#include "Engine/Utilities/CommonUtilities.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Applied to each direction on its own, so a round trip through one simulating process sees the
+//latency twice. Rates are 0 to 1. Jitter is added uniformly on top of the latency, and reordered
+//datagrams are held back an extra reorderDelaySeconds so the ones behind them overtake.
+struct SimulatedNetworkConditions
+{
+	SimulatedNetworkConditions();
+
+	bool IsEnabled() const;
+
+	double	latencySeconds;
+	double	jitterSeconds;
+	float	lossRate;
+	float	duplicateRate;
+	float	reorderRate;
+	double	reorderDelaySeconds;
+	uint	randomSeed;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+struct SimulatedDatagram
+{
+	PeerAddress			address;
+	std::vector< char >	data;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+//One direction of one connection. Datagrams go in as they are sent or read from the socket and
+//come back out once their release time has passed, if they survived. Every roll comes from the
+//simulator's own seeded generator, so the same seed and traffic give the same drops and delays.
+class NetworkSimulator
+{
+public:
+
+	NetworkSimulator();
+	~NetworkSimulator();
+
+	void SetConditions( const SimulatedNetworkConditions& conditions, uint randomSeed );
+	bool IsEnabled() const;
+	void Clear();
+
+	void Submit( const PeerAddress& address, const char* data, int numBytes, double currentTimeSeconds );
+	bool PopDueDatagram( double currentTimeSeconds, SimulatedDatagram& out_datagram );
+	bool HasDueDatagram( double currentTimeSeconds ) const;
+	bool GetNextReleaseTime( double& out_releaseTimeSeconds ) const;
+
+private:
+
+	NetworkSimulator( NetworkSimulator const& );
+	void operator=( NetworkSimulator const& );
+
+	float	GetRandomZeroToOne();
+	double	RollDelaySeconds();
+
+	SimulatedNetworkConditions						m_conditions;
+	uint											m_randomState;
+
+	//keyed by release time, equal times keep the order they were submitted in
+	std::multimap< double, SimulatedDatagram >		m_datagramsInFlight;
+
+	mutable CRITICAL_SECTION						m_simulatorCS;
+};
+
+
+#endif
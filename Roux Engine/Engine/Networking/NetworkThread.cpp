@@ -0,0 +1,261 @@
+#define STATIC
+
+#include "NetworkThread.hpp"
+
+#include "Engine/Networking/Network.hpp"
+#include "Engine/Utilities/PlatformThreading.hpp"
+
+#ifdef _WIN32
+#include "Engine/Utilities/InputHandler.hpp"
+#endif
+
+//Both rings together hold about 750KB, enough for several frames at full rate
+const int NUM_QUEUED_DATAGRAMS_EACH_WAY = 256;
+
+//Queued sends only go out when the thread wakes, so this is the most a send can wait
+const double MAX_NETWORK_THREAD_IDLE_SECONDS = 0.001;
+
+//-----------------------------------------------------------------------------------------------
+NetworkThread::NetworkThread()
+	: m_connectionID( INVALID_CONNECTION_ID )
+	, m_datagramsReceivedEvent( NULL )
+	, m_isRunning( 0 )
+	, m_shouldStop( 0 )
+{
+	m_datagramsReceivedEvent = CreateEvent( NULL, FALSE, FALSE, NULL );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+NetworkThread::~NetworkThread()
+{
+	ShutDown();
+
+	CloseHandle( m_datagramsReceivedEvent );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void NetworkThread::StartUp( int connectionID )
+{
+	ShutDown();
+
+	if( !m_incomingDatagrams.IsAllocated() )
+	{
+		m_incomingDatagrams.Allocate( NUM_QUEUED_DATAGRAMS_EACH_WAY );
+		m_outgoingDatagrams.Allocate( NUM_QUEUED_DATAGRAMS_EACH_WAY );
+	}
+
+	m_connectionID = connectionID;
+
+	InterlockedExchange( &m_shouldStop, 0 );
+	InterlockedExchange( &m_isRunning, 1 );
+
+	_beginthread( &NetworkThread::EntryFunction, 0, this );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Blocks until the thread has let go of the socket. Anything still queued is dropped.
+void NetworkThread::ShutDown()
+{
+	if( m_isRunning == 0 )
+	{
+		return;
+	}
+
+	InterlockedExchange( &m_shouldStop, 1 );
+
+	while( m_isRunning != 0 )
+	{
+		Sleep( 1 );
+	}
+
+	m_incomingDatagrams.Pop( m_incomingDatagrams.GetNumReadable() );
+	m_outgoingDatagrams.Pop( m_outgoingDatagrams.GetNumReadable() );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int NetworkThread::GetNumReceivedDatagrams() const
+{
+	if( !m_incomingDatagrams.IsAllocated() )
+	{
+		return 0;
+	}
+
+	return m_incomingDatagrams.GetNumReadable();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Stays valid until ReleaseReceivedDatagrams, the network thread will not reuse it before then
+const QueuedDatagram* NetworkThread::GetReceivedDatagram( int index ) const
+{
+	return m_incomingDatagrams.PeekAt( index );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void NetworkThread::ReleaseReceivedDatagrams( int numDatagrams )
+{
+	if( numDatagrams > 0 )
+	{
+		m_incomingDatagrams.Pop( numDatagrams );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Returns true if there are datagrams to read, whether they were already waiting or arrived in time
+bool NetworkThread::WaitForReceivedDatagrams( double maxSecondsToWait ) const
+{
+	if( GetNumReceivedDatagrams() > 0 )
+	{
+		return true;
+	}
+
+	if( maxSecondsToWait > 0.0 )
+	{
+		WaitForSingleObject( m_datagramsReceivedEvent, static_cast< DWORD >( maxSecondsToWait * 1000.0 ) );
+	}
+
+	return GetNumReceivedDatagrams() > 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Copies the message into the outgoing ring. If the ring is full the network thread has fallen
+//far behind, so the message goes straight out on this thread rather than being lost.
+void NetworkThread::SendTo( const PeerAddress& destination, const void* message, int messageSize )
+{
+	QueuedDatagram* slot = nullptr;
+
+	if( m_isRunning != 0 && messageSize <= MAX_DATAGRAM_SIZE_BYTES )
+	{
+		slot = m_outgoingDatagrams.BeginPush();
+	}
+
+	if( slot == nullptr )
+	{
+		Network::GetInstance().SendTo( m_connectionID, destination, message, messageSize );
+		return;
+	}
+
+	slot->address = destination;
+	slot->arrivalTimeSeconds = 0.0;
+	slot->numBytes = messageSize;
+	memcpy( slot->data, message, messageSize );
+
+	m_outgoingDatagrams.EndPush();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Private Methods
+//-----------------------------------------------------------------------------------------------
+STATIC void NetworkThread::EntryFunction( void* networkThreadAsVoid )
+{
+	NetworkThread* networkThread = static_cast< NetworkThread* >( networkThreadAsVoid );
+
+	networkThread->Run();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void NetworkThread::Run()
+{
+	Network& theNetwork = Network::GetInstance();
+
+#ifdef _WIN32
+	while( !InputHandler::ShouldQuit() && m_shouldStop == 0 )
+#else
+	//no window to close on a headless build, ShutDown is the only way out
+	while( m_shouldStop == 0 )
+#endif
+	{
+		SendFromOutgoingRing();
+
+		if( theNetwork.WaitForIncomingData( m_connectionID, MAX_NETWORK_THREAD_IDLE_SECONDS ) )
+		{
+			ReceiveIntoIncomingRing();
+		}
+	}
+
+	SendFromOutgoingRing();
+
+	InterlockedExchange( &m_isRunning, 0 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Receives straight into the ring's slots. When the ring is full the rest stays in the socket's
+//own buffer until the game thread catches up.
+void NetworkThread::ReceiveIntoIncomingRing()
+{
+	Network& theNetwork = Network::GetInstance();
+
+	bool receivedAny = false;
+
+	for( ;; )
+	{
+		QueuedDatagram* slot = m_incomingDatagrams.BeginPush();
+
+		if( slot == nullptr )
+		{
+			break;
+		}
+
+		ReceivedDatagram datagram;
+
+		datagram.buffer = slot->data;
+		datagram.bufferSize = MAX_DATAGRAM_SIZE_BYTES;
+		datagram.bytesReceived = 0;
+
+		if( theNetwork.ReceiveUDPMessages( &datagram, 1, m_connectionID ) == 0 )
+		{
+			break;
+		}
+
+		slot->address = datagram.sourceAddress;
+		slot->arrivalTimeSeconds = datagram.arrivalTimeSeconds;
+		slot->numBytes = datagram.bytesReceived;
+
+		m_incomingDatagrams.EndPush();
+		receivedAny = true;
+	}
+
+	if( receivedAny )
+	{
+		SetEvent( m_datagramsReceivedEvent );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void NetworkThread::SendFromOutgoingRing()
+{
+	int numToSend = m_outgoingDatagrams.GetNumReadable();
+
+	if( numToSend == 0 )
+	{
+		return;
+	}
+
+	//sent as one batch so runs to the same peer can go out as a single segmented send
+	m_datagramsToSend.resize( numToSend );
+
+	for( int i = 0; i < numToSend; ++i )
+	{
+		const QueuedDatagram* datagram = m_outgoingDatagrams.PeekAt( i );
+
+		m_datagramsToSend[ i ].message = datagram->data;
+		m_datagramsToSend[ i ].messageSize = datagram->numBytes;
+		m_datagramsToSend[ i ].destinationAddress = datagram->address;
+	}
+
+	Network::GetInstance().SendUDPMessages( m_datagramsToSend, m_connectionID );
+
+	m_datagramsToSend.clear();
+	m_outgoingDatagrams.Pop( numToSend );
+}
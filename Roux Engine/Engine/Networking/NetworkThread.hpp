@@ -0,0 +1,85 @@
+#ifndef NETWORK_THREAD_HPP
+#define NETWORK_THREAD_HPP
+
+#pragma once
+
+#include "Engine/Networking/Datagram.hpp"
+#include "Engine/Networking/PeerAddress.hpp"
+#include "Engine/Utilities/SPSCRing.hpp"
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+//One datagram crossing between the network thread and the game thread. The address is where it
+//came from when received and where it goes when sent.
+struct QueuedDatagram
+{
+	PeerAddress	address;
+	double		arrivalTimeSeconds;
+	int			numBytes;
+	char		data[ MAX_DATAGRAM_SIZE_BYTES ];
+};
+
+
+//-----------------------------------------------------------------------------------------------
+//Owns one connection's socket while running. Datagrams are received and stamped with their
+//arrival time the moment they land, and sent as soon as the game thread queues them, so a
+//slow frame only delays when the game reads them rather than when they cross the wire.
+//While it runs, the game thread must not receive on the connection itself.
+class NetworkThread
+{
+public:
+
+	NetworkThread();
+	~NetworkThread();
+
+	void StartUp( int connectionID );
+	void ShutDown();
+
+	//game thread only
+	int						GetNumReceivedDatagrams() const;
+	const QueuedDatagram*	GetReceivedDatagram( int index ) const;
+	void					ReleaseReceivedDatagrams( int numDatagrams );
+	bool					WaitForReceivedDatagrams( double maxSecondsToWait ) const;
+
+	void					SendTo( const PeerAddress& destination, const void* message, int messageSize );
+
+	inline bool IsRunning() const;
+	inline int	GetConnectionID() const;
+
+private:
+
+	NetworkThread( const NetworkThread& );
+	void operator=( const NetworkThread& );
+
+	static void EntryFunction( void* networkThreadAsVoid );
+
+	void Run();
+	void ReceiveIntoIncomingRing();
+	void SendFromOutgoingRing();
+
+	int								m_connectionID;
+	SPSCRing< QueuedDatagram >		m_incomingDatagrams;
+	SPSCRing< QueuedDatagram >		m_outgoingDatagrams;
+	std::vector< OutgoingDatagram >	m_datagramsToSend;
+	HANDLE							m_datagramsReceivedEvent;
+
+	volatile LONG					m_isRunning;
+	volatile LONG					m_shouldStop;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline bool NetworkThread::IsRunning() const
+{
+	return m_isRunning != 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline int NetworkThread::GetConnectionID() const
+{
+	return m_connectionID;
+}
+
+
+#endif
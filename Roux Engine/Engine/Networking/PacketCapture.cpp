@@ -0,0 +1,212 @@
+#include "PacketCapture.hpp"
+
+#include "Engine/Utilities/Time.hpp"
+
+//"RXCP" read as a little endian uint
+const uint PACKET_CAPTURE_MAGIC = 0x50435852;
+
+//Bumped whenever what gets recorded changes meaning, payload formats included. Version 1 captures
+//hold game packets from before their headers gained channel sequences and a protocol version.
+const uint PACKET_CAPTURE_VERSION = 2;
+
+//-----------------------------------------------------------------------------------------------
+PacketCaptureWriter::PacketCaptureWriter()
+	: m_file( nullptr )
+	, m_startTimeSeconds( 0.0 )
+	, m_numRecords( 0 )
+{
+	InitializeCriticalSection( &m_writerCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+PacketCaptureWriter::~PacketCaptureWriter()
+{
+	Close();
+
+	DeleteCriticalSection( &m_writerCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Replaces any capture already at the path
+bool PacketCaptureWriter::Open( const std::string& filePath )
+{
+	Close();
+
+	FILE* file = fopen( filePath.c_str(), "wb" );
+
+	if( file == nullptr )
+	{
+		return false;
+	}
+
+	fwrite( &PACKET_CAPTURE_MAGIC, sizeof( PACKET_CAPTURE_MAGIC ), 1, file );
+	fwrite( &PACKET_CAPTURE_VERSION, sizeof( PACKET_CAPTURE_VERSION ), 1, file );
+
+	EnterCriticalSection( &m_writerCS );
+
+	m_file = file;
+	m_startTimeSeconds = Time::GetCurrentTimeInSeconds();
+	m_numRecords = 0;
+
+	LeaveCriticalSection( &m_writerCS );
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void PacketCaptureWriter::Close()
+{
+	EnterCriticalSection( &m_writerCS );
+
+	if( m_file != nullptr )
+	{
+		fclose( m_file );
+		m_file = nullptr;
+	}
+
+	LeaveCriticalSection( &m_writerCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool PacketCaptureWriter::IsOpen() const
+{
+	return m_file != nullptr;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Written through stdio's buffer, so a record costs a memcpy until the buffer fills
+void PacketCaptureWriter::Record( CaptureDirection direction, const PeerAddress& address, const char* data, int numBytes, double timeSeconds )
+{
+	if( numBytes < 0 || numBytes > 0xFFFF )
+	{
+		return;
+	}
+
+	uchar directionAsByte = static_cast< uchar >( direction );
+	uint ipAddress = static_cast< uint >( address.m_ipAddress );
+	u_short numBytesAsShort = static_cast< u_short >( numBytes );
+
+	EnterCriticalSection( &m_writerCS );
+
+	if( m_file != nullptr )
+	{
+		double timestampSeconds = timeSeconds - m_startTimeSeconds;
+
+		fwrite( &timestampSeconds, sizeof( timestampSeconds ), 1, m_file );
+		fwrite( &directionAsByte, sizeof( directionAsByte ), 1, m_file );
+		fwrite( &ipAddress, sizeof( ipAddress ), 1, m_file );
+		fwrite( &address.m_port, sizeof( address.m_port ), 1, m_file );
+		fwrite( &numBytesAsShort, sizeof( numBytesAsShort ), 1, m_file );
+		fwrite( data, numBytes, 1, m_file );
+
+		++m_numRecords;
+	}
+
+	LeaveCriticalSection( &m_writerCS );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------------------------
+PacketCaptureReader::PacketCaptureReader()
+	: m_file( nullptr )
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+PacketCaptureReader::~PacketCaptureReader()
+{
+	Close();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Refuses captures from any other version, older payloads would be misread rather than fail
+bool PacketCaptureReader::Open( const std::string& filePath )
+{
+	Close();
+
+	m_file = fopen( filePath.c_str(), "rb" );
+
+	if( m_file == nullptr )
+	{
+		return false;
+	}
+
+	uint magic = 0;
+	uint version = 0;
+
+	fread( &magic, sizeof( magic ), 1, m_file );
+	fread( &version, sizeof( version ), 1, m_file );
+
+	if( magic != PACKET_CAPTURE_MAGIC || version != PACKET_CAPTURE_VERSION )
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void PacketCaptureReader::Close()
+{
+	if( m_file != nullptr )
+	{
+		fclose( m_file );
+		m_file = nullptr;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool PacketCaptureReader::IsOpen() const
+{
+	return m_file != nullptr;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//False at the end of the capture, or at a record cut short by the recorder being killed
+bool PacketCaptureReader::ReadNextRecord( CapturedDatagram& out_datagram )
+{
+	if( m_file == nullptr )
+	{
+		return false;
+	}
+
+	uchar directionAsByte = 0;
+	uint ipAddress = 0;
+	u_short numBytes = 0;
+
+	bool didReadHeader = fread( &out_datagram.timestampSeconds, sizeof( out_datagram.timestampSeconds ), 1, m_file ) == 1
+		&& fread( &directionAsByte, sizeof( directionAsByte ), 1, m_file ) == 1
+		&& fread( &ipAddress, sizeof( ipAddress ), 1, m_file ) == 1
+		&& fread( &out_datagram.address.m_port, sizeof( out_datagram.address.m_port ), 1, m_file ) == 1
+		&& fread( &numBytes, sizeof( numBytes ), 1, m_file ) == 1;
+
+	if( !didReadHeader )
+	{
+		return false;
+	}
+
+	out_datagram.direction = static_cast< CaptureDirection >( directionAsByte );
+	out_datagram.address.m_ipAddress = ipAddress;
+	out_datagram.data.resize( numBytes );
+
+	if( numBytes > 0 && fread( &out_datagram.data[ 0 ], numBytes, 1, m_file ) != 1 )
+	{
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,96 @@
+#ifndef PACKET_CAPTURE_HPP
+#define PACKET_CAPTURE_HPP
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "PeerAddress.hpp"
+#include "Engine/Utilities/PlatformThreading.hpp"
+#include "Engine/Utilities/CommonUtilities.hpp"
+
+//-----------------------------------------------------------------------------------------------
+enum CaptureDirection
+{
+	CAPTURE_SENT,
+	CAPTURE_RECEIVED
+};
+
+
+//-----------------------------------------------------------------------------------------------
+//Timestamps are seconds since the capture was opened. Addresses are the remote end, the
+//destination of a send or the source of a receive.
+struct CapturedDatagram
+{
+	double				timestampSeconds;
+	CaptureDirection	direction;
+	PeerAddress			address;
+	std::vector< char >	data;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+//File layout is a magic number and version, then one record per datagram: timestamp (double),
+//direction (uchar), ip (uint) and port (network byte order), payload size (u_short) and the payload.
+//Safe to record from the network thread and the game thread at once.
+class PacketCaptureWriter
+{
+public:
+
+	PacketCaptureWriter();
+	~PacketCaptureWriter();
+
+	bool Open( const std::string& filePath );
+	void Close();
+	bool IsOpen() const;
+
+	void Record( CaptureDirection direction, const PeerAddress& address, const char* data, int numBytes, double timeSeconds );
+
+	inline uint GetNumRecords() const;
+
+private:
+
+	PacketCaptureWriter( PacketCaptureWriter const& );
+	void operator=( PacketCaptureWriter const& );
+
+	FILE*						m_file;
+	double						m_startTimeSeconds;
+	uint						m_numRecords;
+
+	mutable CRITICAL_SECTION	m_writerCS;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+class PacketCaptureReader
+{
+public:
+
+	PacketCaptureReader();
+	~PacketCaptureReader();
+
+	bool Open( const std::string& filePath );
+	void Close();
+	bool IsOpen() const;
+
+	bool ReadNextRecord( CapturedDatagram& out_datagram );
+
+private:
+
+	PacketCaptureReader( PacketCaptureReader const& );
+	void operator=( PacketCaptureReader const& );
+
+	FILE*	m_file;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline uint PacketCaptureWriter::GetNumRecords() const
+{
+	return m_numRecords;
+}
+
+
+#endif
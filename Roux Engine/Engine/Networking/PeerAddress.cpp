@@ -0,0 +1,67 @@
+#include "PeerAddress.hpp"
+
+#include <stdlib.h>
+#include <sstream>
+
+//-----------------------------------------------------------------------------------------------
+PeerAddress::PeerAddress()
+	: m_ipAddress( 0 )
+	, m_port( 0 )
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+PeerAddress::PeerAddress( const struct sockaddr_in& socketAddress )
+	: m_ipAddress( socketAddress.sin_addr.s_addr )
+	, m_port( socketAddress.sin_port )
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+PeerAddress::PeerAddress( const std::string& ipAddressAsString, const std::string& portAsString )
+	: m_ipAddress( inet_addr( ipAddressAsString.c_str() ) )
+	, m_port( htons( u_short( atoi( portAsString.c_str() ) ) ) )
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+struct sockaddr_in PeerAddress::ToSocketAddress() const
+{
+	struct sockaddr_in socketAddress;
+
+	memset( ( char* )&socketAddress, 0, sizeof( socketAddress ) );
+
+	socketAddress.sin_family = AF_INET;
+	socketAddress.sin_addr.s_addr = m_ipAddress;
+	socketAddress.sin_port = m_port;
+
+	return socketAddress;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+std::string PeerAddress::GetIPAddressAsString() const
+{
+	struct in_addr address;
+
+	address.s_addr = m_ipAddress;
+
+	return inet_ntoa( address );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+std::string PeerAddress::GetPortAsString() const
+{
+	std::ostringstream portStream;
+
+	portStream << ntohs( m_port );
+
+	return portStream.str();
+}
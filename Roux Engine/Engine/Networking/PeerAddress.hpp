@@ -0,0 +1,68 @@
+#ifndef PEER_ADDRESS_HPP
+#define PEER_ADDRESS_HPP
+
+#pragma once
+
+#include <string>
+
+#include "SocketPlatform.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Both members are kept in network byte order so converting to and from a sockaddr_in is a copy
+class PeerAddress
+{
+public:
+
+	PeerAddress();
+	explicit PeerAddress( const struct sockaddr_in& socketAddress );
+	PeerAddress( const std::string& ipAddressAsString, const std::string& portAsString );
+
+	struct sockaddr_in	ToSocketAddress() const;
+	std::string			GetIPAddressAsString() const;
+	std::string			GetPortAsString() const;
+
+	inline bool IsValid() const;
+
+	inline bool operator==( const PeerAddress& other ) const;
+	inline bool operator!=( const PeerAddress& other ) const;
+	inline bool operator<( const PeerAddress& other ) const;
+
+	u_long	m_ipAddress;
+	u_short	m_port;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline bool PeerAddress::IsValid() const
+{
+	return m_port != 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline bool PeerAddress::operator==( const PeerAddress& other ) const
+{
+	return m_ipAddress == other.m_ipAddress && m_port == other.m_port;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline bool PeerAddress::operator!=( const PeerAddress& other ) const
+{
+	return !( *this == other );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline bool PeerAddress::operator<( const PeerAddress& other ) const
+{
+	if( m_ipAddress != other.m_ipAddress )
+	{
+		return m_ipAddress < other.m_ipAddress;
+	}
+
+	return m_port < other.m_port;
+}
+
+
+#endif
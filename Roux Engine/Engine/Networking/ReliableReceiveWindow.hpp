@@ -0,0 +1,198 @@
+#ifndef RELIABLE_RECEIVE_WINDOW_HPP
+#define RELIABLE_RECEIVE_WINDOW_HPP
+
+#pragma once
+
+#include "Engine/Utilities/CommonUtilities.hpp"
+
+//How far past a gap reliable messages are held, anything further is left for the sender to resend
+const int RELIABLE_RECEIVE_WINDOW_SIZE = 256;
+
+enum ReliableReceiveResult
+{
+	RECEIVE_Buffered,
+	RECEIVE_Duplicate,
+	RECEIVE_TooFarAhead
+};
+
+//-----------------------------------------------------------------------------------------------
+//Holds reliable messages that arrived ahead of a gap, in a fixed ring indexed by sequence number,
+//and hands them back strictly in order once the gap is filled. A message is only released after
+//every message numbered before it, so the game sees the sender's order whatever the network did.
+template< typename T >
+class ReliableReceiveWindow
+{
+public:
+
+	ReliableReceiveWindow();
+
+	void					Reset( uint firstSequenceNumber );
+	ReliableReceiveResult	Receive( uint sequenceNumber, const T& message );
+	ReliableReceiveResult	ReceiveUnordered( uint sequenceNumber );
+	bool					PopNextInOrder( T& out_message );
+
+	inline uint GetNextSequenceNumber() const;
+	inline int	GetNumBuffered() const;
+
+private:
+
+	struct BufferedMessage
+	{
+		T		message;
+		uint	sequenceNumber;
+		bool	isBuffered;
+	};
+
+	BufferedMessage	m_slots[ RELIABLE_RECEIVE_WINDOW_SIZE ];
+	uint			m_nextSequenceNumber;
+	int				m_numBuffered;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+ReliableReceiveWindow< T >::ReliableReceiveWindow()
+{
+	Reset( 0 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Drops anything buffered, for a new peer whose numbering starts over
+template< typename T >
+void ReliableReceiveWindow< T >::Reset( uint firstSequenceNumber )
+{
+	for( int i = 0; i < RELIABLE_RECEIVE_WINDOW_SIZE; ++i )
+	{
+		m_slots[ i ].isBuffered = false;
+	}
+
+	m_nextSequenceNumber = firstSequenceNumber;
+	m_numBuffered = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Duplicates are messages already released or already waiting, the sender only needs acking again.
+//Too far ahead is not kept, and should not be acked either, so the sender tries again later.
+template< typename T >
+ReliableReceiveResult ReliableReceiveWindow< T >::Receive( uint sequenceNumber, const T& message )
+{
+	uint numbersAhead = sequenceNumber - m_nextSequenceNumber;
+
+	if( numbersAhead >= 0x80000000 )
+	{
+		return RECEIVE_Duplicate;
+	}
+
+	if( numbersAhead >= static_cast< uint >( RELIABLE_RECEIVE_WINDOW_SIZE ) )
+	{
+		return RECEIVE_TooFarAhead;
+	}
+
+	BufferedMessage& slot = m_slots[ sequenceNumber % RELIABLE_RECEIVE_WINDOW_SIZE ];
+
+	if( slot.isBuffered )
+	{
+		return RECEIVE_Duplicate;
+	}
+
+	slot.message = message;
+	slot.sequenceNumber = sequenceNumber;
+	slot.isBuffered = true;
+
+	++m_numBuffered;
+
+	return RECEIVE_Buffered;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//For messages handed over as soon as they arrive, where Buffered means new. Nothing is kept but which
+//numbers arrived, so a resent copy is still spotted after the gap before it fills in.
+template< typename T >
+ReliableReceiveResult ReliableReceiveWindow< T >::ReceiveUnordered( uint sequenceNumber )
+{
+	uint numbersAhead = sequenceNumber - m_nextSequenceNumber;
+
+	if( numbersAhead >= 0x80000000 )
+	{
+		return RECEIVE_Duplicate;
+	}
+
+	if( numbersAhead >= static_cast< uint >( RELIABLE_RECEIVE_WINDOW_SIZE ) )
+	{
+		return RECEIVE_TooFarAhead;
+	}
+
+	BufferedMessage& slot = m_slots[ sequenceNumber % RELIABLE_RECEIVE_WINDOW_SIZE ];
+
+	if( slot.isBuffered )
+	{
+		return RECEIVE_Duplicate;
+	}
+
+	slot.sequenceNumber = sequenceNumber;
+	slot.isBuffered = true;
+
+	++m_numBuffered;
+
+	//numbers with none missing before them can never come up again
+	for( ;; )
+	{
+		BufferedMessage& nextSlot = m_slots[ m_nextSequenceNumber % RELIABLE_RECEIVE_WINDOW_SIZE ];
+
+		if( !nextSlot.isBuffered || nextSlot.sequenceNumber != m_nextSequenceNumber )
+		{
+			break;
+		}
+
+		nextSlot.isBuffered = false;
+
+		++m_nextSequenceNumber;
+		--m_numBuffered;
+	}
+
+	return RECEIVE_Buffered;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//False once the next message in order has not arrived yet
+template< typename T >
+bool ReliableReceiveWindow< T >::PopNextInOrder( T& out_message )
+{
+	BufferedMessage& slot = m_slots[ m_nextSequenceNumber % RELIABLE_RECEIVE_WINDOW_SIZE ];
+
+	if( !slot.isBuffered || slot.sequenceNumber != m_nextSequenceNumber )
+	{
+		return false;
+	}
+
+	out_message = slot.message;
+	slot.isBuffered = false;
+
+	++m_nextSequenceNumber;
+	--m_numBuffered;
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+inline uint ReliableReceiveWindow< T >::GetNextSequenceNumber() const
+{
+	return m_nextSequenceNumber;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+inline int ReliableReceiveWindow< T >::GetNumBuffered() const
+{
+	return m_numBuffered;
+}
+
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef RELIABLE_SEND_WINDOW_HPP
+#define RELIABLE_SEND_WINDOW_HPP
+
+#pragma once
+
+#include "Engine/Utilities/CommonUtilities.hpp"
+
+//More unacked than this and the peer is not really there
+const int RELIABLE_SEND_WINDOW_SIZE = 256;
+
+//-----------------------------------------------------------------------------------------------
+//Reliable messages sent and not yet acked, kept in a fixed ring indexed by sequence number, so
+//adding, acking and finding one is a single slot lookup with no allocation. Numbers are expected
+//to go up one per message. One that lands a full window ahead of the oldest unacked message has no
+//slot, and Add refuses it, so senders hold messages back until HasRoomFor says the next number fits.
+template< typename T >
+class ReliableSendWindow
+{
+public:
+
+	struct InFlightMessage
+	{
+		T		message;
+		uint	sequenceNumber;
+		double	resendTimeSeconds;
+		int		numTimesResent;
+		bool	isInFlight;
+	};
+
+	ReliableSendWindow();
+
+	bool				Add( uint sequenceNumber, const T& message, double resendTimeSeconds );
+	bool				Remove( uint sequenceNumber );
+	InFlightMessage*	Find( uint sequenceNumber );
+	void				Clear();
+
+	inline bool HasRoomFor( uint sequenceNumber ) const;
+	inline uint GetOldestSequenceNumber() const;
+	inline uint GetEndSequenceNumber() const;
+	inline int	GetNumInFlight() const;
+
+private:
+
+	InFlightMessage	m_slots[ RELIABLE_SEND_WINDOW_SIZE ];
+	uint			m_oldestSequenceNumber;
+	uint			m_endSequenceNumber;
+	int				m_numInFlight;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+ReliableSendWindow< T >::ReliableSendWindow()
+{
+	Clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+bool ReliableSendWindow< T >::Add( uint sequenceNumber, const T& message, double resendTimeSeconds )
+{
+	if( m_numInFlight == 0 )
+	{
+		m_oldestSequenceNumber = sequenceNumber;
+		m_endSequenceNumber = sequenceNumber;
+	}
+
+	InFlightMessage& slot = m_slots[ sequenceNumber % RELIABLE_SEND_WINDOW_SIZE ];
+
+	if( sequenceNumber - m_oldestSequenceNumber >= static_cast< uint >( RELIABLE_SEND_WINDOW_SIZE ) || slot.isInFlight )
+	{
+		return false;
+	}
+
+	slot.message = message;
+	slot.sequenceNumber = sequenceNumber;
+	slot.resendTimeSeconds = resendTimeSeconds;
+	slot.numTimesResent = 0;
+	slot.isInFlight = true;
+
+	++m_numInFlight;
+
+	if( sequenceNumber - m_endSequenceNumber < 0x80000000 )
+	{
+		m_endSequenceNumber = sequenceNumber + 1;
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Acking the oldest message slides the window up to the next one still unacked
+template< typename T >
+bool ReliableSendWindow< T >::Remove( uint sequenceNumber )
+{
+	InFlightMessage* inFlightMessage = Find( sequenceNumber );
+
+	if( inFlightMessage == nullptr )
+	{
+		return false;
+	}
+
+	inFlightMessage->isInFlight = false;
+	--m_numInFlight;
+
+	while( m_oldestSequenceNumber != m_endSequenceNumber && Find( m_oldestSequenceNumber ) == nullptr )
+	{
+		++m_oldestSequenceNumber;
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+typename ReliableSendWindow< T >::InFlightMessage* ReliableSendWindow< T >::Find( uint sequenceNumber )
+{
+	InFlightMessage& slot = m_slots[ sequenceNumber % RELIABLE_SEND_WINDOW_SIZE ];
+
+	if( !slot.isInFlight || slot.sequenceNumber != sequenceNumber )
+	{
+		return nullptr;
+	}
+
+	return &slot;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+void ReliableSendWindow< T >::Clear()
+{
+	for( int i = 0; i < RELIABLE_SEND_WINDOW_SIZE; ++i )
+	{
+		m_slots[ i ].isInFlight = false;
+	}
+
+	m_oldestSequenceNumber = 0;
+	m_endSequenceNumber = 0;
+	m_numInFlight = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Whether Add would take this number now
+template< typename T >
+inline bool ReliableSendWindow< T >::HasRoomFor( uint sequenceNumber ) const
+{
+	if( m_numInFlight == 0 )
+	{
+		return true;
+	}
+
+	return sequenceNumber - m_oldestSequenceNumber < static_cast< uint >( RELIABLE_SEND_WINDOW_SIZE ) && !m_slots[ sequenceNumber % RELIABLE_SEND_WINDOW_SIZE ].isInFlight;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+inline uint ReliableSendWindow< T >::GetOldestSequenceNumber() const
+{
+	return m_oldestSequenceNumber;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//One past the newest message added, so walking from the oldest up to this visits every slot in use
+template< typename T >
+inline uint ReliableSendWindow< T >::GetEndSequenceNumber() const
+{
+	return m_endSequenceNumber;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+inline int ReliableSendWindow< T >::GetNumInFlight() const
+{
+	return m_numInFlight;
+}
+
+
+#endif
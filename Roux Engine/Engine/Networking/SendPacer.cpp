@@ -0,0 +1,181 @@
+#include "SendPacer.hpp"
+
+#include <sstream>
+#include <iomanip>
+
+#include "Engine/Networking/ConnectionStats.hpp"
+#include "Engine/Rendering/ConsoleLog.hpp"
+
+//Low enough to start on any link, the floor still carries a few updates a frame
+const double INITIAL_SEND_RATE_BYTES_PER_SECOND = 64.0 * 1024.0;
+const double MIN_SEND_RATE_BYTES_PER_SECOND = 16.0 * 1024.0;
+const double MAX_SEND_RATE_BYTES_PER_SECOND = 4.0 * 1024.0 * 1024.0;
+
+//Additive increase and multiplicative decrease, once per round trip
+const double SEND_RATE_INCREASE_BYTES_PER_SECOND = 8.0 * 1024.0;
+const double SEND_RATE_DECREASE_FACTOR = 0.7;
+
+//Round trips this far above the quietest one mean the extra time is spent waiting in a queue
+const double MAX_QUEUEING_DELAY_SECONDS = 0.05;
+
+//Rate changes wait for a round trip to see the last one's effect, and this long before there is one
+const double DEFAULT_RATE_CHANGE_INTERVAL_SECONDS = 0.25;
+const double MIN_RATE_CHANGE_INTERVAL_SECONDS = 0.02;
+
+//An idle link saves up no more than this, and always enough for one full datagram
+const double MAX_BURST_SECONDS = 0.05;
+const double MIN_BURST_BYTES = 1500.0;
+
+//-----------------------------------------------------------------------------------------------
+SendPacer::SendPacer()
+{
+	Reset();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SendPacer::Reset()
+{
+	m_sendRateBytesPerSecond = INITIAL_SEND_RATE_BYTES_PER_SECOND;
+	m_availableBytes = 0.0;
+	m_lastUpdateTimeSeconds = 0.0;
+	m_nextRateChangeTimeSeconds = 0.0;
+
+	m_minRoundTripSeconds = 0.0;
+	m_hasMinRoundTrip = false;
+
+	m_numResendsAtLastRateChange = 0;
+	m_numSendsSkipped = 0;
+	m_hasUpdated = false;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Refills the bucket for the time since the last call and, once a round trip has gone by, moves the
+//rate. Call it before deciding whether to send.
+void SendPacer::Update( const ConnectionStats& stats, double currentTimeSeconds )
+{
+	double maxAvailableBytes = m_sendRateBytesPerSecond * MAX_BURST_SECONDS;
+
+	if( maxAvailableBytes < MIN_BURST_BYTES )
+	{
+		maxAvailableBytes = MIN_BURST_BYTES;
+	}
+
+	if( !m_hasUpdated )
+	{
+		m_availableBytes = maxAvailableBytes;
+		m_lastUpdateTimeSeconds = currentTimeSeconds;
+		m_nextRateChangeTimeSeconds = currentTimeSeconds + DEFAULT_RATE_CHANGE_INTERVAL_SECONDS;
+		m_numResendsAtLastRateChange = stats.GetNumResends();
+		m_hasUpdated = true;
+		return;
+	}
+
+	m_availableBytes += m_sendRateBytesPerSecond * ( currentTimeSeconds - m_lastUpdateTimeSeconds );
+	m_lastUpdateTimeSeconds = currentTimeSeconds;
+
+	if( m_availableBytes > maxAvailableBytes )
+	{
+		m_availableBytes = maxAvailableBytes;
+	}
+
+	double roundTripSeconds = stats.GetSmoothedRoundTripSeconds();
+
+	//kept for the whole connection, a quietest round trip taken while a queue was up would hide it
+	if( stats.HasRoundTripSample() && ( !m_hasMinRoundTrip || roundTripSeconds < m_minRoundTripSeconds ) )
+	{
+		m_minRoundTripSeconds = roundTripSeconds;
+		m_hasMinRoundTrip = true;
+	}
+
+	if( currentTimeSeconds < m_nextRateChangeTimeSeconds )
+	{
+		return;
+	}
+
+	double rateChangeIntervalSeconds = DEFAULT_RATE_CHANGE_INTERVAL_SECONDS;
+
+	if( stats.HasRoundTripSample() )
+	{
+		rateChangeIntervalSeconds = roundTripSeconds;
+
+		if( rateChangeIntervalSeconds < MIN_RATE_CHANGE_INTERVAL_SECONDS )
+		{
+			rateChangeIntervalSeconds = MIN_RATE_CHANGE_INTERVAL_SECONDS;
+		}
+	}
+
+	m_nextRateChangeTimeSeconds = currentTimeSeconds + rateChangeIntervalSeconds;
+
+	bool hasResentSinceLastChange = stats.GetNumResends() != m_numResendsAtLastRateChange;
+	bool isQueueBuilding = m_hasMinRoundTrip && roundTripSeconds - m_minRoundTripSeconds > MAX_QUEUEING_DELAY_SECONDS;
+
+	m_numResendsAtLastRateChange = stats.GetNumResends();
+
+	if( hasResentSinceLastChange || isQueueBuilding )
+	{
+		m_sendRateBytesPerSecond *= SEND_RATE_DECREASE_FACTOR;
+	}
+	else
+	{
+		m_sendRateBytesPerSecond += SEND_RATE_INCREASE_BYTES_PER_SECOND;
+	}
+
+	if( m_sendRateBytesPerSecond < MIN_SEND_RATE_BYTES_PER_SECOND )
+	{
+		m_sendRateBytesPerSecond = MIN_SEND_RATE_BYTES_PER_SECOND;
+	}
+	else if( m_sendRateBytesPerSecond > MAX_SEND_RATE_BYTES_PER_SECOND )
+	{
+		m_sendRateBytesPerSecond = MAX_SEND_RATE_BYTES_PER_SECOND;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Everything sent counts, reliable messages included
+void SendPacer::RecordBytesSent( int numBytes )
+{
+	m_availableBytes -= numBytes;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SendPacer::RecordSendSkipped()
+{
+	++m_numSendsSkipped;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//A send of any size can start on a bucket that is not overdrawn, so one bigger than a burst still
+//goes out. Nothing has refilled the bucket before the first Update, so everything goes until then.
+bool SendPacer::CanSend() const
+{
+	return !m_hasUpdated || m_availableBytes > 0.0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SendPacer::ConsolePrintStats() const
+{
+	if( ConsoleLog::s_currentLog == nullptr )
+	{
+		return;
+	}
+
+	std::ostringstream outputStringStream;
+
+	outputStringStream << std::fixed << std::setprecision( 1 );
+
+	outputStringStream << "  send rate " << m_sendRateBytesPerSecond / 1024.0 << "KB/s, ";
+
+	if( m_hasMinRoundTrip )
+	{
+		outputStringStream << "quietest rtt " << m_minRoundTripSeconds * 1000.0 << "ms, ";
+	}
+
+	outputStringStream << "sends skipped " << m_numSendsSkipped;
+	ConsoleLog::s_currentLog->ConsolePrint( outputStringStream.str() );
+}
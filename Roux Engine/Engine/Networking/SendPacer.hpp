@@ -0,0 +1,66 @@
+#ifndef SEND_PACER_HPP
+#define SEND_PACER_HPP
+
+#pragma once
+
+#include "Engine/Utilities/CommonUtilities.hpp"
+
+class ConnectionStats;
+
+//-----------------------------------------------------------------------------------------------
+//An estimate of how fast one peer can be sent to before a queue builds up somewhere on the way.
+//The rate grows a little every round trip and is cut back hard on a resend, or once the round trip
+//climbs well above the quietest one seen, the sign of a queue filling. Sends draw from a
+//bucket of bytes refilled at that rate, and may overdraw it, which holds back what comes next until
+//it is paid back. Reliable messages always go. Unreliable ones that find the bucket overdrawn should
+//be skipped rather than queued, the next one replaces them anyway.
+class SendPacer
+{
+public:
+
+	SendPacer();
+
+	void Reset();
+	void Update( const ConnectionStats& stats, double currentTimeSeconds );
+
+	void RecordBytesSent( int numBytes );
+	void RecordSendSkipped();
+
+	bool CanSend() const;
+
+	void ConsolePrintStats() const;
+
+	inline double	GetSendRateBytesPerSecond() const;
+	inline uint		GetNumSendsSkipped() const;
+
+private:
+
+	double	m_sendRateBytesPerSecond;
+	double	m_availableBytes;
+	double	m_lastUpdateTimeSeconds;
+	double	m_nextRateChangeTimeSeconds;
+
+	double	m_minRoundTripSeconds;
+	bool	m_hasMinRoundTrip;
+
+	uint	m_numResendsAtLastRateChange;
+	uint	m_numSendsSkipped;
+	bool	m_hasUpdated;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline double SendPacer::GetSendRateBytesPerSecond() const
+{
+	return m_sendRateBytesPerSecond;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline uint SendPacer::GetNumSendsSkipped() const
+{
+	return m_numSendsSkipped;
+}
+
+
+#endif
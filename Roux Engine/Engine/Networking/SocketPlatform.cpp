@@ -0,0 +1,187 @@
+#define STATIC
+
+#include "SocketPlatform.hpp"
+
+#ifdef _WIN32
+
+//-----------------------------------------------------------------------------------------------
+STATIC bool SocketPlatform::StartUp()
+{
+	WSADATA winSockData;
+
+	return WSAStartup( MAKEWORD( 2, 2 ), &winSockData ) == 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void SocketPlatform::ShutDown()
+{
+	WSACleanup();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC int SocketPlatform::GetLastError()
+{
+	return WSAGetLastError();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//A non-blocking socket whose buffer is full, not a broken one
+STATIC bool SocketPlatform::IsWouldBlockError( int errorCode )
+{
+	return errorCode == WSAEWOULDBLOCK;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC bool SocketPlatform::SetNonBlocking( SOCKET socketToSet )
+{
+	u_long nonBlockingIO = 1;
+
+	return ioctlsocket( socketToSet, FIONBIO, &nonBlockingIO ) == 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void SocketPlatform::CloseSocket( SOCKET socketToClose )
+{
+	closesocket( socketToClose );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//WinSock's select takes a list rather than a bitmask, so it only costs per socket passed in. FD_SETSIZE
+//is 64 here, as many as Network ever has open.
+STATIC int SocketPlatform::WaitForReadable( const SOCKET* socketsToWaitOn, int numSockets, double maxSecondsToWait, bool* out_isReadable )
+{
+	fd_set readableSockets;
+	FD_ZERO( &readableSockets );
+
+	for( int i = 0; i < numSockets; ++i )
+	{
+		FD_SET( socketsToWaitOn[ i ], &readableSockets );
+	}
+
+	if( maxSecondsToWait < 0.0 )
+	{
+		maxSecondsToWait = 0.0;
+	}
+
+	struct timeval timeout;
+	timeout.tv_sec = static_cast< long >( maxSecondsToWait );
+	timeout.tv_usec = static_cast< long >( ( maxSecondsToWait - static_cast< double >( timeout.tv_sec ) ) * 1000000.0 );
+
+	//the first parameter is ignored by WinSock
+	int numReadableSockets = select( 0, &readableSockets, nullptr, nullptr, &timeout );
+
+	for( int i = 0; i < numSockets; ++i )
+	{
+		out_isReadable[ i ] = numReadableSockets > 0 && FD_ISSET( socketsToWaitOn[ i ], &readableSockets ) != 0;
+	}
+
+	return numReadableSockets > 0 ? numReadableSockets : 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC const char* SocketPlatform::GetName()
+{
+	return "WinSock";
+}
+
+#else
+
+//-----------------------------------------------------------------------------------------------
+//BSD sockets need no library start up
+STATIC bool SocketPlatform::StartUp()
+{
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void SocketPlatform::ShutDown()
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC int SocketPlatform::GetLastError()
+{
+	return errno;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//A non-blocking socket whose buffer is full, not a broken one. The two are the same value on Linux.
+STATIC bool SocketPlatform::IsWouldBlockError( int errorCode )
+{
+	return errorCode == EAGAIN || errorCode == EWOULDBLOCK;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC bool SocketPlatform::SetNonBlocking( SOCKET socketToSet )
+{
+	int flags = fcntl( socketToSet, F_GETFL, 0 );
+
+	return flags != -1 && fcntl( socketToSet, F_SETFL, flags | O_NONBLOCK ) == 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void SocketPlatform::CloseSocket( SOCKET socketToClose )
+{
+	close( socketToClose );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//poll rather than select, which caps descriptor values at FD_SETSIZE and scans every one below the
+//highest. Rounds the wait up to a whole millisecond so a short wait does not turn into a spin.
+STATIC int SocketPlatform::WaitForReadable( const SOCKET* socketsToWaitOn, int numSockets, double maxSecondsToWait, bool* out_isReadable )
+{
+	const int MAX_SOCKETS_PER_WAIT = 64;
+
+	struct pollfd descriptors[ MAX_SOCKETS_PER_WAIT ];
+
+	if( numSockets > MAX_SOCKETS_PER_WAIT )
+	{
+		numSockets = MAX_SOCKETS_PER_WAIT;
+	}
+
+	for( int i = 0; i < numSockets; ++i )
+	{
+		descriptors[ i ].fd = socketsToWaitOn[ i ];
+		descriptors[ i ].events = POLLIN;
+		descriptors[ i ].revents = 0;
+	}
+
+	int timeoutMilliseconds = 0;
+
+	if( maxSecondsToWait > 0.0 )
+	{
+		timeoutMilliseconds = static_cast< int >( maxSecondsToWait * 1000.0 + 0.999 );
+	}
+
+	int numReadableSockets = poll( descriptors, static_cast< nfds_t >( numSockets ), timeoutMilliseconds );
+
+	for( int i = 0; i < numSockets; ++i )
+	{
+		out_isReadable[ i ] = numReadableSockets > 0 && ( descriptors[ i ].revents & POLLIN ) != 0;
+	}
+
+	return numReadableSockets > 0 ? numReadableSockets : 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC const char* SocketPlatform::GetName()
+{
+	return "POSIX";
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef SOCKET_PLATFORM_HPP
+#define SOCKET_PLATFORM_HPP
+
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+//WinSock on Windows, BSD sockets everywhere else. Past the includes the two only differ in the
+//few calls wrapped by SocketPlatform, so the rest of the networking code is the same on both.
+#ifdef _WIN32
+
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+
+#pragma comment( lib, "ws2_32.lib" )
+
+#else
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <poll.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+typedef int SOCKET;
+
+const SOCKET INVALID_SOCKET = -1;
+const int SOCKET_ERROR = -1;
+
+//Older C libraries lack the define even where the kernel has segmentation offload, and kernels older
+//than 4.18 reject it at send time, which Network falls back from
+#if defined( __linux__ ) && !defined( UDP_SEGMENT )
+#define UDP_SEGMENT 103
+#endif
+
+//recvmmsg and sendmmsg move a whole batch of datagrams per system call. Only Linux has them, and its C
+//library only declares them for GNU builds, which g++ always is.
+#if defined( __linux__ ) && defined( _GNU_SOURCE )
+#define SOCKET_PLATFORM_HAS_BATCH_CALLS
+#endif
+
+#endif
+
+//-----------------------------------------------------------------------------------------------
+class SocketPlatform
+{
+public:
+
+	static bool			StartUp();
+	static void			ShutDown();
+
+	static int			GetLastError();
+	static bool			IsWouldBlockError( int errorCode );
+	static bool			SetNonBlocking( SOCKET socketToSet );
+	static void			CloseSocket( SOCKET socketToClose );
+	static int			WaitForReadable( const SOCKET* socketsToWaitOn, int numSockets, double maxSecondsToWait, bool* out_isReadable );
+
+	static const char*	GetName();
+};
+
+
+#endif
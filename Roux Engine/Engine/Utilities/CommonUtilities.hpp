@@ -26,6 +26,7 @@
 
 typedef unsigned int uint; 
 typedef unsigned char uchar;
+typedef unsigned long long uint64;
 
 typedef Vector2i TileCoords;
 typedef Vector2f WorldCoords;
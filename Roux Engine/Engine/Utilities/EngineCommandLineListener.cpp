@@ -1,8 +1,20 @@
 #include "EngineCommandLineListener.hpp"
 
 #include <string>
+#include <sstream>
 #include <Windows.h>
 
+#include "Engine/Networking/Network.hpp"
+#include "Engine/Networking/NetworkBenchmark.hpp"
+#include "Engine/Rendering/ConsoleLog.hpp"
+
+//Held-back datagrams wait at least this much longer than the rest, so something overtakes them
+const double MIN_SIMULATED_REORDER_DELAY_SECONDS = 0.05;
+
+const double DEFAULT_NETWORK_BENCHMARK_SECONDS = 2.0;
+const int NUM_NETWORK_BENCHMARK_RATES = 3;
+const int NETWORK_BENCHMARK_PACKETS_PER_SECOND[ NUM_NETWORK_BENCHMARK_RATES ] = { 1000, 10000, 50000 };
+
 //-----------------------------------------------------------------------------------------------
 void EngineCommandLineListener::ExampleFunction( NamedProperties& parameters )
 {
@@ -13,4 +25,177 @@ void EngineCommandLineListener::ExampleFunction( NamedProperties& parameters )
 	outputString = "Engine's version of string parameter: " + outputString;
 
 	OutputDebugStringA( outputString.c_str() );
-}
\ No newline at end of file
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//simulateNetwork <latencyMs> <jitterMs> <loss%> <duplicate%> <reorder%> <seed>, trailing ones default
+//to 0. "simulateNetwork off" or no parameters goes back to the real link.
+void EngineCommandLineListener::SimulateNetworkConditions( NamedProperties& parameters )
+{
+	std::string latencyAsString;
+	std::string jitterAsString;
+	std::string lossAsString;
+	std::string duplicateAsString;
+	std::string reorderAsString;
+	std::string seedAsString;
+
+	parameters.Get( "param1", latencyAsString );
+	parameters.Get( "param2", jitterAsString );
+	parameters.Get( "param3", lossAsString );
+	parameters.Get( "param4", duplicateAsString );
+	parameters.Get( "param5", reorderAsString );
+	parameters.Get( "param6", seedAsString );
+
+	SimulatedNetworkConditions conditions;
+
+	if( latencyAsString != "off" )
+	{
+		conditions.latencySeconds = atof( latencyAsString.c_str() ) * 0.001;
+		conditions.jitterSeconds = atof( jitterAsString.c_str() ) * 0.001;
+		conditions.lossRate = static_cast< float >( atof( lossAsString.c_str() ) ) * 0.01f;
+		conditions.duplicateRate = static_cast< float >( atof( duplicateAsString.c_str() ) ) * 0.01f;
+		conditions.reorderRate = static_cast< float >( atof( reorderAsString.c_str() ) ) * 0.01f;
+		conditions.reorderDelaySeconds = conditions.latencySeconds + conditions.jitterSeconds;
+
+		if( conditions.reorderDelaySeconds < MIN_SIMULATED_REORDER_DELAY_SECONDS )
+		{
+			conditions.reorderDelaySeconds = MIN_SIMULATED_REORDER_DELAY_SECONDS;
+		}
+
+		if( seedAsString != "" )
+		{
+			conditions.randomSeed = static_cast< uint >( strtoul( seedAsString.c_str(), nullptr, 10 ) );
+		}
+	}
+
+	Network::GetInstance().SetSimulatedConditions( conditions );
+
+	if( ConsoleLog::s_currentLog == nullptr )
+	{
+		return;
+	}
+
+	std::ostringstream outputStringStream;
+
+	if( conditions.IsEnabled() )
+	{
+		outputStringStream << "Simulating " << conditions.latencySeconds * 1000.0 << "ms +" << conditions.jitterSeconds * 1000.0 << "ms, loss " << conditions.lossRate * 100.f << "%, duplicates " << conditions.duplicateRate * 100.f << "%, reorder " << conditions.reorderRate * 100.f << "%, seed " << conditions.randomSeed;
+	}
+	else
+	{
+		outputStringStream << "Network simulation off";
+	}
+
+	ConsoleLog::s_currentLog->ConsolePrint( outputStringStream.str() );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//capturePackets <filePath> records all traffic there, "capturePackets off" closes the file
+void EngineCommandLineListener::CapturePackets( NamedProperties& parameters )
+{
+	std::string filePath;
+
+	parameters.Get( "param1", filePath );
+
+	Network& theNetwork = Network::GetInstance();
+	std::string resultMessage;
+
+	if( filePath == "" || filePath == "off" )
+	{
+		theNetwork.StopCapture();
+		resultMessage = "Packet capture off";
+	}
+	else if( theNetwork.StartCapture( filePath ) )
+	{
+		resultMessage = "Capturing packets to " + filePath;
+	}
+	else
+	{
+		resultMessage = "Could not open " + filePath + " for packet capture";
+	}
+
+	if( ConsoleLog::s_currentLog != nullptr )
+	{
+		ConsoleLog::s_currentLog->ConsolePrint( resultMessage );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//socketBuffers <receiveKB> <sendKB>, for every socket opened afterwards. 0 or nothing keeps the default.
+void EngineCommandLineListener::SetSocketBufferSizes( NamedProperties& parameters )
+{
+	std::string receiveKilobytesAsString;
+	std::string sendKilobytesAsString;
+
+	parameters.Get( "param1", receiveKilobytesAsString );
+	parameters.Get( "param2", sendKilobytesAsString );
+
+	int receiveBufferBytes = atoi( receiveKilobytesAsString.c_str() ) * 1024;
+	int sendBufferBytes = atoi( sendKilobytesAsString.c_str() ) * 1024;
+
+	Network::GetInstance().SetDefaultSocketBufferSizes( receiveBufferBytes, sendBufferBytes );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//socketBackend <io_uring|nonblocking>, for every socket opened afterwards. Sockets the kernel will
+//not give io_uring to stay non-blocking.
+void EngineCommandLineListener::SetSocketBackend( NamedProperties& parameters )
+{
+	std::string backendAsString;
+
+	parameters.Get( "param1", backendAsString );
+
+	Network& theNetwork = Network::GetInstance();
+	std::string resultMessage;
+
+	if( backendAsString == "io_uring" && theNetwork.SupportsIoUring() )
+	{
+		theNetwork.SetDefaultSocketBackend( SOCKET_BACKEND_IO_URING );
+		resultMessage = "New sockets use io_uring";
+	}
+	else
+	{
+		theNetwork.SetDefaultSocketBackend( SOCKET_BACKEND_NON_BLOCKING );
+		resultMessage = ( backendAsString == "io_uring" ) ? "io_uring is not available here, new sockets are non-blocking" : "New sockets are non-blocking";
+	}
+
+	if( ConsoleLog::s_currentLog != nullptr )
+	{
+		ConsoleLog::s_currentLog->ConsolePrint( resultMessage );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//benchmarkNetwork <seconds per run>. Runs each backend at each rate over loopback and prints a line
+//per run. Blocks until every run is done.
+void EngineCommandLineListener::BenchmarkNetwork( NamedProperties& parameters )
+{
+	std::string secondsAsString;
+
+	parameters.Get( "param1", secondsAsString );
+
+	double durationSeconds = ( secondsAsString != "" ) ? atof( secondsAsString.c_str() ) : DEFAULT_NETWORK_BENCHMARK_SECONDS;
+
+	const int NUM_BACKENDS_TO_RUN = 2;
+	const SocketBackend BACKENDS_TO_RUN[ NUM_BACKENDS_TO_RUN ] = { SOCKET_BACKEND_NON_BLOCKING, SOCKET_BACKEND_IO_URING };
+
+	for( int rateIndex = 0; rateIndex < NUM_NETWORK_BENCHMARK_RATES; ++rateIndex )
+	{
+		for( int backendIndex = 0; backendIndex < NUM_BACKENDS_TO_RUN; ++backendIndex )
+		{
+			NetworkBenchmarkResult result;
+
+			NetworkBenchmark::RunOverLoopback( BACKENDS_TO_RUN[ backendIndex ], NETWORK_BENCHMARK_PACKETS_PER_SECOND[ rateIndex ], durationSeconds, result );
+
+			if( ConsoleLog::s_currentLog != nullptr )
+			{
+				ConsoleLog::s_currentLog->ConsolePrint( result.GetAsString() );
+			}
+		}
+	}
+}
@@ -22,6 +22,11 @@ private:
 
 	inline void Initialize(); 
 	void ExampleFunction( NamedProperties& parameters );
+	void SimulateNetworkConditions( NamedProperties& parameters );
+	void CapturePackets( NamedProperties& parameters );
+	void SetSocketBufferSizes( NamedProperties& parameters );
+	void SetSocketBackend( NamedProperties& parameters );
+	void BenchmarkNetwork( NamedProperties& parameters );
 
 	EngineCommandLineListener();
 	~EngineCommandLineListener();
@@ -51,6 +56,11 @@ inline void EngineCommandLineListener::Initialize()
 	EventSystem& eventSystem = EventSystem::GetInstance();
 
 	eventSystem.RegisterEventWithCallbackAndObject( "exampleFunction", &EngineCommandLineListener::ExampleFunction, this );
+	eventSystem.RegisterEventWithCallbackAndObject( "simulateNetwork", &EngineCommandLineListener::SimulateNetworkConditions, this );
+	eventSystem.RegisterEventWithCallbackAndObject( "capturePackets", &EngineCommandLineListener::CapturePackets, this );
+	eventSystem.RegisterEventWithCallbackAndObject( "socketBuffers", &EngineCommandLineListener::SetSocketBufferSizes, this );
+	eventSystem.RegisterEventWithCallbackAndObject( "socketBackend", &EngineCommandLineListener::SetSocketBackend, this );
+	eventSystem.RegisterEventWithCallbackAndObject( "benchmarkNetwork", &EngineCommandLineListener::BenchmarkNetwork, this );
 }
 
 #endif
\ No newline at end of file
@@ -24,7 +24,11 @@ enum SeverityLevel
 void DebuggerPrintf( const char* messageFormat, ... );
 bool IsDebuggerAvailable();
 void RecoverableError( const char* cppFileName, int cppLineNum, const std::string& errorMessage, const char* conditionText=nullptr );
+#if defined( _WIN32 )
 __declspec( noreturn ) void FatalError( const char* cppFileName, int cppLineNum, const std::string& errorMessage, const char* conditionText=nullptr );
+#else
+__attribute__( ( noreturn ) ) void FatalError( const char* cppFileName, int cppLineNum, const std::string& errorMessage, const char* conditionText=nullptr );
+#endif
 void SystemDialogue_Okay( const std::string& messageTitle, const std::string& messageText, SeverityLevel severity );
 bool SystemDialogue_OkayCancel( const std::string& messageTitle, const std::string& messageText, SeverityLevel severity );
 bool SystemDialogue_YesNo( const std::string& messageTitle, const std::string& messageText, SeverityLevel severity );
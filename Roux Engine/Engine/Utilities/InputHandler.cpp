@@ -48,7 +48,8 @@ void InputHandler::Initialize(HWND initialWindow)
 }
 
 //-----------------------------------------------------------------------------------------------
-void InputHandler::RunMessagePump()
+//True if any window message was handled, anything from input to a repaint request
+bool InputHandler::RunMessagePump()
 {
 	memcpy(&(InputHandler::m_previousKeyState),&(InputHandler::m_currentKeyState),sizeof(InputHandler::m_previousKeyState));
 	memcpy(&(InputHandler::m_previousCharState),&(InputHandler::m_currentCharState),sizeof(InputHandler::m_previousCharState));
@@ -56,6 +57,7 @@ void InputHandler::RunMessagePump()
 	GetCursorPos(m_mousePosition);
 	//ScreenToClient(m_clientWindow,m_mousePosition);
 	MSG queuedMessage;
+	bool wasAnyMessageHandled = false;
 
 	for( ;; )
 	{
@@ -67,7 +69,10 @@ void InputHandler::RunMessagePump()
 
 		TranslateMessage( &queuedMessage );
 		DispatchMessage( &queuedMessage );
+		wasAnyMessageHandled = true;
 	}
+
+	return wasAnyMessageHandled;
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -47,7 +47,7 @@ public:
 	static bool ShouldQuit();
 	static void QuitApplication();
 
-	void RunMessagePump();
+	bool RunMessagePump();
 	void RunXboxMessagePump();
 
 	static bool ProcessCharDownEvent(uchar virtualKeyCode);
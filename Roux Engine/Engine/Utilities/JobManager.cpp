@@ -1,7 +1,5 @@
 #include "JobManager.hpp"
 
-#include <process.h>
-
 #include "Engine/Utilities/NewAndDeleteOverrides.hpp"
 
 //-----------------------------------------------------------------------------------------------
@@ -4,7 +4,7 @@
 #include <queue>
 #include <vector>
 #include <map>
-#include <Windows.h>
+#include "Engine/Utilities/PlatformThreading.hpp"
 
 #include "Engine/Utilities/Job.hpp"
 #include "Engine/Utilities/WorkerThread.hpp"
@@ -0,0 +1,288 @@
+#ifndef PLATFORM_THREADING_HPP
+#define PLATFORM_THREADING_HPP
+
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+//Windows builds use Win32 directly. Other platforms get the handful of Win32 threading calls the
+//engine makes, mapped onto pthreads, so headless servers build from the same code.
+#ifdef _WIN32
+
+//WinSock2 has to come before Windows.h, or the old winsock.h that Windows.h pulls in clashes with it
+#include <WinSock2.h>
+#include <Windows.h>
+#include <process.h>
+
+#else
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <time.h>
+#include <cstddef>
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+typedef int				BOOL;
+typedef unsigned int	DWORD;
+typedef long			LONG;
+
+const DWORD INFINITE = 0xFFFFFFFF;
+const DWORD WAIT_OBJECT_0 = 0;
+const DWORD WAIT_TIMEOUT = 258;
+
+//-----------------------------------------------------------------------------------------------
+//Recursive, as a critical section is
+typedef pthread_mutex_t CRITICAL_SECTION;
+
+inline void InitializeCriticalSection( CRITICAL_SECTION* criticalSection )
+{
+	pthread_mutexattr_t attributes;
+
+	pthread_mutexattr_init( &attributes );
+	pthread_mutexattr_settype( &attributes, PTHREAD_MUTEX_RECURSIVE );
+	pthread_mutex_init( criticalSection, &attributes );
+	pthread_mutexattr_destroy( &attributes );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void DeleteCriticalSection( CRITICAL_SECTION* criticalSection )
+{
+	pthread_mutex_destroy( criticalSection );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void EnterCriticalSection( CRITICAL_SECTION* criticalSection )
+{
+	pthread_mutex_lock( criticalSection );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void LeaveCriticalSection( CRITICAL_SECTION* criticalSection )
+{
+	pthread_mutex_unlock( criticalSection );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void Sleep( DWORD milliseconds )
+{
+	if( milliseconds == 0 )
+	{
+		sched_yield();
+		return;
+	}
+
+	usleep( static_cast< useconds_t >( milliseconds ) * 1000 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void MemoryBarrier()
+{
+	__sync_synchronize();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Full barrier like the Win32 call, the builtin on its own only acquires
+inline LONG InterlockedExchange( volatile LONG* target, LONG value )
+{
+	__sync_synchronize();
+
+	return __sync_lock_test_and_set( target, value );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline LONG InterlockedIncrement( volatile LONG* addend )
+{
+	return __sync_add_and_fetch( addend, 1 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline LONG InterlockedDecrement( volatile LONG* addend )
+{
+	return __sync_sub_and_fetch( addend, 1 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Events are the only handles the engine makes, so a handle is just a pointer to one
+struct PlatformEvent
+{
+	pthread_mutex_t	mutex;
+	pthread_cond_t	condition;
+	bool			isSignaled;
+	bool			isManualReset;
+};
+
+typedef PlatformEvent* HANDLE;
+
+inline HANDLE CreateEvent( void* attributes, BOOL isManualReset, BOOL isInitiallySignaled, const char* name )
+{
+	( void )attributes;
+	( void )name;
+
+	PlatformEvent* newEvent = new PlatformEvent;
+
+	pthread_mutex_init( &newEvent->mutex, nullptr );
+	pthread_cond_init( &newEvent->condition, nullptr );
+	newEvent->isSignaled = ( isInitiallySignaled != FALSE );
+	newEvent->isManualReset = ( isManualReset != FALSE );
+
+	return newEvent;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline BOOL SetEvent( HANDLE eventToSet )
+{
+	pthread_mutex_lock( &eventToSet->mutex );
+
+	eventToSet->isSignaled = true;
+
+	if( eventToSet->isManualReset )
+	{
+		pthread_cond_broadcast( &eventToSet->condition );
+	}
+	else
+	{
+		pthread_cond_signal( &eventToSet->condition );
+	}
+
+	pthread_mutex_unlock( &eventToSet->mutex );
+
+	return TRUE;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline DWORD WaitForSingleObject( HANDLE eventToWaitOn, DWORD milliseconds )
+{
+	struct timespec deadline;
+
+	clock_gettime( CLOCK_REALTIME, &deadline );
+
+	deadline.tv_sec += milliseconds / 1000;
+	deadline.tv_nsec += static_cast< long >( milliseconds % 1000 ) * 1000000;
+
+	if( deadline.tv_nsec >= 1000000000 )
+	{
+		++deadline.tv_sec;
+		deadline.tv_nsec -= 1000000000;
+	}
+
+	pthread_mutex_lock( &eventToWaitOn->mutex );
+
+	int waitResult = 0;
+
+	while( !eventToWaitOn->isSignaled && waitResult != ETIMEDOUT )
+	{
+		if( milliseconds == INFINITE )
+		{
+			waitResult = pthread_cond_wait( &eventToWaitOn->condition, &eventToWaitOn->mutex );
+		}
+		else
+		{
+			waitResult = pthread_cond_timedwait( &eventToWaitOn->condition, &eventToWaitOn->mutex, &deadline );
+		}
+	}
+
+	bool wasSignaled = eventToWaitOn->isSignaled;
+
+	if( wasSignaled && !eventToWaitOn->isManualReset )
+	{
+		eventToWaitOn->isSignaled = false;
+	}
+
+	pthread_mutex_unlock( &eventToWaitOn->mutex );
+
+	return wasSignaled ? WAIT_OBJECT_0 : WAIT_TIMEOUT;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline BOOL CloseHandle( HANDLE eventToClose )
+{
+	if( eventToClose == nullptr )
+	{
+		return FALSE;
+	}
+
+	pthread_cond_destroy( &eventToClose->condition );
+	pthread_mutex_destroy( &eventToClose->mutex );
+
+	delete eventToClose;
+
+	return TRUE;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Threads run detached, as _beginthread's do
+struct PlatformThreadStart
+{
+	void	( *entryFunction )( void* );
+	void*	argument;
+};
+
+inline void* RunPlatformThread( void* threadStartAsVoid )
+{
+	PlatformThreadStart threadStart = *static_cast< PlatformThreadStart* >( threadStartAsVoid );
+
+	delete static_cast< PlatformThreadStart* >( threadStartAsVoid );
+
+	threadStart.entryFunction( threadStart.argument );
+
+	return nullptr;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline uintptr_t _beginthread( void ( *entryFunction )( void* ), unsigned int stackSize, void* argument )
+{
+	PlatformThreadStart* threadStart = new PlatformThreadStart;
+
+	threadStart->entryFunction = entryFunction;
+	threadStart->argument = argument;
+
+	pthread_attr_t attributes;
+	pthread_t thread;
+
+	pthread_attr_init( &attributes );
+	pthread_attr_setdetachstate( &attributes, PTHREAD_CREATE_DETACHED );
+
+	if( stackSize > 0 )
+	{
+		pthread_attr_setstacksize( &attributes, stackSize );
+	}
+
+	int result = pthread_create( &thread, &attributes, &RunPlatformThread, threadStart );
+
+	pthread_attr_destroy( &attributes );
+
+	if( result != 0 )
+	{
+		delete threadStart;
+		return static_cast< uintptr_t >( -1 );
+	}
+
+	return static_cast< uintptr_t >( 1 );
+}
+
+#endif
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#pragma once
+
+#include "Engine/Utilities/PlatformThreading.hpp"
+
+#include "Engine/Utilities/CommonUtilities.hpp"
+#include "Engine/Utilities/ErrorWarningAssert.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Bounded lock-free queue for exactly one producer thread and one consumer thread. Elements are
+//written and read in place, the producer fills the slot from BeginPush and publishes it with
+//EndPush, the consumer reads slots from PeekAt for as long as it likes and gives them back
+//with Pop. Neither side ever blocks, a full ring just returns nullptr to the producer.
+template< typename T >
+class SPSCRing
+{
+public:
+
+	SPSCRing();
+	~SPSCRing();
+
+	void Allocate( int capacityPowerOfTwo );
+	void Free();
+
+	//producer thread only
+	T*		BeginPush();
+	void	EndPush();
+
+	//consumer thread only
+	int		GetNumReadable() const;
+	T*		PeekAt( int indexFromFront ) const;
+	void	Pop( int numToPop );
+
+	inline bool IsAllocated() const;
+	inline int	GetCapacity() const;
+
+private:
+
+	SPSCRing( const SPSCRing& );
+	void operator=( const SPSCRing& );
+
+	static const int CACHE_LINE_SIZE_BYTES = 64;
+
+	T*		m_slots;
+	int		m_capacity;
+	uint	m_indexMask;
+
+	//each index is written by one side only, keep them off each other's cache line
+	char					m_padBeforeWriteIndex[ CACHE_LINE_SIZE_BYTES ];
+	volatile uint			m_writeIndex;
+	char					m_padBeforeReadIndex[ CACHE_LINE_SIZE_BYTES ];
+	volatile uint			m_readIndex;
+	char					m_padAfterReadIndex[ CACHE_LINE_SIZE_BYTES ];
+};
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+SPSCRing< T >::SPSCRing()
+	: m_slots( nullptr )
+	, m_capacity( 0 )
+	, m_indexMask( 0 )
+	, m_writeIndex( 0 )
+	, m_readIndex( 0 )
+{
+
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+SPSCRing< T >::~SPSCRing()
+{
+	Free();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Not thread safe, only call while neither side is using the ring
+template< typename T >
+void SPSCRing< T >::Allocate( int capacityPowerOfTwo )
+{
+	FATAL_ASSERTION( capacityPowerOfTwo > 0 && ( capacityPowerOfTwo & ( capacityPowerOfTwo - 1 ) ) == 0, "SPSCRing capacity must be a power of two." );
+
+	Free();
+
+	m_slots = new T[ capacityPowerOfTwo ];
+	m_capacity = capacityPowerOfTwo;
+	m_indexMask = static_cast< uint >( capacityPowerOfTwo - 1 );
+	m_writeIndex = 0;
+	m_readIndex = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+void SPSCRing< T >::Free()
+{
+	delete[] m_slots;
+
+	m_slots = nullptr;
+	m_capacity = 0;
+	m_indexMask = 0;
+	m_writeIndex = 0;
+	m_readIndex = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Returns the next slot to fill, or nullptr while the ring is full. Calling it again before
+//EndPush hands back the same slot.
+template< typename T >
+T* SPSCRing< T >::BeginPush()
+{
+	uint writeIndex = m_writeIndex;
+	uint readIndex = m_readIndex;
+
+	//the consumer may still be reading the slot until its read index has been seen to move
+	MemoryBarrier();
+
+	if( writeIndex - readIndex >= static_cast< uint >( m_capacity ) )
+	{
+		return nullptr;
+	}
+
+	return &m_slots[ writeIndex & m_indexMask ];
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+void SPSCRing< T >::EndPush()
+{
+	//the slot's contents must be visible before the consumer can see the new write index
+	MemoryBarrier();
+
+	m_writeIndex = m_writeIndex + 1;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+int SPSCRing< T >::GetNumReadable() const
+{
+	uint writeIndex = m_writeIndex;
+
+	MemoryBarrier();
+
+	return static_cast< int >( writeIndex - m_readIndex );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//indexFromFront must be less than a value GetNumReadable returned since the last Pop
+template< typename T >
+T* SPSCRing< T >::PeekAt( int indexFromFront ) const
+{
+	return &m_slots[ ( m_readIndex + static_cast< uint >( indexFromFront ) ) & m_indexMask ];
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+void SPSCRing< T >::Pop( int numToPop )
+{
+	//finish every read of the popped slots before the producer is allowed to reuse them
+	MemoryBarrier();
+
+	m_readIndex = m_readIndex + static_cast< uint >( numToPop );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+inline bool SPSCRing< T >::IsAllocated() const
+{
+	return m_slots != nullptr;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+inline int SPSCRing< T >::GetCapacity() const
+{
+	return m_capacity;
+}
+
+
+#endif
@@ -1,9 +1,16 @@
 //-----------------------------------------------------------------------------------------------
 #include "Time.hpp"
+
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <time.h>
+#endif
 
 double Time::s_frequencyInverse = 0.0; 
 
+#ifdef _WIN32
+
 //-----------------------------------------------------------------------------------------------
 void Time::InitializeTime()
 {
@@ -23,4 +30,25 @@ double Time::GetCurrentTimeInSeconds()
 	
 	double currentSeconds = static_cast< double >(counts.QuadPart) * s_frequencyInverse;
 	return currentSeconds;
-}
\ No newline at end of file
+}
+
+#else
+
+//-----------------------------------------------------------------------------------------------
+//The monotonic clock already counts in nanoseconds
+void Time::InitializeTime()
+{
+	s_frequencyInverse = 1.0e-9;
+}
+
+//-----------------------------------------------------------------------------------------------
+double Time::GetCurrentTimeInSeconds()
+{
+	struct timespec counts;
+	clock_gettime( CLOCK_MONOTONIC, &counts );
+
+	double currentSeconds = static_cast< double >( counts.tv_sec ) + static_cast< double >( counts.tv_nsec ) * 1.0e-9;
+	return currentSeconds;
+}
+
+#endif
\ No newline at end of file
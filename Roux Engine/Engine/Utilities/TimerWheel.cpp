@@ -0,0 +1,369 @@
+#define STATIC
+
+#include "TimerWheel.hpp"
+
+const int NO_TIMER_NODE = -1;
+
+//-----------------------------------------------------------------------------------------------
+TimerWheel::TimerWheel( double tickSeconds )
+	: m_tickSeconds( tickSeconds )
+	, m_currentTick( 0 )
+	, m_numTimers( 0 )
+{
+	Reset( 0.0 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Drops every timer and starts counting ticks from the given time. Call once the clock is running,
+//a wheel left at time 0 would walk every tick since then on its first collect.
+void TimerWheel::Reset( double currentTimeSeconds )
+{
+	m_currentTick = GetTickForTime( currentTimeSeconds );
+	m_numTimers = 0;
+
+	for( int level = 0; level < NUM_LEVELS; ++level )
+	{
+		m_numTimersInLevel[ level ] = 0;
+	}
+
+	for( int i = 0; i <= NUM_SLOTS; ++i )
+	{
+		m_slotHeads[ i ] = NO_TIMER_NODE;
+		m_slotTails[ i ] = NO_TIMER_NODE;
+	}
+
+	m_nodes.clear();
+	m_freeNodeIndices.clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Fires on the first collect at or after fireTimeSeconds, never before. Times already past fire on
+//the next collect.
+void TimerWheel::Schedule( double fireTimeSeconds, uint timerType, uint ownerID, uint key )
+{
+	int nodeIndex = NO_TIMER_NODE;
+
+	if( !m_freeNodeIndices.empty() )
+	{
+		nodeIndex = m_freeNodeIndices.back();
+		m_freeNodeIndices.pop_back();
+	}
+	else
+	{
+		nodeIndex = static_cast< int >( m_nodes.size() );
+		m_nodes.push_back( TimerNode() );
+	}
+
+	TimerNode& node = m_nodes[ nodeIndex ];
+
+	node.timer.timerType = timerType;
+	node.timer.ownerID = ownerID;
+	node.timer.key = key;
+	node.timer.fireTimeSeconds = fireTimeSeconds;
+
+	//rounded up so the tick a timer fires on is never earlier than its time
+	node.fireTick = GetTickForTime( fireTimeSeconds );
+
+	if( static_cast< double >( node.fireTick ) * m_tickSeconds < fireTimeSeconds )
+	{
+		++node.fireTick;
+	}
+
+	++m_numTimers;
+
+	InsertNode( nodeIndex );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Appends rather than clears, timers come out in the order their ticks passed
+void TimerWheel::CollectExpiredTimers( double currentTimeSeconds, std::vector< ScheduledTimer >& out_expiredTimers )
+{
+	uint64 targetTick = GetTickForTime( currentTimeSeconds );
+
+	MoveSlotToExpired( OVERDUE_SLOT_INDEX, out_expiredTimers );
+
+	while( m_currentTick < targetTick )
+	{
+		uint64 nextTick = GetNextTickWorthVisiting();
+
+		if( nextTick > targetTick )
+		{
+			m_currentTick = targetTick;
+			break;
+		}
+
+		m_currentTick = nextTick;
+
+		//coarsest first, so timers moving down two levels at once land before the finer level cascades
+		for( int level = NUM_LEVELS - 1; level > 0; --level )
+		{
+			uint64 levelTickMask = ( static_cast< uint64 >( 1 ) << GetLevelShift( level ) ) - 1;
+
+			if( ( m_currentTick & levelTickMask ) == 0 )
+			{
+				int slotIndex = GetLevelFirstSlot( level ) + static_cast< int >( ( m_currentTick >> GetLevelShift( level ) ) & ( UPPER_LEVEL_NUM_SLOTS - 1 ) );
+
+				CascadeSlot( slotIndex );
+			}
+		}
+
+		//a cascade puts timers due this very tick in the overdue slot
+		MoveSlotToExpired( OVERDUE_SLOT_INDEX, out_expiredTimers );
+		MoveSlotToExpired( static_cast< int >( m_currentTick & ( LEVEL_ZERO_NUM_SLOTS - 1 ) ), out_expiredTimers );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Never later than the first time a collect would return something, but may be earlier by up to one
+//slot of a coarse level. Collecting then moves those timers down, so asking again gives a closer answer.
+bool TimerWheel::GetEarliestFireTime( double& out_fireTimeSeconds ) const
+{
+	if( m_numTimers == 0 )
+	{
+		return false;
+	}
+
+	if( m_slotHeads[ OVERDUE_SLOT_INDEX ] != NO_TIMER_NODE )
+	{
+		out_fireTimeSeconds = static_cast< double >( m_currentTick ) * m_tickSeconds;
+		return true;
+	}
+
+	bool hasFoundTimer = false;
+	uint64 earliestTick = 0;
+
+	for( int level = 0; level < NUM_LEVELS; ++level )
+	{
+		int levelShift = GetLevelShift( level );
+		int levelNumSlots = GetLevelNumSlots( level );
+		uint64 currentLevelTick = m_currentTick >> levelShift;
+
+		//a slot a full turn away shares an index with the current one, so the scan goes one past
+		for( int i = 1; i <= levelNumSlots; ++i )
+		{
+			uint64 slotLevelTick = currentLevelTick + i;
+			int slotIndex = GetLevelFirstSlot( level ) + static_cast< int >( slotLevelTick & ( levelNumSlots - 1 ) );
+
+			if( m_slotHeads[ slotIndex ] == NO_TIMER_NODE )
+			{
+				continue;
+			}
+
+			uint64 slotStartTick = slotLevelTick << levelShift;
+
+			if( !hasFoundTimer || slotStartTick < earliestTick )
+			{
+				earliestTick = slotStartTick;
+				hasFoundTimer = true;
+			}
+
+			break;
+		}
+	}
+
+	out_fireTimeSeconds = static_cast< double >( earliestTick ) * m_tickSeconds;
+
+	return hasFoundTimer;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Private Methods
+//-----------------------------------------------------------------------------------------------
+STATIC int TimerWheel::GetLevelShift( int level )
+{
+	if( level == 0 )
+	{
+		return 0;
+	}
+
+	return LEVEL_ZERO_SLOT_BITS + ( level - 1 ) * UPPER_LEVEL_SLOT_BITS;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC int TimerWheel::GetLevelFirstSlot( int level )
+{
+	if( level == 0 )
+	{
+		return 0;
+	}
+
+	return LEVEL_ZERO_NUM_SLOTS + ( level - 1 ) * UPPER_LEVEL_NUM_SLOTS;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC int TimerWheel::GetLevelNumSlots( int level )
+{
+	return ( level == 0 ) ? LEVEL_ZERO_NUM_SLOTS : UPPER_LEVEL_NUM_SLOTS;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC int TimerWheel::GetSlotLevel( int slotIndex )
+{
+	if( slotIndex < LEVEL_ZERO_NUM_SLOTS )
+	{
+		return 0;
+	}
+
+	return 1 + ( slotIndex - LEVEL_ZERO_NUM_SLOTS ) / UPPER_LEVEL_NUM_SLOTS;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+uint64 TimerWheel::GetTickForTime( double timeSeconds ) const
+{
+	if( timeSeconds <= 0.0 )
+	{
+		return 0;
+	}
+
+	return static_cast< uint64 >( timeSeconds / m_tickSeconds );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Finest level whose span still reaches the fire tick. Anything past the top level's span waits in
+//its furthest slot and is placed again when that slot cascades.
+void TimerWheel::InsertNode( int nodeIndex )
+{
+	uint64 fireTick = m_nodes[ nodeIndex ].fireTick;
+
+	if( fireTick <= m_currentTick )
+	{
+		AppendNodeToSlot( nodeIndex, OVERDUE_SLOT_INDEX );
+		return;
+	}
+
+	uint64 ticksUntilFire = fireTick - m_currentTick;
+
+	for( int level = 0; level < NUM_LEVELS; ++level )
+	{
+		int levelShift = GetLevelShift( level );
+		int levelNumSlots = GetLevelNumSlots( level );
+		uint64 levelSpanTicks = static_cast< uint64 >( levelNumSlots ) << levelShift;
+
+		bool isTopLevel = ( level == NUM_LEVELS - 1 );
+
+		if( ticksUntilFire >= levelSpanTicks && !isTopLevel )
+		{
+			continue;
+		}
+
+		uint64 placementTick = fireTick;
+
+		if( ticksUntilFire >= levelSpanTicks )
+		{
+			placementTick = m_currentTick + levelSpanTicks - 1;
+		}
+
+		int slotIndex = GetLevelFirstSlot( level ) + static_cast< int >( ( placementTick >> levelShift ) & ( levelNumSlots - 1 ) );
+
+		AppendNodeToSlot( nodeIndex, slotIndex );
+		return;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Every tick while the finest wheel has timers. Otherwise nothing can happen before the next cascade
+//of the finest level that has any, so long idle stretches are crossed in a few steps.
+uint64 TimerWheel::GetNextTickWorthVisiting() const
+{
+	for( int level = 0; level < NUM_LEVELS; ++level )
+	{
+		if( m_numTimersInLevel[ level ] == 0 )
+		{
+			continue;
+		}
+
+		uint64 levelTickSize = static_cast< uint64 >( 1 ) << GetLevelShift( level );
+
+		return ( ( m_currentTick >> GetLevelShift( level ) ) + 1 ) * levelTickSize;
+	}
+
+	//nothing waiting, any tick past the target will do
+	return ~static_cast< uint64 >( 0 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void TimerWheel::AppendNodeToSlot( int nodeIndex, int slotIndex )
+{
+	m_nodes[ nodeIndex ].nextNodeIndex = NO_TIMER_NODE;
+
+	if( m_slotTails[ slotIndex ] == NO_TIMER_NODE )
+	{
+		m_slotHeads[ slotIndex ] = nodeIndex;
+	}
+	else
+	{
+		m_nodes[ m_slotTails[ slotIndex ] ].nextNodeIndex = nodeIndex;
+	}
+
+	m_slotTails[ slotIndex ] = nodeIndex;
+
+	if( slotIndex != OVERDUE_SLOT_INDEX )
+	{
+		++m_numTimersInLevel[ GetSlotLevel( slotIndex ) ];
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+//Empties the slot and hands back its first node, the rest still chained behind it
+int TimerWheel::DetachSlot( int slotIndex )
+{
+	int nodeIndex = m_slotHeads[ slotIndex ];
+
+	m_slotHeads[ slotIndex ] = NO_TIMER_NODE;
+	m_slotTails[ slotIndex ] = NO_TIMER_NODE;
+
+	if( slotIndex != OVERDUE_SLOT_INDEX )
+	{
+		for( int countIndex = nodeIndex; countIndex != NO_TIMER_NODE; countIndex = m_nodes[ countIndex ].nextNodeIndex )
+		{
+			--m_numTimersInLevel[ GetSlotLevel( slotIndex ) ];
+		}
+	}
+
+	return nodeIndex;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void TimerWheel::CascadeSlot( int slotIndex )
+{
+	int nodeIndex = DetachSlot( slotIndex );
+
+	while( nodeIndex != NO_TIMER_NODE )
+	{
+		int nextNodeIndex = m_nodes[ nodeIndex ].nextNodeIndex;
+
+		InsertNode( nodeIndex );
+
+		nodeIndex = nextNodeIndex;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void TimerWheel::MoveSlotToExpired( int slotIndex, std::vector< ScheduledTimer >& out_expiredTimers )
+{
+	int nodeIndex = DetachSlot( slotIndex );
+
+	while( nodeIndex != NO_TIMER_NODE )
+	{
+		out_expiredTimers.push_back( m_nodes[ nodeIndex ].timer );
+		m_freeNodeIndices.push_back( nodeIndex );
+		--m_numTimers;
+
+		nodeIndex = m_nodes[ nodeIndex ].nextNodeIndex;
+	}
+}
@@ -0,0 +1,93 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#pragma once
+
+#include <vector>
+
+#include "Engine/Utilities/CommonUtilities.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//What the owner gave Schedule, handed back once the fire time has passed. The wheel never looks
+//inside, so type, owner and key mean whatever the owner wants.
+struct ScheduledTimer
+{
+	uint	timerType;
+	uint	ownerID;
+	uint	key;
+	double	fireTimeSeconds;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+//Hierarchical timing wheel. Scheduling is O(1), and collecting costs the timers that fire plus a
+//step per tick while the finest wheel holds anything, however many timers are waiting further out.
+//Those sit on coarser wheels and are moved down as their time nears. Timers cannot be cancelled;
+//owners check when one fires whether the deadline still stands and drop or reschedule it, which
+//keeps acks and refreshes free. Not thread safe, each thread that needs timers keeps its own wheel.
+class TimerWheel
+{
+public:
+
+	explicit TimerWheel( double tickSeconds );
+
+	void Reset( double currentTimeSeconds );
+	void Schedule( double fireTimeSeconds, uint timerType, uint ownerID, uint key );
+	void CollectExpiredTimers( double currentTimeSeconds, std::vector< ScheduledTimer >& out_expiredTimers );
+	bool GetEarliestFireTime( double& out_fireTimeSeconds ) const;
+
+	inline int GetNumTimers() const;
+
+private:
+
+	static const int NUM_LEVELS = 4;
+	static const int LEVEL_ZERO_SLOT_BITS = 8;
+	static const int UPPER_LEVEL_SLOT_BITS = 6;
+	static const int LEVEL_ZERO_NUM_SLOTS = 1 << LEVEL_ZERO_SLOT_BITS;
+	static const int UPPER_LEVEL_NUM_SLOTS = 1 << UPPER_LEVEL_SLOT_BITS;
+
+	//every level's slots in one array, then one extra for timers that were already due when placed
+	static const int NUM_SLOTS = LEVEL_ZERO_NUM_SLOTS + ( NUM_LEVELS - 1 ) * UPPER_LEVEL_NUM_SLOTS;
+	static const int OVERDUE_SLOT_INDEX = NUM_SLOTS;
+
+	struct TimerNode
+	{
+		ScheduledTimer	timer;
+		uint64			fireTick;
+		int				nextNodeIndex;
+	};
+
+	static int GetLevelShift( int level );
+	static int GetLevelFirstSlot( int level );
+	static int GetLevelNumSlots( int level );
+	static int GetSlotLevel( int slotIndex );
+
+	uint64	GetTickForTime( double timeSeconds ) const;
+	void	InsertNode( int nodeIndex );
+	uint64	GetNextTickWorthVisiting() const;
+	void	AppendNodeToSlot( int nodeIndex, int slotIndex );
+	int		DetachSlot( int slotIndex );
+	void	CascadeSlot( int slotIndex );
+	void	MoveSlotToExpired( int slotIndex, std::vector< ScheduledTimer >& out_expiredTimers );
+
+	double					m_tickSeconds;
+	uint64					m_currentTick;
+	int						m_numTimers;
+	int						m_numTimersInLevel[ NUM_LEVELS ];
+
+	int						m_slotHeads[ NUM_SLOTS + 1 ];
+	int						m_slotTails[ NUM_SLOTS + 1 ];
+
+	std::vector< TimerNode >	m_nodes;
+	std::vector< int >			m_freeNodeIndices;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline int TimerWheel::GetNumTimers() const
+{
+	return m_numTimers;
+}
+
+
+#endif
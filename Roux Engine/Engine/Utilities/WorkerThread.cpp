@@ -2,9 +2,12 @@
 
 #include "WorkerThread.hpp"
 
-#include "Engine/Utilities/InputHandler.hpp"
 #include "Engine/Utilities/JobManager.hpp"
 
+#ifdef _WIN32
+#include "Engine/Utilities/InputHandler.hpp"
+#endif
+
 //-----------------------------------------------------------------------------------------------
 WorkerThread::WorkerThread( TypeOfWork typeOfWork /* = WORK_GENERIC */ )
 	: m_typeOfWork( typeOfWork )
@@ -37,7 +40,12 @@ STATIC void WorkerThread::EntryFunction( void* workerThreadObj )
 //-----------------------------------------------------------------------------------------------
 void WorkerThread::Update()
 {
+#ifdef _WIN32
 	while( !InputHandler::ShouldQuit() )
+#else
+	//no window to close on a headless build, workers run until the process exits
+	for( ;; )
+#endif
 	{
 		JobManager& jobManager = JobManager::GetInstance();
 
@@ -1,7 +1,7 @@
 #ifndef WORKER_THREAD
 #define WORKER_THREAD
 
-#include <Windows.h>
+#include "Engine/Utilities/PlatformThreading.hpp"
 
 #include "Engine/Utilities/Job.hpp"
 